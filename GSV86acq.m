@@ -0,0 +1,139 @@
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+% Background acquisition object for a GSV-8, based on the MEX gateway        %
+% (build GSV86mex first with build_GSV86mex.m)                               %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+% A native worker thread in GSV86mex reads the measuring values and collects
+% them in a ring of NumBlocks preallocated blocks of FramesPerBlock frames.
+% A Matlab timer fetches the completed blocks and calls DataAvailableFcn once
+% per block with a (FramesPerBlock x NumObj) matrix, oldest frame in row 1:
+%
+%   acq = GSV86acq(3, 'FramesPerBlock', 1000, 'DataAvailableFcn', @(src,data) ...);
+%   start(acq); ... stop(acq); delete(acq);
+%
+% Slow callbacks (e.g. plotting) don't lose values: the worker keeps on reading
+% until all blocks are full, then the DLL buffer holds the values.
+% stop delivers all values read until then; the last call may pass fewer than
+% FramesPerBlock rows.
+
+classdef GSV86acq < handle
+    properties
+        DataAvailableFcn = []       % function handle @(src,data)
+        FramesPerBlock = 1000       % frames per block and callback
+        NumBlocks = 64              % number of preallocated blocks
+        TimerPeriod = 0.02          % period of the callback timer in s
+        Scaled = false              % multiply values with ScaleFactors
+        OutputType = 'double'       % class of the data passed to DataAvailableFcn: 'double' or 'single'
+    end
+    properties (SetAccess = private)
+        ComNo
+        NumObj
+        ScaleFactors
+        Frequency
+        BlocksAcquired = 0          % blocks passed to DataAvailableFcn
+        Running = false
+    end
+    properties (Access = private)
+        Timer = []
+    end
+
+    methods
+        function obj = GSV86acq(ComNo, varargin)
+            obj.ComNo = ComNo;
+            for k = 1:2:numel(varargin)
+                obj.(varargin{k}) = varargin{k+1};
+            end
+            GSV86mex('activate', ComNo);
+            obj.ScaleFactors = GSV86mex('objinfo', ComNo);
+            obj.NumObj = numel(obj.ScaleFactors);
+            obj.Frequency = GSV86mex('getFrequency', ComNo);
+        end
+
+        function setFrequency(obj, f)
+            if obj.Running
+                error('GSV86acq:state', 'Stop acquisition before changing the frequency');
+            end
+            GSV86mex('setFrequency', obj.ComNo, f);
+            obj.Frequency = GSV86mex('getFrequency', obj.ComNo);
+        end
+
+        function start(obj)
+            if obj.Running
+                return;
+            end
+            GSV86mex('clearDLLbuffer', obj.ComNo);
+            GSV86mex('startTX', obj.ComNo);
+            GSV86mex('workerStart', obj.ComNo, obj.FramesPerBlock, obj.NumBlocks, obj.OutputType);
+            obj.BlocksAcquired = 0;
+            obj.Timer = timer('ExecutionMode', 'fixedSpacing', 'BusyMode', 'drop', ...
+                'Period', obj.TimerPeriod, 'TimerFcn', @(~,~) obj.deliver());
+            obj.Running = true;
+            start(obj.Timer);
+        end
+
+        function stop(obj)
+            if ~obj.Running
+                return;
+            end
+            stop(obj.Timer);
+            delete(obj.Timer);
+            obj.Timer = [];
+            GSV86mex('stopTX', obj.ComNo);
+            % the worker reads the DLL buffer empty and ends, then no block
+            % changes anymore: deliver the completed and the partial block
+            [blocks, partial] = GSV86mex('workerFlush', obj.ComNo);
+            GSV86mex('workerStop', obj.ComNo);
+            obj.Running = false;
+            obj.deliverBlocks(blocks);
+            if ~isempty(partial)
+                obj.deliverBlocks(partial);
+            end
+        end
+
+        function [Pending, Stalls, FramesRead] = info(obj)
+            % Pending: completed blocks not delivered yet
+            % Stalls:  worker waits because all blocks were full
+            [Pending, Stalls, FramesRead] = GSV86mex('workerInfo', obj.ComNo);
+        end
+
+        function [values, frameNo] = latest(obj)
+            % Newest frame (1 x NumObj) without taking it from the blocks,
+            % e.g. for a display running beside the recording. Empty before
+            % the first frame and while stopped.
+            if ~obj.Running
+                values = zeros(0, obj.NumObj);
+                frameNo = -1;
+                return;
+            end
+            [values, frameNo] = GSV86mex('workerLatest', obj.ComNo);
+            if obj.Scaled && ~isempty(values)
+                values = values .* obj.ScaleFactors;
+            end
+        end
+
+        function delete(obj)
+            if obj.Running
+                stop(obj);
+            end
+            GSV86mex('release', obj.ComNo);
+        end
+    end
+
+    methods (Access = private)
+        function deliver(obj)
+            obj.deliverBlocks(GSV86mex('workerRead', obj.ComNo));
+        end
+
+        function deliverBlocks(obj, blocks)
+            for k = 1:size(blocks, 3)
+                data = blocks(:, :, k);
+                if obj.Scaled
+                    data = data .* obj.ScaleFactors;
+                end
+                obj.BlocksAcquired = obj.BlocksAcquired + 1;
+                if ~isempty(obj.DataAvailableFcn)
+                    obj.DataAvailableFcn(obj, data);
+                end
+            end
+        end
+    end
+end
@@ -0,0 +1,574 @@
+/**********************************************************************************************
+MEX gateway for MEGSV86x64.DLL / MEGSV86w32.DLL
+Replaces loadlibrary/calllib in Matlab: no header parsing at load time and no libpointer
+marshalling per call. Values are returned directly in mxArrays.
+
+Build with build_GSV86mex.m. Calling syntax (ComNo is the number of the COM port):
+
+	GSV86mex('activate', ComNo)				opens with GSV86actExt
+	GSV86mex('activate', ComNo, Bitrate, BufSize, flags)	opens with GSV86activateExtended
+	NumObj = GSV86mex('numobj', ComNo)
+	[ScaleFactors, ObjMapping, DataType] = GSV86mex('objinfo', ComNo)
+	[Values, ErrFlags] = GSV86mex('read', ComNo)		all buffered frames
+	[Values, ErrFlags] = GSV86mex('read', ComNo, MaxFrames)
+	[Values, ErrFlags] = GSV86mex('read', ComNo, MaxFrames, 'single')
+		Values is a (frames x NumObj) matrix, oldest frame in row 1; MaxFrames may be [];
+		class single with 'single' (half the memory, keeps the 24 bit device resolution)
+	n = GSV86mex('received', ComNo)
+	GSV86mex('startTX', ComNo)
+	GSV86mex('stopTX', ComNo)
+	GSV86mex('clearDLLbuffer', ComNo)
+	GSV86mex('clearDeviceBuf', ComNo)
+	GSV86mex('setFrequency', ComNo, Frequency)
+	Frequency = GSV86mex('getFrequency', ComNo)
+	GSV86mex('release', ComNo)
+	GSV86mex('releaseAll')
+
+Background acquisition (used by GSV86acq.m): a worker thread reads the DLL buffer
+and fills a ring of NumBlocks preallocated blocks of FramesPerBlock frames each.
+	GSV86mex('workerStart', ComNo, FramesPerBlock, NumBlocks)
+	GSV86mex('workerStart', ComNo, FramesPerBlock, NumBlocks, 'single')	blocks stored as single
+	Blocks = GSV86mex('workerRead', ComNo)			all completed blocks
+	Blocks = GSV86mex('workerRead', ComNo, MaxBlocks)
+		Blocks is a (FramesPerBlock x NumObj x k) array, oldest block first
+	[Pending, Stalls, FramesRead] = GSV86mex('workerInfo', ComNo)
+	[Values, FrameNo] = GSV86mex('workerLatest', ComNo)	newest frame (1 x NumObj), not consumed;
+		empty if no frame was read yet. Replaces 'clearDLLbuffer' followed by 'read'.
+	[Blocks, Partial] = GSV86mex('workerFlush', ComNo)	ends the worker after it has read the
+		DLL buffer empty (or filled all blocks), returns the completed blocks as 'workerRead'
+		and the frames of the block being filled as (frames x NumObj) matrix
+	GSV86mex('workerStop', ComNo)
+If all blocks are full, the worker stops reading and the DLL buffer (see BufSize of
+GSV86activateExtended) absorbs the values until blocks are read; this is counted in Stalls.
+'read' can't be used while a worker is running on the port.
+
+Errors returned by the DLL are thrown as Matlab errors with identifier GSV86mex:dll
+and the text of GSV86getLastErrorText.
+All ports opened with 'activate' are released with GSV86release if the MEX file
+is cleared or Matlab exits, so unloadlibrary is not needed anymore.
+************************************************************************************************/
+#include "mex.h"
+
+#ifdef _M_X64
+#include "MEGSV86x64.h"
+#else
+#include "MEGSV86w32.h"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+#define MEX_COMNO_MAX	256
+#define MEX_CMD_SIZE	32
+#define MEX_READ_FRAMES_DEF	65536	/* max. frames per 'read' without MaxFrames */
+#define MEX_WORKER_IDLE_MS	1	/* worker sleep time, if DLL buffer is empty or all blocks are full */
+#define MEX_SNAP_SPIN	64	/* 'workerLatest': retries before yielding to the worker */
+
+struct MexWorker
+{
+	std::thread Thread;
+	std::atomic<bool> Stop;
+	int ComNo;
+	int NumObj;
+	int BlockFrames;
+	int NumBlocks;
+	bool Single;			/* blocks stored in BlocksF instead of Blocks */
+	std::vector<double> Blocks;	/* NumBlocks blocks, each column-major (BlockFrames x NumObj) */
+	std::vector<float> BlocksF;
+	std::vector<double> Scratch;	/* interleaved frames from GSV86readMultiple */
+	std::atomic<uint64_t> Written;	/* completed blocks, written by worker only */
+	std::atomic<uint64_t> Read;	/* consumed blocks, written by Matlab thread only */
+	std::atomic<uint64_t> Stalls;
+	std::atomic<uint64_t> FramesRead;
+	std::atomic<bool> Failed;	/* GSV86readMultiple returned GSV_ERROR, worker has ended */
+	std::atomic<bool> Drain;	/* 'workerFlush': end when the DLL buffer is empty or all blocks are full */
+	int Fill;			/* frames in the block being filled, valid after the worker has ended */
+	/* newest frame, sequence lock: SnapSeq is odd while the worker writes SnapVal */
+	std::atomic<uint32_t> SnapSeq;
+	std::atomic<double> SnapVal[VALOBJ_NUM_MAX];
+};
+
+static bool g_Active[MEX_COMNO_MAX];
+static int g_NumObj[MEX_COMNO_MAX];	/* cached NumberOfMappedObjects, 0 if unknown */
+static MexWorker* g_Worker[MEX_COMNO_MAX];
+static std::vector<double> g_ReadBuf;
+
+static double* workerBlock(MexWorker* W, double*, size_t Ix)
+{
+	return &W->Blocks[Ix * W->BlockFrames * W->NumObj];
+}
+
+static float* workerBlock(MexWorker* W, float*, size_t Ix)
+{
+	return &W->BlocksF[Ix * W->BlockFrames * W->NumObj];
+}
+
+template <class T>
+static void workerRun(MexWorker* W)
+{
+	const int num = W->NumObj;
+	int fill = 0;	/* frames in the block being filled */
+	while (!W->Stop.load(std::memory_order_relaxed))
+	{
+		const uint64_t wr = W->Written.load(std::memory_order_relaxed);
+		if (wr - W->Read.load(std::memory_order_acquire) >= (uint64_t)W->NumBlocks)
+		{
+			if (W->Drain.load(std::memory_order_relaxed))
+				break;
+			W->Stalls.fetch_add(1, std::memory_order_relaxed);
+			std::this_thread::sleep_for(std::chrono::milliseconds(MEX_WORKER_IDLE_MS));
+			continue;
+		}
+		int valsread = 0;
+		int ret = GSV86readMultiple(W->ComNo, 0, W->Scratch.data(), (W->BlockFrames - fill) * num, &valsread, NULL);
+		if (ret == GSV_ERROR)
+		{
+			W->Fill = fill;
+			W->Failed.store(true, std::memory_order_release);
+			return;
+		}
+		const int n = valsread / num;
+		if (n <= 0)
+		{
+			if (W->Drain.load(std::memory_order_relaxed))
+				break;
+			std::this_thread::sleep_for(std::chrono::milliseconds(MEX_WORKER_IDLE_MS));
+			continue;
+		}
+		/* interleaved frames -> column-major block */
+		T* blk = workerBlock(W, (T*)NULL, (size_t)(wr % (uint64_t)W->NumBlocks));
+		for (int o = 0; o < num; o++)
+		{
+			T* col = blk + (size_t)o * W->BlockFrames + fill;
+			for (int i = 0; i < n; i++)
+				col[i] = (T)W->Scratch[(size_t)i * num + o];
+		}
+		fill += n;
+
+		const double* last = &W->Scratch[(size_t)(n - 1) * num];
+		const uint32_t seq = W->SnapSeq.load(std::memory_order_relaxed);
+		W->SnapSeq.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (int o = 0; o < num; o++)
+			W->SnapVal[o].store(last[o], std::memory_order_relaxed);
+		W->FramesRead.fetch_add((uint64_t)n, std::memory_order_relaxed);
+		W->SnapSeq.store(seq + 2, std::memory_order_release);
+		if (fill == W->BlockFrames)
+		{
+			fill = 0;
+			W->Written.store(wr + 1, std::memory_order_release);
+		}
+	}
+	W->Fill = fill;
+}
+
+static void workerStop(int ComNo)
+{
+	MexWorker* W = g_Worker[ComNo];
+	if (!W)
+		return;
+	W->Stop.store(true);
+	if (W->Thread.joinable())
+		W->Thread.join();
+	delete W;
+	g_Worker[ComNo] = NULL;
+}
+
+static void mexReleaseAll(void)
+{
+	for (int c = 0; c < MEX_COMNO_MAX; c++)
+	{
+		workerStop(c);
+		if (g_Active[c])
+			GSV86release(c);
+		g_Active[c] = false;
+		g_NumObj[c] = 0;
+	}
+}
+
+static void dllError(int ComNo)
+{
+	char txt[ERRTEXT_SIZE];
+	txt[0] = 0;
+	GSV86getLastErrorText(ComNo, txt);
+	mexErrMsgIdAndTxt("GSV86mex:dll", "COM%d: %s (0x%08X)", ComNo, txt,
+		(unsigned int)GSV86getLastProtocollError(ComNo));
+}
+
+/* Optional output class argument: false for 'double' (or missing), true for 'single' */
+static bool singleArg(int nrhs, const mxArray* prhs[], int ix)
+{
+	char cls[8];
+	if (ix >= nrhs)
+		return false;
+	if (!mxIsChar(prhs[ix]) || mxGetString(prhs[ix], cls, sizeof(cls))
+		|| (strcmp(cls, "single") && strcmp(cls, "double")))
+		mexErrMsgIdAndTxt("GSV86mex:arg", "Class must be 'single' or 'double'");
+	return cls[0] == 's';
+}
+
+static double scalarArg(int nrhs, const mxArray* prhs[], int ix, const char* what)
+{
+	if (ix >= nrhs || !mxIsNumeric(prhs[ix]) || mxGetNumberOfElements(prhs[ix]) != 1)
+		mexErrMsgIdAndTxt("GSV86mex:arg", "%s must be a numeric scalar", what);
+	return mxGetScalar(prhs[ix]);
+}
+
+static int comNoArg(int nrhs, const mxArray* prhs[])
+{
+	double c = scalarArg(nrhs, prhs, 1, "ComNo");
+	if (c < 0 || c >= MEX_COMNO_MAX || c != (int)c)
+		mexErrMsgIdAndTxt("GSV86mex:arg", "ComNo out of range");
+	return (int)c;
+}
+
+static int numObj(int ComNo)
+{
+	if (g_NumObj[ComNo] == 0)
+	{
+		int num = GSV86getValObjectInfo(ComNo, NULL, NULL, NULL);
+		if (num == GSV_ERROR)
+			dllError(ComNo);
+		g_NumObj[ComNo] = num;
+	}
+	return g_NumObj[ComNo];
+}
+
+template <class T>
+static void transposeFrames(T* out, const double* in, int num, size_t n)
+{
+	for (int o = 0; o < num; o++)
+	{
+		T* col = out + (size_t)o * n;
+		for (size_t i = 0; i < n; i++)
+			col[i] = (T)in[i * num + o];
+	}
+}
+
+static void readValues(int ComNo, int nrhs, const mxArray* prhs[], int nlhs, mxArray* plhs[])
+{
+	const int num = numObj(ComNo);
+	double maxf = (nrhs > 2 && !mxIsEmpty(prhs[2])) ? scalarArg(nrhs, prhs, 2, "MaxFrames") : MEX_READ_FRAMES_DEF;
+	if (maxf < 1 || maxf > 0x7FFFFFFF / num)
+		mexErrMsgIdAndTxt("GSV86mex:arg", "MaxFrames out of range");
+	/* all arguments checked before reading, a bad one must not drop the frames read */
+	const bool single = singleArg(nrhs, prhs, 3);
+	size_t frames = (size_t)maxf;
+	/* limit to buffered frames, to not allocate MaxFrames rows for nothing */
+	int rec = GSV86received(ComNo, 0);
+	if (rec == GSV_ERROR)
+		dllError(ComNo);
+	if ((size_t)rec < frames)
+		frames = (size_t)rec;
+
+	int valsread = 0, errflags = 0;
+	if (frames > 0)
+	{
+		if (g_ReadBuf.size() < frames * num)
+			g_ReadBuf.resize(frames * num);
+		int ret = GSV86readMultiple(ComNo, 0, g_ReadBuf.data(), (int)(frames * num), &valsread, &errflags);
+		if (ret == GSV_ERROR)
+			dllError(ComNo);
+	}
+	const size_t n = (size_t)valsread / num;
+
+	/* interleaved frames -> column-major (frames x NumObj) */
+	if (single)
+	{
+		plhs[0] = mxCreateNumericMatrix(n, num, mxSINGLE_CLASS, mxREAL);
+		transposeFrames((float*)mxGetData(plhs[0]), g_ReadBuf.data(), num, n);
+	}
+	else
+	{
+		plhs[0] = mxCreateDoubleMatrix(n, num, mxREAL);
+		transposeFrames(mxGetPr(plhs[0]), g_ReadBuf.data(), num, n);
+	}
+	if (nlhs > 1)
+		plhs[1] = mxCreateDoubleScalar(errflags);
+}
+
+static void workerStart(int ComNo, int nrhs, const mxArray* prhs[])
+{
+	if (g_Worker[ComNo])
+		mexErrMsgIdAndTxt("GSV86mex:state", "COM%d: worker already running", ComNo);
+	const int num = numObj(ComNo);
+	double bf = scalarArg(nrhs, prhs, 2, "FramesPerBlock");
+	double nb = scalarArg(nrhs, prhs, 3, "NumBlocks");
+	if (bf < 1 || bf > 0x7FFFFFFF / num || nb < 1 || nb * bf * num > 1e9)
+		mexErrMsgIdAndTxt("GSV86mex:arg", "FramesPerBlock or NumBlocks out of range");
+	const bool single = singleArg(nrhs, prhs, 4);
+	MexWorker* W = new (std::nothrow) MexWorker();
+	if (!W)
+		mexErrMsgIdAndTxt("GSV86mex:mem", "Out of memory");
+	W->ComNo = ComNo;
+	W->NumObj = num;
+	W->BlockFrames = (int)bf;
+	W->NumBlocks = (int)nb;
+	W->Single = single;
+	W->Stop.store(false);
+	W->Written.store(0);
+	W->Read.store(0);
+	W->Stalls.store(0);
+	W->FramesRead.store(0);
+	W->Failed.store(false);
+	W->Drain.store(false);
+	W->Fill = 0;
+	W->SnapSeq.store(0);
+	try
+	{
+		if (W->Single)
+			W->BlocksF.assign((size_t)W->NumBlocks * W->BlockFrames * num, 0.0f);
+		else
+			W->Blocks.assign((size_t)W->NumBlocks * W->BlockFrames * num, 0.0);
+		W->Scratch.assign((size_t)W->BlockFrames * num, 0.0);
+		W->Thread = W->Single ? std::thread(workerRun<float>, W) : std::thread(workerRun<double>, W);
+	}
+	catch (...)
+	{
+		delete W;
+		mexErrMsgIdAndTxt("GSV86mex:mem", "Out of memory or no thread available");
+	}
+	g_Worker[ComNo] = W;
+}
+
+static MexWorker* workerGet(int ComNo)
+{
+	if (!g_Worker[ComNo])
+		mexErrMsgIdAndTxt("GSV86mex:state", "COM%d: no worker running", ComNo);
+	return g_Worker[ComNo];
+}
+
+/* k blocks from block rd on as (FramesPerBlock x NumObj x k) array */
+static mxArray* workerBlocks(MexWorker* W, uint64_t rd, uint64_t k)
+{
+	const size_t blockBytes = (size_t)W->BlockFrames * W->NumObj * (W->Single ? sizeof(float) : sizeof(double));
+	mwSize dims[3] = { (mwSize)W->BlockFrames, (mwSize)W->NumObj, (mwSize)k };
+	mxArray* a = mxCreateNumericArray(3, dims, W->Single ? mxSINGLE_CLASS : mxDOUBLE_CLASS, mxREAL);
+	char* out = (char*)mxGetData(a);
+	const char* blocks = W->Single ? (const char*)W->BlocksF.data() : (const char*)W->Blocks.data();
+	for (uint64_t b = 0; b < k; b++)
+		memcpy(out + b * blockBytes, blocks + (size_t)((rd + b) % (uint64_t)W->NumBlocks) * blockBytes, blockBytes);
+	return a;
+}
+
+static void workerRead(int ComNo, int nrhs, const mxArray* prhs[], mxArray* plhs[])
+{
+	MexWorker* W = workerGet(ComNo);
+	const uint64_t rd = W->Read.load(std::memory_order_relaxed);
+	uint64_t k = W->Written.load(std::memory_order_acquire) - rd;
+	if (k == 0 && W->Failed.load(std::memory_order_acquire))
+		dllError(ComNo);
+	if (nrhs > 2)
+	{
+		double maxb = scalarArg(nrhs, prhs, 2, "MaxBlocks");
+		if (maxb < 0)
+			mexErrMsgIdAndTxt("GSV86mex:arg", "MaxBlocks out of range");
+		if ((double)k > maxb)
+			k = (uint64_t)maxb;
+	}
+	plhs[0] = workerBlocks(W, rd, k);
+	W->Read.store(rd + k, std::memory_order_release);
+}
+
+static void workerFlush(int ComNo, int nlhs, mxArray* plhs[])
+{
+	MexWorker* W = workerGet(ComNo);
+	if (W->Thread.joinable())
+	{
+		W->Drain.store(true);
+		W->Thread.join();
+	}
+	/* the worker has ended: no block changes anymore */
+	const uint64_t rd = W->Read.load(std::memory_order_relaxed);
+	const uint64_t wr = W->Written.load(std::memory_order_acquire);
+	plhs[0] = workerBlocks(W, rd, wr - rd);
+	W->Read.store(wr, std::memory_order_release);
+	if (nlhs < 2)
+		return;
+	const size_t vsize = W->Single ? sizeof(float) : sizeof(double);
+	const char* blk = (W->Single ? (const char*)W->BlocksF.data() : (const char*)W->Blocks.data())
+		+ (size_t)(wr % (uint64_t)W->NumBlocks) * W->BlockFrames * W->NumObj * vsize;
+	plhs[1] = mxCreateNumericMatrix((mwSize)W->Fill, (mwSize)W->NumObj, W->Single ? mxSINGLE_CLASS : mxDOUBLE_CLASS, mxREAL);
+	char* out = (char*)mxGetData(plhs[1]);
+	for (int o = 0; o < W->NumObj; o++)
+		memcpy(out + (size_t)o * W->Fill * vsize, blk + (size_t)o * W->BlockFrames * vsize, W->Fill * vsize);
+	W->Fill = 0;
+}
+
+static void workerInfo(int ComNo, int nlhs, mxArray* plhs[])
+{
+	MexWorker* W = workerGet(ComNo);
+	plhs[0] = mxCreateDoubleScalar((double)(W->Written.load(std::memory_order_acquire)
+		- W->Read.load(std::memory_order_relaxed)));
+	if (nlhs > 1)
+		plhs[1] = mxCreateDoubleScalar((double)W->Stalls.load(std::memory_order_relaxed));
+	if (nlhs > 2)
+		plhs[2] = mxCreateDoubleScalar((double)W->FramesRead.load(std::memory_order_relaxed));
+}
+
+static void workerLatest(int ComNo, int nlhs, mxArray* plhs[])
+{
+	MexWorker* W = workerGet(ComNo);
+	double v[VALOBJ_NUM_MAX];
+	uint64_t frames;
+	for (unsigned spin = 0; ; spin++)
+	{
+		const uint32_t seq = W->SnapSeq.load(std::memory_order_acquire);
+		if (!(seq & 1))
+		{
+			for (int o = 0; o < W->NumObj; o++)
+				v[o] = W->SnapVal[o].load(std::memory_order_relaxed);
+			frames = W->FramesRead.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (W->SnapSeq.load(std::memory_order_relaxed) == seq)
+				break;
+		}
+		if (spin >= MEX_SNAP_SPIN)
+			std::this_thread::yield();
+	}
+	const int num = frames ? W->NumObj : 0;
+	plhs[0] = mxCreateDoubleMatrix(frames ? 1 : 0, num, mxREAL);
+	memcpy(mxGetPr(plhs[0]), v, num * sizeof(double));
+	if (nlhs > 1)
+		plhs[1] = mxCreateDoubleScalar(frames ? (double)(frames - 1) : -1.0);
+}
+
+static void objInfo(int ComNo, int nlhs, mxArray* plhs[])
+{
+	double sf[VALOBJ_NUM_MAX];
+	unsigned long map[VALOBJ_NUM_MAX];
+	int dtype = 0;
+	int num = GSV86getValObjectInfo(ComNo, sf, map, &dtype);
+	if (num == GSV_ERROR)
+		dllError(ComNo);
+	g_NumObj[ComNo] = num;
+	plhs[0] = mxCreateDoubleMatrix(1, num, mxREAL);
+	memcpy(mxGetPr(plhs[0]), sf, num * sizeof(double));
+	if (nlhs > 1)
+	{
+		plhs[1] = mxCreateNumericMatrix(1, num, mxUINT32_CLASS, mxREAL);
+		unsigned int* m = (unsigned int*)mxGetData(plhs[1]);
+		for (int o = 0; o < num; o++)
+			m[o] = (unsigned int)map[o];
+	}
+	if (nlhs > 2)
+		plhs[2] = mxCreateDoubleScalar(dtype);
+}
+
+/* Commands with ComNo only and a simple errorcode as result */
+static int simpleCmd(const char* Cmd, int ComNo, bool* Known)
+{
+	*Known = true;
+	if (!strcmp(Cmd, "startTX"))
+		return GSV86startTX(ComNo);
+	if (!strcmp(Cmd, "stopTX"))
+		return GSV86stopTX(ComNo);
+	if (!strcmp(Cmd, "clearDLLbuffer"))
+		return GSV86clearDLLbuffer(ComNo);
+	if (!strcmp(Cmd, "clearDeviceBuf"))
+		return GSV86clearDeviceBuf(ComNo);
+	*Known = false;
+	return GSV_OK;
+}
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+	static bool registered = false;
+	if (!registered)
+	{
+		mexAtExit(mexReleaseAll);
+		registered = true;
+	}
+
+	char cmd[MEX_CMD_SIZE];
+	if (nrhs < 1 || !mxIsChar(prhs[0]) || mxGetString(prhs[0], cmd, sizeof(cmd)))
+		mexErrMsgIdAndTxt("GSV86mex:arg", "First argument must be a command string");
+
+	if (!strcmp(cmd, "releaseAll"))
+	{
+		mexReleaseAll();
+		return;
+	}
+	const int com = comNoArg(nrhs, prhs);
+
+	if (!strcmp(cmd, "activate"))
+	{
+		int ret;
+		if (nrhs > 2)
+			ret = GSV86activateExtended(com, (unsigned long)scalarArg(nrhs, prhs, 2, "Bitrate"),
+				(unsigned long)scalarArg(nrhs, prhs, 3, "BufSize"),
+				nrhs > 4 ? (unsigned long)scalarArg(nrhs, prhs, 4, "flags") : 0);
+		else
+			ret = GSV86actExt(com);
+		if (ret == GSV_ERROR)
+			dllError(com);
+		g_Active[com] = true;
+		g_NumObj[com] = 0;
+	}
+	else if (!strcmp(cmd, "release"))
+	{
+		workerStop(com);
+		g_Active[com] = false;
+		g_NumObj[com] = 0;
+		if (GSV86release(com) == GSV_ERROR)
+			dllError(com);
+	}
+	else if (!strcmp(cmd, "read"))
+	{
+		if (g_Worker[com])
+			mexErrMsgIdAndTxt("GSV86mex:state", "COM%d: 'read' not possible while worker is running", com);
+		readValues(com, nrhs, prhs, nlhs, plhs);
+	}
+	else if (!strcmp(cmd, "workerStart"))
+		workerStart(com, nrhs, prhs);
+	else if (!strcmp(cmd, "workerRead"))
+		workerRead(com, nrhs, prhs, plhs);
+	else if (!strcmp(cmd, "workerInfo"))
+		workerInfo(com, nlhs, plhs);
+	else if (!strcmp(cmd, "workerLatest"))
+		workerLatest(com, nlhs, plhs);
+	else if (!strcmp(cmd, "workerFlush"))
+		workerFlush(com, nlhs, plhs);
+	else if (!strcmp(cmd, "workerStop"))
+		workerStop(com);
+	else if (!strcmp(cmd, "numobj"))
+	{
+		g_NumObj[com] = 0;
+		plhs[0] = mxCreateDoubleScalar(numObj(com));
+	}
+	else if (!strcmp(cmd, "objinfo"))
+		objInfo(com, nlhs, plhs);
+	else if (!strcmp(cmd, "received"))
+	{
+		int n = GSV86received(com, 0);
+		if (n == GSV_ERROR)
+			dllError(com);
+		plhs[0] = mxCreateDoubleScalar(n);
+	}
+	else if (!strcmp(cmd, "setFrequency"))
+	{
+		if (GSV86setFrequency(com, scalarArg(nrhs, prhs, 2, "Frequency")) == GSV_ERROR)
+			dllError(com);
+	}
+	else if (!strcmp(cmd, "getFrequency"))
+	{
+		double f = GSV86getFrequency(com);
+		if (f == (double)GSV_ERROR)
+			dllError(com);
+		plhs[0] = mxCreateDoubleScalar(f);
+	}
+	else
+	{
+		bool known;
+		int ret = simpleCmd(cmd, com, &known);
+		if (!known)
+			mexErrMsgIdAndTxt("GSV86mex:cmd", "Unknown command '%s'", cmd);
+		if (ret == GSV_ERROR)
+			dllError(com);
+	}
+}
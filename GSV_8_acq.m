@@ -0,0 +1,40 @@
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+% Matlab example for background acquisition with a GSV-8 (GSV86acq)         %
+% (build GSV86mex first with build_GSV86mex.m)                               %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+%% define the COM Port
+com = 3;
+
+acq = GSV86acq(com, 'FramesPerBlock', 900, 'NumBlocks', 200);
+acq.setFrequency(18000);
+
+num = acq.NumObj;
+h = gobjects(1,num);
+colors = lines(num);
+for k = 1:num
+    h(k) = animatedline('Color',colors(k,:),'MaximumNumPoints',200000);
+end
+ax = gca;
+ax.YGrid = 'on';
+
+% plotting runs in the callback; the worker keeps on acquiring while it draws
+acq.DataAvailableFcn = @(src,data) plotBlock(src,data,h,ax);
+start(acq);
+
+pause(60);      % acquire for one minute; Matlab stays responsive meanwhile
+
+stop(acq);
+[~, stalls] = info(acq);
+fprintf('%d blocks, worker stalls: %d\n', acq.BlocksAcquired, stalls);
+delete(acq);    % release Channel
+
+function plotBlock(src, data, h, ax)
+    n = size(data,1);
+    t = ((src.BlocksAcquired-1)*n + (0:n-1)') / src.Frequency;
+    for k = 1:numel(h)
+        addpoints(h(k), t, data(:,k));
+    end
+    ax.XLim = [max(0, t(end)-60) max(t(end), eps)];
+    drawnow limitrate
+end
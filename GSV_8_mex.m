@@ -0,0 +1,58 @@
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+% Matlab example for communication with a GSV-8 using the MEX gateway        %
+% (build GSV86mex first with build_GSV86mex.m)                               %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+%% define the COM Port
+com = 3;
+
+% activate channel and start the transmission
+GSV86mex('activate',com);
+GSV86mex('startTX',com);
+
+% setting the sampling rate
+GSV86mex('setFrequency',com,18000);
+
+% scale factors and number of value-objects in the measuring frame
+sf = GSV86mex('objinfo',com);
+num = numel(sf);
+
+h = gobjects(1,num);
+colors = lines(num);
+for k = 1:num
+    h(k) = animatedline('Color',colors(k,:),'MaximumNumPoints',200000);
+end
+
+fig = gcf;
+fig.Color = 'w';
+
+ax = gca;
+ax.Color = [1 1 1];
+ax.YGrid = 'on';
+ax.GridColor = [0 0 0];
+ax.YLimMode = 'auto';
+stop = false;
+fs = GSV86mex('getFrequency',com);
+n = 0;                       % number of frames read so far
+
+GSV86mex('clearDLLbuffer',com);
+while ~stop && isvalid(fig)
+    % all frames received since the last call, one row per frame
+    data = GSV86mex('read',com);
+    if ~isempty(data)
+        t = (n + (0:size(data,1)-1)') / fs;
+        n = n + size(data,1);
+        for k = 1:num
+            addpoints(h(k),t,data(:,k));
+        end
+        t = n / fs;
+        if (t < 60) % defines the window time
+            ax.XLim = [0 t];
+        else
+            ax.XLim = [t-60 t];
+        end
+    end
+    drawnow limitrate
+    pause(0.01);
+end
+GSV86mex('release',com)      % release Channel
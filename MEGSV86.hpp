@@ -0,0 +1,471 @@
+/**********************************************************************************************
+C++ header-only wrapper for MEGSV86x64.DLL / MEGSV86w32.DLL
+- gsv86::Device owns an opened COM port: GSV86activateExtended in open(), GSV86release in
+  the destructor. Devices are movable, not copyable.
+- Functions return gsv86::Result<T>: either a value or a gsv86::Error with the error code
+  retrieved by GSV86getLastProtocollError. Error texts are taken from Errorcodes.h.
+  As with std::expected, Result::value() throws gsv86::BadResultAccess if there is no value.
+- Value buffers are passed as gsv86::span (std::span with C++20). The read functions don't
+  allocate heap memory.
+Requires C++17.
+************************************************************************************************/
+#ifndef MEGSV86_HPP
+#define MEGSV86_HPP
+
+#ifdef _M_X64
+#include "MEGSV86x64.h"
+#else
+#include "MEGSV86w32.h"
+#endif
+
+#include <cstddef>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#define MEGSV86_STD_SPAN
+#endif
+#endif
+
+namespace gsv86
+{
+
+#ifdef MEGSV86_STD_SPAN
+template <class T> using span = std::span<T>;
+#else
+/* Minimal replacement of std::span (dynamic extent only) */
+template <class T> class span
+{
+public:
+	constexpr span() noexcept : p_(nullptr), n_(0) {}
+	constexpr span(T* p, std::size_t n) noexcept : p_(p), n_(n) {}
+	template <std::size_t N> constexpr span(T (&a)[N]) noexcept : p_(a), n_(N) {}
+	template <class C, class = typename std::enable_if<
+		std::is_convertible<decltype(std::declval<C&>().data()), T*>::value>::type>
+	constexpr span(C& c) noexcept : p_(c.data()), n_(c.size()) {}
+	constexpr T* data() const noexcept { return p_; }
+	constexpr std::size_t size() const noexcept { return n_; }
+	constexpr bool empty() const noexcept { return n_ == 0; }
+	constexpr T& operator[](std::size_t i) const noexcept { return p_[i]; }
+	constexpr T* begin() const noexcept { return p_; }
+	constexpr T* end() const noexcept { return p_ + n_; }
+	constexpr span first(std::size_t n) const noexcept { return span(p_, n); }
+	constexpr span subspan(std::size_t off, std::size_t n) const noexcept { return span(p_ + off, n); }
+private:
+	T* p_;
+	std::size_t n_;
+};
+#endif
+
+/* Data type of the measuring values sent by the device, see GSV86getValObjectInfo */
+enum class DataType : int
+{
+	Int16 = DATATYP_INT16,
+	Int24 = DATATYP_INT24,
+	Float = DATATYP_FLOAT
+};
+
+/* Digital filter selection (IIR or FIR), parameter Type(In) of the GSV86*Dfilter* functions */
+enum class FilterKind : int
+{
+	Iir = FILT_TYPE_IIR,
+	Fir = FILT_TYPE_FIR
+};
+
+/* Digital filter type as returned by GSV86getDfilterType. FIR types carry their order
+   in Bits<3:0>, so FIR values are not limited to the enumerators below. */
+enum class FilterType : int
+{
+	Unconfigured = FILT_TYPE_UNCONFIG,
+	IirLowPass = FILT_TYPE_IIR_LP,
+	IirHighPass = FILT_TYPE_IIR_HP,
+	IirBandPass = FILT_TYPE_IIR_BP,
+	IirBandStop = FILT_TYPE_IIR_BS
+};
+
+constexpr bool filterIsFir(FilterType t) noexcept { return ((int)t & FILT_TYPE_FIR) != 0; }
+constexpr int filterOrder(FilterType t) noexcept { return (int)t & FILT_ORDER_MSK; }
+/* FILT_CHARACT_LP, _HP, _BP, _BS or _COMB */
+constexpr int filterCharacteristic(FilterType t) noexcept { return (int)t & FILT_CHARACT_MSK; }
+
+/* Error code as retrieved by GSV86getLastProtocollError */
+class Error
+{
+public:
+	constexpr Error() noexcept : code_(0) {}
+	constexpr explicit Error(int Code) noexcept : code_(Code) {}
+	constexpr int code() const noexcept { return code_; }
+	/* error thrown by the device, device error code in deviceCode() */
+	constexpr bool fromDevice() const noexcept { return ((unsigned)code_ & ERR_MASK_ALL) == ERR_MSK_DEVICE; }
+	constexpr int deviceCode() const noexcept { return code_ & 0xFF; }
+	/* Windows system error code (GetLastError), if the COM port could not be opened */
+	constexpr bool fromSystem() const noexcept { return ((unsigned)code_ & ERR_MASK_ALL) == 0 || ((unsigned)code_ & ERR_MASK_ALL) == OWN_ERR_MASK; }
+	/* Error text from Errorcodes.h; "" if the code is not listed there */
+	const char* text() const noexcept
+	{
+		if (fromDevice())
+			return deviceText(deviceCode());
+		if ((code_ & ~0xFF) == TEDS_ERR_MASK)
+			return deviceText(code_ & 0xFF);
+		return dllText(code_);
+	}
+
+private:
+	static const char* deviceText(int c) noexcept
+	{
+		switch (c)
+		{
+		case ERR_OK_CHANGED: return ERR_OK_CHANGED_TXT;
+		case ERR_CMD_NOTKNOWN: return ERR_CMD_NOTKNOWN_TXT;
+		case ERR_CMD_NOTIMPL: return ERR_CMD_NOTIMPL_TXT;
+		case ERR_FRAME_ERROR: return ERR_FRAME_ERROR_TXT;
+		case ERR_PAR: return ERR_PAR_TXT;
+		case ERR_PAR_ADR: return ERR_PAR_ADR_TXT;
+		case ERR_PAR_DAT: return ERR_PAR_DAT_TXT;
+		case ERR_PAR_BITS: return ERR_PAR_BITS_TXT;
+		case ERR_PAR_ABSBIG: return ERR_PAR_ABSBIG_TXT;
+		case ERR_PAR_ABSMALL: return ERR_PAR_ABSMALL_TXT;
+		case ERR_PAR_COMBI: return ERR_PAR_COMBI_TXT;
+		case ERR_PAR_RELBIG: return ERR_PAR_RELBIG_TXT;
+		case ERR_PAR_RELSMALL: return ERR_PAR_RELSMALL_TXT;
+		case ERR_PAR_NOTIMPL: return ERR_PAR_NOTIMPL_TXT;
+		case ERR_WRONG_PAR_NUM: return ERR_WRONG_PAR_NUM_TXT;
+		case ERR_PAR_NOFIT_SETTINGS: return ERR_PAR_NOFIT_SETTINGS_TXT;
+		case ERR_PAR_HW_COLLISION: return ERR_PAR_HW_COLLISION_TXT;
+		case ERR_NO_DATA_AVAIL: return ERR_NO_DATA_AVAIL_TXT;
+		case ERR_DATA_INCONSISTENT: return ERR_DATA_INCONSISTENT_TXT;
+		case ERR_WRONG_MOD_STATE: return ERR_WRONG_MOD_STATE_TXT;
+		case ERR_NOT_SUPPORTED_D: return ERR_NOT_SUPPORTED_D_TXT;
+		case ERR_FDATA_TOO_HIGH: return ERR_FDATA_TOO_HIGH_TXT;
+		case ERR_MEMORY_WRONG_COND: return ERR_MEMORY_WRONG_COND_TXT;
+		case ERR_MEMORY_ACCESS_DENIED: return ERR_MEMORY_ACCESS_DENIED_TXT;
+		case ERR_ACC_DEN: return ERR_ACC_DEN_TXT;
+		case ERR_ACC_BLK: return ERR_ACC_BLK_TXT;
+		case ERR_ACC_PWD: return ERR_ACC_PWD_TXT;
+		case ERR_ACC_MAXWR: return ERR_ACC_MAXWR_TXT;
+		case ERR_ACC_PORT: return ERR_ACC_PORT_TXT;
+		case ERR_INTERNAL: return ERR_INTERNAL_TXT;
+		case ERR_ARITH: return ERR_ARITH_TXT;
+		case ERR_INTER_ADC: return ERR_INTER_ADC_TXT;
+		case ERR_MWERT_ERR: return ERR_MWERT_ERR_TXT;
+		case ERR_EEPROM: return ERR_EEPROM_TXT;
+		case ERR_RET_TXBUF: return ERR_RET_TXBUF_TXT;
+		case ERR_RET_BUSY: return ERR_RET_BUSY_TXT;
+		case ERR_RET_RXBUF: return ERR_RET_RXBUF_TXT;
+		case GETTEDS_ERR_NOSENSOR: return GETTEDS_ERR_NOSENSOR_TXT;
+		case GETTEDS_ERR_NOTEDSEE: return GETTEDS_ERR_NOTEDSEE_TXT;
+		case GETTEDS_ERR_BASICONLY: return GETTEDS_ERR_BASICONLY_TXT;
+		case GETTEDS_ERR_NOTEDSDAT: return GETTEDS_ERR_NOTEDSDAT_TXT;
+		case GETTEDS_ERR_ENTRY_INVALID: return GETTEDS_ERR_ENTRY_INVALID_TXT;
+		case GETTEDS_ERR_TOUT: return GETTEDS_ERR_TOUT_TXT;
+		case GETTEDS_ERR_CHKSUM: return GETTEDS_ERR_CHKSUM_TXT;
+		case GETTEDS_ERR_UNKNOWN_TEMPL: return GETTEDS_ERR_UNKNOWN_TEMPL_TXT;
+		case GETTEDS_ERR_VERIFY_FAIL: return GETTEDS_ERR_VERIFY_FAIL_TXT;
+		default: return "";
+		}
+	}
+
+	static const char* dllText(int c) noexcept
+	{
+		switch (c)
+		{
+		case ERR_MUTEXFAILED: return ERR_MUTEXFAILED_TXT;
+		case ERR_EVENTFAILED: return ERR_EVENTFAILED_TXT;
+		case ERR_MEM_ALLOC: return ERR_MEM_ALLOC_TXT;
+		case ERR_NO_GSV_FOUND: return ERR_NO_GSV_FOUND_TXT;
+		case ERR_BYTES_WRITTEN: return ERR_BYTES_WRITTEN_TXT;
+		case ERR_WRONG_PARAMETER: return ERR_WRONG_PARAMETER_TXT;
+		case ERR_NO_GSV_ANSWER: return ERR_NO_GSV_ANSWER_TXT;
+		case ERR_WRONG_ANSWER_NUM: return ERR_WRONG_ANSWER_NUM_TXT;
+		case ERR_WRONG_ANSWER: return ERR_WRONG_ANSWER_TXT;
+		case ERR_WRONG_FRAME_SUFFIX: return ERR_WRONG_FRAME_SUFFIX_TXT;
+		case ERR_NOT_SUPPORTED: return ERR_NOT_SUPPORTED_TXT;
+		case ERR_WRONG_COMNO: return ERR_WRONG_COMNO_TXT;
+		case ERR_COM_ALREADY_OPEN: return ERR_COM_ALREADY_OPEN_TXT;
+		case ERR_COM_GEN_FAILURE: return ERR_COM_GEN_FAILURE_TXT;
+		case ERR_INTERNAL_FUNC: return ERR_INTERNAL_FUNC_TXT;
+		case ERR_PARAM_NOT_STORED: return ERR_PARAM_NOT_STORED_TXT;
+		case ERR_FILE_CONTENT: return ERR_FILE_CONTENT_TXT;
+		case ERR_UNKNOWN_VALUE: return ERR_UNKNOWN_VALUE_TXT;
+		case DF_ERR_NOT_INIT: return DF_ERR_NOT_INIT_TXT;
+		case DF_ERR_OPT_WRONG: return DF_ERR_OPT_WRONG_TXT;
+		case DF_ERR_NO_CONVERGENCE: return DF_ERR_NO_CONVERGENCE_TXT;
+		case DF_ERR_COEFF_SUM_TOOBIG: return DF_ERR_COEFF_SUM_TOOBIG_TXT;
+		case DF_ERR_INTERN_GAIN_TOO_BIG: return DF_ERR_INTERN_GAIN_TOO_BIG_TXT;
+		case DF_ERR_FIR_ODD_ORDER_NOTALLOWED: return DF_ERR_FIR_ODD_ORDER_NOTALLOWED_TXT;
+		default: return "";
+		}
+	}
+
+	int code_;
+};
+
+/* Thrown by Result::value() without value, in the style of std::bad_expected_access */
+class BadResultAccess : public std::exception
+{
+public:
+	explicit BadResultAccess(Error e) noexcept : err_(e) {}
+	const Error& error() const noexcept { return err_; }
+	const char* what() const noexcept override { return "gsv86::Result has no value"; }
+private:
+	Error err_;
+};
+
+/* Value or Error, in the style of std::expected */
+template <class T> class Result
+{
+public:
+	Result(T v) : val_(std::move(v)), ok_(true) {}
+	Result(Error e) : val_(), err_(e), ok_(false) {}
+	bool has_value() const noexcept { return ok_; }
+	explicit operator bool() const noexcept { return ok_; }
+	/* checked access; operator* and operator-> are unchecked */
+	T& value() & { check(); return val_; }
+	const T& value() const& { check(); return val_; }
+	T&& value() && { check(); return std::move(val_); }
+	T& operator*() noexcept { return val_; }
+	T* operator->() noexcept { return &val_; }
+	const Error& error() const noexcept { return err_; }
+	T value_or(T def) const { return ok_ ? val_ : def; }
+private:
+	void check() const
+	{
+		if (!ok_)
+			throw BadResultAccess(err_);
+	}
+
+	T val_;
+	Error err_;
+	bool ok_;
+};
+
+template <> class Result<void>
+{
+public:
+	Result() noexcept : ok_(true) {}
+	Result(Error e) noexcept : err_(e), ok_(false) {}
+	bool has_value() const noexcept { return ok_; }
+	explicit operator bool() const noexcept { return ok_; }
+	const Error& error() const noexcept { return err_; }
+private:
+	Error err_;
+	bool ok_;
+};
+
+class Device
+{
+	static constexpr std::size_t FLOAT_CHUNK_VALS = 1024;	/* stack buffer of readFrames(span<float>) */
+
+public:
+	/* Not opened device; use open() */
+	Device() noexcept : com_(-1), numObj_(0), dataType_(DataType::Float) {}
+	Device(const Device&) = delete;
+	Device& operator=(const Device&) = delete;
+	Device(Device&& o) noexcept { moveFrom(o); }
+	Device& operator=(Device&& o) noexcept
+	{
+		if (this != &o)
+		{
+			close();
+			moveFrom(o);
+		}
+		return *this;
+	}
+	~Device() { close(); }
+
+	/* Opens device with GSV86activateExtended and reads the value object info */
+	static Result<Device> open(int ComNo, unsigned long Bitrate = CONST_BAUDRATE,
+		unsigned long BufSize = CONST_BUFSIZE, unsigned long flags = 0)
+	{
+		if (GSV86activateExtended(ComNo, Bitrate, BufSize, flags) == GSV_ERROR)
+			return Error(GSV86getLastProtocollError(ComNo));
+		Device d;
+		d.com_ = ComNo;
+		Result<void> r = d.refreshObjectInfo();
+		if (!r)
+			return r.error();
+		return Result<Device>(std::move(d));
+	}
+
+	/* Releases the port with GSV86release; done by the destructor, too */
+	void close() noexcept
+	{
+		if (com_ >= 0)
+			GSV86release(com_);
+		com_ = -1;
+	}
+
+	bool isOpen() const noexcept { return com_ >= 0; }
+	int comNo() const noexcept { return com_; }
+
+	/* Value object info as read by open() or refreshObjectInfo() */
+	int numObj() const noexcept { return numObj_; }
+	DataType dataType() const noexcept { return dataType_; }
+	span<const double> scaleFactors() const noexcept { return span<const double>(scale_, (std::size_t)numObj_); }
+	span<const unsigned long> objMapping() const noexcept { return span<const unsigned long>(map_, (std::size_t)numObj_); }
+
+	/* Has to be called after NormFactor(s) or Mode-States were changed */
+	Result<void> refreshObjectInfo() noexcept
+	{
+		int dt = 0;
+		int num = GSV86getValObjectInfo(com_, scale_, map_, &dt);
+		if (num == GSV_ERROR)
+			return lastError();
+		numObj_ = num;
+		dataType_ = (DataType)dt;
+		return Result<void>();
+	}
+
+	/* Reads all frames fitting into out (size must be a multiple of numObj()), interleaved
+	   as by GSV86readMultiple. Returns number of frames read (0 if buffer was empty). */
+	Result<std::size_t> readFrames(span<double> out, int* ErrFlags = nullptr) noexcept
+	{
+		Result<void> r = readable();
+		if (!r)
+			return r.error();
+		const std::size_t count = out.size() - out.size() % (std::size_t)numObj_;
+		if (count == 0)
+			return Error(ERR_WRONG_PARAMETER);
+		int valsread = 0;
+		if (GSV86readMultiple(com_, 0, out.data(), (int)count, &valsread, ErrFlags) == GSV_ERROR)
+			return lastError();
+		return (std::size_t)valsread / (std::size_t)numObj_;
+	}
+
+	/* Same as above, but converts the values to float. The DLL delivers double only,
+	   so values are read in chunks through a buffer on the stack. */
+	Result<std::size_t> readFrames(span<float> out, int* ErrFlags = nullptr) noexcept
+	{
+		Result<void> r = readable();
+		if (!r)
+			return r.error();
+		const std::size_t num = (std::size_t)numObj_;
+		const std::size_t chunk = FLOAT_CHUNK_VALS / num * num;
+		const std::size_t count = out.size() - out.size() % num;
+		if (count == 0)
+			return Error(ERR_WRONG_PARAMETER);
+		double buf[FLOAT_CHUNK_VALS];
+		std::size_t done = 0;
+		int flags = 0;
+		while (done < count)
+		{
+			const std::size_t n = count - done < chunk ? count - done : chunk;
+			int valsread = 0, f = 0;
+			if (GSV86readMultiple(com_, 0, buf, (int)n, &valsread, &f) == GSV_ERROR)
+				return lastError();
+			flags |= f;
+			for (int i = 0; i < valsread; i++)
+				out[done + i] = (float)buf[i];
+			done += (std::size_t)valsread;
+			if ((std::size_t)valsread < n)
+				break;
+		}
+		if (ErrFlags)
+			*ErrFlags = flags;
+		return done / num;
+	}
+
+	/* Reads values of one object Obj (1..numObj()). Returns number of values read. */
+	Result<std::size_t> readObject(int Obj, span<double> out) noexcept
+	{
+		if (out.empty())
+			return Error(ERR_WRONG_PARAMETER);
+		int valsread = 0;
+		if (GSV86readMultiple(com_, Obj, out.data(), (int)out.size(), &valsread, nullptr) == GSV_ERROR)
+			return lastError();
+		return (std::size_t)valsread;
+	}
+
+	/* Number of frames in the DLL buffer */
+	Result<std::size_t> received() noexcept
+	{
+		int n = GSV86received(com_, 0);
+		if (n == GSV_ERROR)
+			return lastError();
+		return (std::size_t)n;
+	}
+
+	Result<void> startTX() noexcept { return simple(GSV86startTX(com_)); }
+	Result<void> stopTX() noexcept { return simple(GSV86stopTX(com_)); }
+	Result<void> clearDLLbuffer() noexcept { return simple(GSV86clearDLLbuffer(com_)); }
+	Result<void> clearDeviceBuf() noexcept { return simple(GSV86clearDeviceBuf(com_)); }
+	Result<void> setFrequency(double Frequency) noexcept { return simple(GSV86setFrequency(com_, Frequency)); }
+	Result<void> setZero(int Chan) noexcept { return simple(GSV86setZero(com_, Chan)); }
+
+	Result<double> frequency() noexcept
+	{
+		double f = GSV86getFrequency(com_);
+		if (f == (double)GSV_ERROR)
+			return lastError();
+		return f;
+	}
+
+	Result<int> serialNo() noexcept
+	{
+		int s = GSV86getSerialNo(com_);
+		if (s == GSV_ERROR)
+			return lastError();
+		return s;
+	}
+
+	Result<FilterType> filterType(int Chan, FilterKind Kind) noexcept
+	{
+		int t = GSV86getDfilterType(com_, Chan, (int)Kind);
+		if (t == GSV_ERROR)
+			return lastError();
+		return (FilterType)t;
+	}
+
+	/* Chan =1..8; for all channels use GSV86setDfilterOnOff with Chan=0 */
+	Result<void> setFilterOnOff(int Chan, FilterKind Kind, bool On) noexcept
+	{
+		return simple(GSV86setDfilterOnOff(com_, Chan, (int)Kind, On ? 1 : 0));
+	}
+
+	Error lastError() const noexcept { return Error(GSV86getLastProtocollError(com_)); }
+
+private:
+	/* Frames can be read: device opened and value object info present */
+	Result<void> readable() const noexcept
+	{
+		if (!isOpen())
+			return Error(ERR_WRONG_COMNO);
+		if (numObj_ <= 0)
+			return Error(ERR_WRONG_PARAMETER);
+		return Result<void>();
+	}
+
+	Result<void> simple(int ret) const noexcept
+	{
+		if (ret == GSV_ERROR)
+			return lastError();
+		return Result<void>();
+	}
+
+	void moveFrom(Device& o) noexcept
+	{
+		com_ = o.com_;
+		numObj_ = o.numObj_;
+		dataType_ = o.dataType_;
+		for (int i = 0; i < VALOBJ_NUM_MAX; i++)
+		{
+			scale_[i] = o.scale_[i];
+			map_[i] = o.map_[i];
+		}
+		o.com_ = -1;
+		o.numObj_ = 0;
+	}
+
+	int com_;
+	int numObj_;
+	DataType dataType_;
+	double scale_[VALOBJ_NUM_MAX];
+	unsigned long map_[VALOBJ_NUM_MAX];
+};
+
+} /* namespace gsv86 */
+
+#endif /* MEGSV86_HPP */
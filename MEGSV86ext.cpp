@@ -0,0 +1,366 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: device registry, host frame ring and GSV86extPoll
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <cstring>
+#include <thread>
+
+#define EXT_SNAP_SPIN	64	/* GSV86extGetLatest: retries before yielding to the publishing thread */
+
+static ExtDeviceRef g_Dev[EXT_COMNO_MAX];
+static std::mutex g_DevLock;
+
+/* Last error per ComNo. DllErr is set, if the error was raised by MEGSV86xx.DLL */
+static std::atomic<int> g_LastErr[EXT_COMNO_MAX];	/* written by the poll, async, scan and discovery threads */
+static std::atomic<bool> g_DllErr[EXT_COMNO_MAX];
+
+static bool extComNoValid(int ComNo)
+{
+	return ComNo >= 0 && ComNo < EXT_COMNO_MAX;
+}
+
+void extSetError(int ComNo, int Err)
+{
+	if (!extComNoValid(ComNo))
+		return;
+	g_LastErr[ComNo].store(Err, std::memory_order_relaxed);
+	g_DllErr[ComNo].store(false, std::memory_order_relaxed);
+}
+
+void extSetDllError(int ComNo)
+{
+	if (!extComNoValid(ComNo))
+		return;
+	g_LastErr[ComNo].store(GSV86getLastProtocollError(ComNo), std::memory_order_relaxed);
+	g_DllErr[ComNo].store(true, std::memory_order_relaxed);
+}
+
+ExtDeviceRef extGetDevice(int ComNo)
+{
+	if (!extComNoValid(ComNo))
+		return NULL;
+	std::lock_guard<std::mutex> lk(g_DevLock);
+	ExtDeviceRef dev = g_Dev[ComNo];
+	if (!dev)
+		extSetError(ComNo, ERR_EXT_NOT_ATTACHED);
+	return dev;
+}
+
+ExtDeviceRef extFindDevice(int ComNo)
+{
+	if (!extComNoValid(ComNo))
+		return NULL;
+	std::lock_guard<std::mutex> lk(g_DevLock);
+	return g_Dev[ComNo];
+}
+
+/* Stop the threads working on Dev and free its stages. Done by GSV86extDetach and again when the
+   last reference is dropped, for stages created by calls racing with GSV86extDetach. */
+static void extDevClose(ExtDevice* Dev)
+{
+	extNetFree(Dev);
+	extLowLatFree(Dev);
+	std::lock_guard<std::mutex> lk(Dev->Lock);
+	extTrigFreeAll(Dev);
+	extResampFreeAll(Dev);
+	extCursorFreeAll(Dev);
+	extShmFree(Dev);
+	extReconFree(Dev);
+}
+
+static void extDevDelete(ExtDevice* Dev)
+{
+	extDevClose(Dev);
+	extStatsFree(Dev);	/* read without Dev->Lock: only when no reference is left */
+	delete Dev;
+}
+
+unsigned long CALLTYP GSV86extVersion(void)
+{
+	return ((unsigned long)EXTVER_H << 16) | EXTVER_L;
+}
+
+int CALLTYP GSV86extAttach(int ComNo, unsigned long RingFrames, unsigned long flags)
+{
+	(void)flags;
+	if (!extComNoValid(ComNo))
+		return GSV_ERROR;
+	{
+		std::lock_guard<std::mutex> lk(g_DevLock);
+		if (g_Dev[ComNo])
+		{
+			extSetError(ComNo, ERR_EXT_ALREADY_ATTACHED);
+			return GSV_ERROR;
+		}
+	}
+	ExtDevice* dev = new (std::nothrow) ExtDevice();
+	if (!dev)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	dev->ComNo = ComNo;
+	int num = GSV86getValObjectInfo(ComNo, dev->ScaleFactors, dev->ObjMapping, &dev->DataType);
+	if (num == GSV_ERROR || num < 1 || num > VALOBJ_NUM_MAX)
+	{
+		if (num == GSV_ERROR)
+			extSetDllError(ComNo);
+		else
+			extSetError(ComNo, ERR_UNKNOWN_VALUE);
+		delete dev;
+		return GSV_ERROR;
+	}
+	dev->NumObj = num;
+	dev->Kern = extGetKernels(num);
+	dev->Frequency = GSV86getFrequency(ComNo);
+	if (dev->Frequency == (double)GSV_ERROR)
+	{
+		extSetDllError(ComNo);
+		delete dev;
+		return GSV_ERROR;
+	}
+
+	if (RingFrames == 0)
+		RingFrames = EXT_RING_FRAMES_DEF;
+	if (RingFrames < EXT_RING_FRAMES_MIN)
+		RingFrames = EXT_RING_FRAMES_MIN;
+	uint64_t cap = 1;
+	while (cap < RingFrames)
+		cap <<= 1;
+	dev->RingFrames = cap;
+	dev->RingMask = cap - 1;
+	dev->FrameCount.store(0);
+	try
+	{
+		dev->RingHeap.assign((size_t)cap * num, 0.0);
+		dev->Ring = dev->RingHeap.data();
+		dev->PullBuf.assign((size_t)EXT_PULL_FRAMES * num, 0.0);
+	}
+	catch (...)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		delete dev;
+		return GSV_ERROR;
+	}
+
+	ExtDeviceRef ref;
+	try
+	{
+		ref = ExtDeviceRef(dev, extDevDelete);
+	}
+	catch (...)
+	{
+		/* dev deleted by shared_ptr */
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(g_DevLock);
+	if (g_Dev[ComNo])
+	{
+		/* attached by another thread meanwhile */
+		extSetError(ComNo, ERR_EXT_ALREADY_ATTACHED);
+		return GSV_ERROR;
+	}
+	g_Dev[ComNo] = ref;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extDetach(int ComNo)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	{
+		std::lock_guard<std::mutex> lk(g_DevLock);
+		if (g_Dev[ComNo] != dev)
+		{
+			extSetError(ComNo, ERR_EXT_NOT_ATTACHED);	/* detached by another thread meanwhile */
+			return GSV_ERROR;
+		}
+		g_Dev[ComNo].reset();
+	}
+	/* calls still holding a reference see the stages freed; dev itself is freed with the last reference */
+	extDevClose(dev.get());
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extPoll(int ComNo)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	return extPoll(dev.get());
+}
+
+int extPoll(ExtDevice* dev)
+{
+	const int ComNo = dev->ComNo;
+	int up = extReconService(dev);
+	if (up != GSV_TRUE)
+		return up;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	const int num = dev->NumObj;
+	ExtStats* st = dev->Stats.load(std::memory_order_relaxed);
+	if (st && !extStatsActive(st))
+		st = NULL;
+	if (st)
+		extStatsPollStart(st, extNowNs());
+	int total = 0;
+	for (;;)
+	{
+		uint64_t space = extCursorWritable(dev);
+		if (space == 0)
+			break;
+		int pull = space < EXT_PULL_FRAMES ? (int)space : EXT_PULL_FRAMES;
+		int valsread = 0;
+		uint64_t tcall = st ? extNowNs() : 0;
+		int ret = GSV86readMultiple(ComNo, 0, dev->PullBuf.data(), pull * num, &valsread, NULL);
+		uint64_t tret = st ? extNowNs() : 0;
+		if (st)
+			extStatsDll(st, tcall, tret);
+		if (ret == GSV_ERROR)
+		{
+			extSetDllError(ComNo);
+			if (dev->Recon && extReconLinkLost(dev))
+				break;
+			return GSV_ERROR;
+		}
+		int frames = valsread / num;
+		if (ret == GSV_OK || frames <= 0)
+			break;
+
+		/* copy into ring, at most two contiguous pieces */
+		uint64_t first = dev->FrameCount.load(std::memory_order_relaxed);
+		size_t pos = (size_t)(first & dev->RingMask);
+		size_t part = (size_t)dev->RingFrames - pos;
+		if (part > (size_t)frames)
+			part = (size_t)frames;
+		memcpy(&dev->Ring[pos * num], dev->PullBuf.data(), part * num * sizeof(double));
+		if (part < (size_t)frames)
+			memcpy(&dev->Ring[0], &dev->PullBuf[part * num], (frames - part) * num * sizeof(double));
+		uint64_t tins = extNowNs();
+		if (st)
+			extStatsInsert(dev, st, first, (uint64_t)frames, tret, tins);
+		dev->FrameCount.store(first + frames, std::memory_order_release);
+		extSnapPublish(dev, first + frames - 1, tins);
+		if (dev->Shm)
+			extShmUpdate(dev);
+
+		extTrigProcess(dev, first, (uint64_t)frames);
+		if (st)
+			extStatsStages(st, tins, extNowNs());
+
+		total += frames;
+		if (frames < pull)
+			break;
+	}
+	extCursorUpdate(dev);
+	return total;
+}
+
+int CALLTYP GSV86extGetFrameCount(int ComNo, unsigned long long* FrameCount)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	if (!FrameCount)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	*FrameCount = dev->FrameCount.load(std::memory_order_acquire);
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extGetLatest(int ComNo, double* out, unsigned long long* FrameNo)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	if (!out)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	/* sequence lock: retry while GSV86extPoll is publishing a newer frame */
+	const int num = dev->NumObj;
+	uint32_t seq;
+	uint64_t frame, time;
+	for (unsigned spin = 0; ; spin++)
+	{
+		seq = dev->SnapSeq.load(std::memory_order_acquire);
+		if (!(seq & 1))
+		{
+			for (int o = 0; o < num; o++)
+				out[o] = dev->SnapVal[o].load(std::memory_order_relaxed);
+			frame = dev->SnapFrame.load(std::memory_order_relaxed);
+			time = dev->SnapTime.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (dev->SnapSeq.load(std::memory_order_relaxed) == seq)
+				break;
+		}
+		if (spin >= EXT_SNAP_SPIN)
+			std::this_thread::yield();
+	}
+	if (frame == 0)
+		return GSV_OK;
+	ExtStats* st = dev->Stats.load(std::memory_order_acquire);
+	if (st && extStatsActive(st))
+		extStatsReadLatest(st, time);
+	if (FrameNo)
+		*FrameNo = frame - 1;
+	return GSV_TRUE;
+}
+
+int CALLTYP GSV86extGetLastError(int ComNo)
+{
+	if (!extComNoValid(ComNo))
+		return ERR_WRONG_COMNO;
+	return g_LastErr[ComNo].load(std::memory_order_relaxed);
+}
+
+static const char* extErrText(int Err)
+{
+	switch (Err)
+	{
+	case ERR_EXT_NOT_ATTACHED: return ERR_EXT_NOT_ATTACHED_TXT;
+	case ERR_EXT_ALREADY_ATTACHED: return ERR_EXT_ALREADY_ATTACHED_TXT;
+	case ERR_EXT_WRONG_HANDLE: return ERR_EXT_WRONG_HANDLE_TXT;
+	case ERR_EXT_NO_RESOURCE: return ERR_EXT_NO_RESOURCE_TXT;
+	case ERR_EXT_WRONG_STATE: return ERR_EXT_WRONG_STATE_TXT;
+	case ERR_EXT_OVERRUN: return ERR_EXT_OVERRUN_TXT;
+	case ERR_EXT_BANDWIDTH: return ERR_EXT_BANDWIDTH_TXT;
+	case ERR_EXT_DEVICE_CHANGED: return ERR_EXT_DEVICE_CHANGED_TXT;
+	case ERR_EXT_CANCELLED: return ERR_EXT_CANCELLED_TXT;
+	case ERR_EXT_FILE_OPEN: return ERR_EXT_FILE_OPEN_TXT;
+	case ERR_MEM_ALLOC: return ERR_MEM_ALLOC_TXT;
+	case ERR_WRONG_PARAMETER: return ERR_WRONG_PARAMETER_TXT;
+	case ERR_WRONG_COMNO: return ERR_WRONG_COMNO_TXT;
+	case ERR_UNKNOWN_VALUE: return ERR_UNKNOWN_VALUE_TXT;
+	case ERR_FILE_CONTENT: return ERR_FILE_CONTENT_TXT;
+	default: return "";
+	}
+}
+
+int CALLTYP GSV86extGetLastErrorText(int ComNo, char* ErrText)
+{
+	if (!extComNoValid(ComNo))
+	{
+		if (ErrText)
+			strcpy(ErrText, ERR_WRONG_COMNO_TXT);
+		return ERR_WRONG_COMNO;
+	}
+	const int err = g_LastErr[ComNo].load(std::memory_order_relaxed);
+	if (g_DllErr[ComNo].load(std::memory_order_relaxed))
+	{
+		char dummy[ERRTEXT_SIZE];
+		GSV86getLastErrorText(ComNo, ErrText ? ErrText : dummy);
+	}
+	else if (ErrText)
+	{
+		strncpy(ErrText, extErrText(err), ERRTEXT_SIZE - 1);
+		ErrText[ERRTEXT_SIZE - 1] = 0;
+	}
+	return err;
+}
@@ -0,0 +1,1933 @@
+/**********************************************************************************************
+C or C++ Header-file for the MEGSV86ext host extension library
+Host-side stream processing on top of MEGSV86w32.DLL (Windows 32-Bit) and MEGSV86x64.DLL (Windows 64-Bit)
+For using with GSV-8/BX8 or GSV-6/ITA measuring amplifiers with serial interface
+1. Data types, all little-endian style:
+	int : signed integer of 32 bits size
+	unsigned long : unsigned integer of 32 bits size
+	unsigned long long : unsigned integer of 64 bits size
+	double : IEEE754 floating-point value of 64 bits size
+
+2. Calling conventions: same as MEGSV86xx.DLL (w32: __stdcall x64: __fastcall)
+
+3. Usage: A device is activated with GSV86actExt / GSV86activateExtended as before.
+	Afterwards GSV86extAttach creates the host-side frame ring for that ComNo.
+	GSV86extPoll moves all measuring values from the DLL buffers into that ring
+	and runs the attached processing stages (e.g. trigger engines).
+	While attached, values must not be read with GSV86read / GSV86readMultiple
+	by the application itself, since they are consumed by GSV86extPoll.
+	Several consumers can read the same frames through named reader cursors (GSV86extCursor*).
+************************************************************************************************/
+#ifndef MEGSV86EXT_H
+#define MEGSV86EXT_H
+
+#ifdef _M_X64
+#include "MEGSV86x64.h"
+#else
+#include "MEGSV86w32.h"
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/************************************************************************************************
+Definitions of constants.
+*************************************************************************************************/
+/* Version of this library */
+#define EXTVER_H                       1
+#define EXTVER_L                       0
+
+/* Maximum ComNo accepted by GSV86ext* functions (exclusive) */
+#define EXT_COMNO_MAX	256
+
+/* Constants for GSV86extAttach */
+#define EXT_RING_FRAMES_DEF	65536	/* default capacity of the host frame ring, in frames */
+#define EXT_RING_FRAMES_MIN	1024	/* minimum capacity of the host frame ring, in frames */
+#define EXT_PULL_FRAMES	1024	/* maximum number of frames moved from the DLL per GSV86readMultiple call */
+
+/* Extension error codes. Retrieve with GSV86extGetLastError. */
+#define ERR_EXT_NOT_ATTACHED	0x30000400	/* ComNo is not attached with GSV86extAttach */
+#define ERR_EXT_NOT_ATTACHED_TXT "MEGSV86ext: ComNo not attached"
+#define ERR_EXT_ALREADY_ATTACHED	0x30000401	/* ComNo is already attached */
+#define ERR_EXT_ALREADY_ATTACHED_TXT "MEGSV86ext: ComNo already attached"
+#define ERR_EXT_WRONG_HANDLE	0x30000402	/* Handle parameter does not refer to an existing object */
+#define ERR_EXT_WRONG_HANDLE_TXT "MEGSV86ext: Handle parameter wrong"
+#define ERR_EXT_NO_RESOURCE	0x30000403	/* All slots of a fixed-size table are in use */
+#define ERR_EXT_NO_RESOURCE_TXT "MEGSV86ext: No free slot or handle left"
+#define ERR_EXT_WRONG_STATE	0x30000404	/* Object is in a state not suitable for the request */
+#define ERR_EXT_WRONG_STATE_TXT "MEGSV86ext: Object in improper state for this request"
+#define ERR_EXT_OVERRUN	0x30000405	/* Host ring overwritten before frames were processed */
+#define ERR_EXT_OVERRUN_TXT "MEGSV86ext: Host frame ring overrun"
+#define ERR_EXT_BANDWIDTH	0x30000406	/* Requested data rate exceeds the interface bandwidth */
+#define ERR_EXT_BANDWIDTH_TXT "MEGSV86ext: Data rate too high for interface bitrate, data type and number of objects"
+#define ERR_EXT_DEVICE_CHANGED	0x30000407	/* Other device or frame layout found after reconnecting */
+#define ERR_EXT_DEVICE_CHANGED_TXT "MEGSV86ext: Device changed after reconnect (serial number or value objects differ)"
+#define ERR_EXT_CANCELLED	0x30000408	/* Queued command removed before execution */
+#define ERR_EXT_CANCELLED_TXT "MEGSV86ext: Command cancelled before execution"
+#define ERR_EXT_FILE_OPEN	0x30000409	/* File could not be opened, read or written */
+#define ERR_EXT_FILE_OPEN_TXT "MEGSV86ext: File could not be opened, read or written"
+
+/* Constants for the trigger engine (GSV86extTrig*) */
+#define TRIG_NUM_MAX	8	/* Maximum number of trigger engines per ComNo */
+#define TRIG_COND_MAX	16	/* Maximum number of conditions per trigger engine */
+#define TRIG_GROUP_MAX	8	/* Maximum number of condition groups per trigger engine */
+/* Condition types for GSV86extTrigAddCondition */
+#define TRIG_COND_ABOVE	1	/* value > Thres1 */
+#define TRIG_COND_BELOW	2	/* value < Thres1 */
+#define TRIG_COND_RISING	3	/* value crosses Thres1 upwards, re-armed after falling below Thres1-Thres2 (hysteresis) */
+#define TRIG_COND_FALLING	4	/* value crosses Thres1 downwards, re-armed after rising above Thres1+Thres2 (hysteresis) */
+#define TRIG_COND_WIN_IN	5	/* Thres1 <= value <= Thres2 */
+#define TRIG_COND_WIN_OUT	6	/* value < Thres1 or value > Thres2 */
+#define TRIG_COND_SLOPE_UP	7	/* slope (value change per second) > Thres1 */
+#define TRIG_COND_SLOPE_DOWN	8	/* slope (value change per second) < -Thres1 */
+/* Flags for GSV86extTrigCreate */
+#define TRIG_FLAG_OVERWRITE_OLDEST	1	/* if all capture slots are full: overwrite oldest capture, otherwise drop new event */
+#define TRIG_FLAG_RETRIGGER	2	/* allow a new trigger while post-trigger frames are still being collected */
+#define TRIG_FLAG_SCALED	4	/* multiply captured values with ScaleFactors of GSV86getValObjectInfo */
+/* Index parameter of GSV86extTrigGetInfo */
+#define TRIG_INFO_CAPTURED	0	/* number of completed captures waiting to be fetched */
+#define TRIG_INFO_PENDING	1	/* number of captures still collecting post-trigger frames */
+#define TRIG_INFO_EVENTS	2	/* total number of trigger events detected */
+#define TRIG_INFO_DROPPED	3	/* number of events dropped or overwritten for lack of free slots */
+
+/* Constants for the resampling subscribers (GSV86extResamp*) */
+#define RESAMP_NUM_MAX	8	/* Maximum number of resampling subscribers per ComNo */
+#define RESAMP_UP_MAX	256	/* Maximum interpolation factor Up */
+#define RESAMP_DOWN_MAX	65536	/* Maximum decimation factor Down */
+#define RESAMP_TAPS_DEF	24	/* Default filter length, in periods of the lower cut-off (see GSV86extResampCreate) */
+#define RESAMP_TAPS_MAX	128	/* Maximum filter length: transition band already below 5% of the cut-off */
+/* Flags for GSV86extResampCreate */
+#define RESAMP_FLAG_SCALED	4	/* multiply output values with ScaleFactors of GSV86getValObjectInfo */
+/* Index parameter of GSV86extResampGetInfo */
+#define RESAMP_INFO_AVAILABLE	0	/* number of output frames that can be read now */
+#define RESAMP_INFO_LAG	1	/* number of input frames in the host ring not yet consumed by this subscriber */
+#define RESAMP_INFO_OVERRUNS	2	/* number of times the subscriber lagged behind the ring capacity and input frames were skipped */
+
+/* Constants for the named reader cursors (GSV86extCursor*) */
+#define CURSOR_NUM_MAX	16	/* Maximum number of reader cursors per ComNo */
+#define CURSOR_NAME_SIZE	32	/* Maximum size of cursor name incl. termination */
+/* Flags for GSV86extCursorCreate */
+#define CURSOR_FLAG_NONBLOCKING	1	/* cursor does not hold back GSV86extPoll; frames are skipped if it lags behind the ring capacity */
+/* Index parameter of GSV86extCursorGetInfo */
+#define CURSOR_INFO_LAG	0	/* number of frames in the ring not yet read by this cursor */
+#define CURSOR_INFO_LAG_MAX	1	/* maximum lag seen after GSV86extPoll since creation */
+#define CURSOR_INFO_OVERRUNS	2	/* non-blocking cursors: number of frames skipped */
+#define CURSOR_INFO_STALLS	3	/* blocking cursors: number of GSV86extPoll calls held back because this cursor was the slowest */
+#define CURSOR_INFO_FRAMES_READ	4	/* number of frames read, modulo 2^31 */
+/* Layout parameter of GSV86extCursorReadLayout */
+#define CURSOR_LAYOUT_INTERLEAVED	0	/* Obj1,Obj2..ObjN of oldest frame first, as GSV86readMultiple with Chan=0 */
+#define CURSOR_LAYOUT_PLANAR	1	/* one array per object: value i of object o at index (o-1)*Stride+i */
+
+/* Constants for shared memory publication (GSV86extShm*) */
+#define SHM_NAME_SIZE	64	/* Maximum size of segment name incl. termination */
+#define SHM_NAME_DEF	"GSV86ext_COM%d"	/* Default segment name, %d is replaced by ComNo */
+#define SHM_READER_MAX	16	/* Maximum number of segments opened with GSV86extShmOpen per process */
+#define SHM_MAGIC	0x38565347	/* "GSV8" */
+#define SHM_LAYOUT_VER	1	/* Layout version of SHM_HEADER */
+#define SHM_STATE_LIVE	1	/* Publisher is active */
+#define SHM_STATE_CLOSED	2	/* Publisher has stopped, no more frames will be written */
+#define SHM_POS_NEWEST	0xFFFFFFFFFFFFFFFFULL	/* *Pos value for GSV86extShmRead: start at newest frame */
+
+/* 	Header at the base of a shared memory segment, followed by the frame ring at DataOffset.
+	Ring layout equals GSV86readMultiple with Chan=0: frame n is at index (n mod RingFrames)*NumObj.
+	Seq is a sequence lock for the fields NumObj..RingFrames: it is odd while the publisher
+	changes them; readers copy these fields and retry if Seq was odd or has changed meanwhile.
+	FrameCount is written after the frame data. A frame n read by another process is valid only if,
+	after copying, n >= FrameCount + EXT_PULL_FRAMES - RingFrames.
+	Must be used with C or C++ only, both processes compiled for the same platform. */
+typedef struct
+{
+	unsigned long Magic;		/* SHM_MAGIC */
+	unsigned long LayoutVer;	/* SHM_LAYOUT_VER */
+	volatile unsigned long State;	/* SHM_STATE_* */
+	volatile unsigned long Seq;	/* sequence lock counter */
+	int NumObj;			/* NumberOfMappedObjects */
+	int DataType;			/* DATATYP_* */
+	double Frequency;		/* data rate, frames per second */
+	double ScaleFactors[VALOBJ_NUM_MAX];	/* see GSV86getValObjectInfo */
+	unsigned long ObjMapping[VALOBJ_NUM_MAX];	/* see GSV86getValObjectInfo */
+	unsigned long long RingFrames;	/* capacity of the ring in frames, power of two */
+	unsigned long long DataOffset;	/* byte offset of the ring from the segment base */
+	volatile unsigned long long FrameCount;	/* total frames written, =index of next frame */
+} SHM_HEADER;
+
+/* Constants for the link bandwidth planner (GSV86extPlan*) */
+#define PLAN_UART_BITS_PER_BYTE	10	/* start bit, 8 data bits, stop bit */
+#define PLAN_FRAME_OVERHEAD	4	/* bytes of a measuring value frame besides the values: prefix, 2 header bytes, suffix */
+#define PLAN_LOAD_MAX	0.9	/* max. share of the bitrate used by measuring values; the rest is left for command traffic */
+#define PLAN_USB_BITRATE	12000000	/* USB full speed: link capacity of USB-CDC devices for GSV86extCmdGetLoad */
+
+/* Constants for GSV86extActivateFast */
+#define BAUD_MAX	921600	/* highest bitrate allowed by GSV86activateExtended */
+#define BAUD_LIST_SIZE	256	/* array size for GSV86readAllInterfSettings */
+#define BAUD_PROBE_MS	300	/* duration of the throughput probe after switching */
+#define BAUD_PROBE_RATIO	0.8	/* min. share of the expected frames received during the probe */
+
+/* Constants for automatic reconnection (GSV86extReconnect*) */
+#define RECON_RETRY_MS	500	/* minimum time between two re-activation attempts */
+#define RECON_GAP_MAX	64	/* number of gaps recorded, older ones are dropped */
+/* Flags for GSV86extReconnectEnable */
+#define RECON_FLAG_GAP_NAN	1	/* write one frame of NaN values into the ring at each gap */
+/* Index parameter of GSV86extReconnectGetInfo */
+#define RECON_INFO_STATE	0	/* =0: connected, =1: link lost, reconnecting */
+#define RECON_INFO_RECONNECTS	1	/* number of successful reconnects */
+#define RECON_INFO_ATTEMPTS	2	/* number of failed re-activation attempts */
+#define RECON_INFO_GAPS	3	/* number of gaps recorded since enabling, modulo 2^31 */
+
+/* Constants for the low-latency poll thread (GSV86extLowLat*) */
+#define LOWLAT_PERIOD_MIN_US	100	/* minimum poll period if not busy-polling */
+/* Priority parameter of GSV86extLowLatStart */
+#define LOWLAT_PRIO_NORMAL	0	/* priority not changed */
+#define LOWLAT_PRIO_HIGH	1	/* Windows: THREAD_PRIORITY_HIGHEST, POSIX: SCHED_FIFO, lowest priority */
+#define LOWLAT_PRIO_REALTIME	2	/* Windows: THREAD_PRIORITY_TIME_CRITICAL, POSIX: SCHED_FIFO, highest priority */
+/* Flags for GSV86extLowLatStart */
+#define LOWLAT_FLAG_BUSY	1	/* poll continuously instead of sleeping for PeriodUs; occupies one CPU core */
+/* Index parameter of GSV86extLowLatGetInfo */
+#define LOWLAT_INFO_LOOPS	0	/* number of GSV86extPoll calls, modulo 2^31 */
+#define LOWLAT_INFO_ERRORS	1	/* number of failed GSV86extPoll calls */
+#define LOWLAT_INFO_LATE	2	/* number of loops started later than one period after the scheduled time */
+#define LOWLAT_INFO_POLL_MAX_US	3	/* longest GSV86extPoll call, in microseconds */
+#define LOWLAT_INFO_PRIO_SET	4	/* =1: priority and affinity were set as requested, =0: refused by OS */
+
+/* Constants for latency statistics (GSV86extStats*) */
+/* Hist parameter of GSV86extStatsGet and GSV86extStatsGetHistogram */
+#define STATS_HIST_POLL_GAP	0	/* time between the starts of two GSV86extPoll calls: scheduling of the polling thread */
+#define STATS_HIST_DLL	1	/* duration of GSV86readMultiple: hand-off from the DLL receive buffer */
+#define STATS_HIST_INSERT	2	/* GSV86readMultiple returned until the frames are visible in the host ring */
+#define STATS_HIST_STAGES	3	/* processing of the attached stages (trigger, shared memory) per batch */
+#define STATS_HIST_READ	4	/* frame visible in the host ring until read by a cursor or GSV86extGetLatest, per frame */
+#define STATS_HIST_NUM	5
+#define STATS_SUB_BITS	5	/* histogram resolution: 2^STATS_SUB_BITS buckets per power of two, about 3% */
+#define STATS_BUCKETS	(2 * (1 << STATS_SUB_BITS) + 36 * (1 << STATS_SUB_BITS))	/* covers 0 ns .. 2^42 ns (73 min) */
+
+/* Summary of one latency histogram, values in microseconds.
+   Percentiles are upper bounds of histogram buckets. */
+typedef struct
+{
+	unsigned long long Count;	/* number of samples */
+	double Min;
+	double Mean;
+	double Max;
+	double P50;
+	double P90;
+	double P99;
+	double P999;
+} STATS_LATENCY;
+
+/* Constants for command accounting (GSV86extCmd*) */
+#define CMD_NUM	256	/* CmdNo range 0..CMD_NUM-1, see "Device access" of the MEGSV86xx.DLL functions */
+#define CMD_RETRY_MAX	8	/* Maximum number of retries after ERR_NO_GSV_ANSWER */
+
+/* Function executing one or more MEGSV86xx.DLL calls for GSV86extCmdCall.
+   Returns the result of the DLL call; GSV_ERROR counts as failed. Further results via Ctx. */
+typedef int (CALLTYP *EXT_CMD_FUNC)(int ComNo, void* Ctx);
+
+/* Accounting of one CmdNo, see GSV86extCmdGet */
+typedef struct
+{
+	unsigned long long Calls;	/* completed calls, retries not counted */
+	unsigned long long Errors;	/* calls returning GSV_ERROR after all retries */
+	unsigned long long Timeouts;	/* attempts failed with ERR_NO_GSV_ANSWER */
+	unsigned long long Retries;	/* attempts repeated after ERR_NO_GSV_ANSWER */
+	unsigned long long TxBytes;	/* estimated bytes sent incl. frame overhead and retries */
+	unsigned long long RxBytes;	/* estimated bytes received incl. frame overhead */
+	STATS_LATENCY Rtt;		/* round-trip time per attempt, microseconds */
+} CMD_STATS;
+
+/* Constants for the asynchronous command queue (GSV86extAsync*) */
+#define ASYNC_QUEUE_MAX	1024	/* Maximum number of commands submitted and not yet collected, per ComNo */
+#define ASYNC_WAIT_INFINITE	0xFFFFFFFF	/* TimeoutMs of GSV86extAsyncWait: wait until completed */
+/* Priorities of GSV86extAsyncSetPriority. Default: HIGH for CmdNo 0x0C, 0x3B, 0x3C (GSV86setZero,
+   GSV86triggerValue, GSV86clearMaxMinValue), LOW for FT sensor calibration (0x47, 0x48, 0x7F)
+   and TEDS (0x64..0x67), NORMAL for all others */
+#define ASYNC_PRIO_LOW	0
+#define ASYNC_PRIO_NORMAL	1
+#define ASYNC_PRIO_HIGH	2
+#define ASYNC_PRIO_NUM	3
+/* Return value of an EXT_CMD_FUNC executed by the queue: one step of a longer transfer is done,
+   call again. Commands of higher priority submitted meanwhile are executed first. */
+#define ASYNC_CONTINUE	(-2)
+
+/* Completion function of GSV86extAsyncSubmit, called in the queue thread (or in GSV86extAsyncCancel
+   and GSV86extAsyncClose for cancelled commands). Result: return value of the command,
+   ErrCode: GSV86getLastProtocollError after GSV_ERROR, ERR_EXT_CANCELLED or 0.
+   Must not call GSV86extAsyncClose. */
+typedef void (CALLTYP *EXT_ASYNC_DONE)(int ComNo, int Handle, int Result, int ErrCode, void* User);
+
+/* Constants for the capability cache (GSV86extCaps*) */
+#define CAPS_BITMAP_WORDS	(CMD_NUM / 32)	/* size of the bitmap of GSV86extCapsGetBitmap */
+/* Flags for GSV86extCapsProbe */
+#define CAPS_FLAG_REFRESH	1	/* probe the device even if its serial number and firmware version are cached */
+
+/* Constants for the TEDS decoder (GSV86extTeds*) */
+#define TEDS_CHAN_MAX	8	/* input channels 1..TEDS_CHAN_MAX */
+#define TEDS_RAW_CHUNK	32	/* bytes per GSV86readTEDSrawData request */
+#define TEDS_RAW_MAX	128	/* TEDS memory read at most: 1-wire EEPROM of 1024 bits */
+#define TEDS_CACHE_MAX	64	/* sensors cached, least recently used ones are dropped */
+#define TEDS_PROPS_MAX	64	/* properties per template */
+#define TEDS_NAME_SIZE	32
+#define TEDS_TEXT_SIZE	16
+/* Flags for GSV86extTedsRead */
+#define TEDS_FLAG_VERIFY_ID	1	/* read the Basic TEDS even if the channel wasn't unplugged since the last read */
+#define TEDS_FLAG_REFRESH	2	/* read and decode the whole TEDS memory even if the sensor is cached */
+/* Property IDs of the Basic TEDS (TemplID 0), 64 bits at the start of the TEDS memory */
+#define TEDS_PROP_MANUFACTURER	1	/* 14 bits */
+#define TEDS_PROP_MODEL	2	/* 15 bits */
+#define TEDS_PROP_VERSION_LETTER	3	/* 5 bits, Chr5 */
+#define TEDS_PROP_VERSION_NUMBER	4	/* 6 bits */
+#define TEDS_PROP_SERIAL	5	/* 24 bits */
+/* Bridge sensor template (IEEE1451.4 template 33), built in. Property IDs in the order stored: */
+#define TEDS_TEMPL_BRIDGE	33
+#define TEDS_BRIDGE_MEASURAND	1	/* 6 bits, Enum: physical measurand */
+#define TEDS_BRIDGE_MIN_PHYS	2	/* Single, in the unit of the measurand */
+#define TEDS_BRIDGE_MAX_PHYS	3	/* Single */
+#define TEDS_BRIDGE_MIN_ELEC	4	/* Single, V/V */
+#define TEDS_BRIDGE_MAX_ELEC	5	/* Single, V/V */
+#define TEDS_BRIDGE_TYPE	6	/* 2 bits, Enum: 0=quarter, 1=half, 2=full bridge */
+#define TEDS_BRIDGE_IMPEDANCE	7	/* 18 bits, ConRelRes, Ohm */
+#define TEDS_BRIDGE_RESP_TIME	8	/* 6 bits, ConRelRes, s */
+#define TEDS_BRIDGE_EXC_NOM	9	/* 9 bits, ConRes, V */
+#define TEDS_BRIDGE_EXC_MIN	10	/* 6 bits, ConRes, V */
+#define TEDS_BRIDGE_EXC_MAX	11	/* 9 bits, ConRes, V */
+#define TEDS_BRIDGE_CAL_DATE	12	/* 16 bits, Date */
+#define TEDS_BRIDGE_CAL_INITIALS	13	/* 15 bits, Chr5 */
+#define TEDS_BRIDGE_CAL_PERIOD	14	/* 12 bits, days */
+#define TEDS_BRIDGE_LOCATION	15	/* 11 bits, measurement location ID */
+/* Type of TEDS_PROP_DEF, data types of IEEE1451.4 */
+#define TEDS_TYPE_UNINT	0	/* unsigned integer */
+#define TEDS_TYPE_ENUM	1	/* unsigned integer, meaning of values defined by the template */
+#define TEDS_TYPE_CONRES	2	/* Start + n * Step */
+#define TEDS_TYPE_CONRELRES	3	/* Start * (1 + 2 * Step)^n, Step is the relative tolerance */
+#define TEDS_TYPE_SINGLE	4	/* IEEE754 float, Bits must be 32 */
+#define TEDS_TYPE_CHR5	5	/* characters of 5 bits: 0=space, 1..26='A'..'Z' */
+#define TEDS_TYPE_DATE	6	/* days since 1.1.1998 */
+#define TEDS_TYPE_CONST	7	/* not stored (Bits=0), value Start */
+
+/* One property of a TEDS template, see GSV86extTedsDefineTemplate. Properties are stored
+   LSB first, one after the other in the order of definition. */
+typedef struct
+{
+	int PropID;
+	int Bits;		/* stored size, 0..32 */
+	int Type;		/* TEDS_TYPE_* */
+	double Start;		/* see TEDS_TYPE_* */
+	double Step;
+	int CondPropID;		/* =0: always present, else: present only if CondPropID of the same template ... */
+	unsigned long CondValue;	/* ... was decoded with this (unsigned) value (SelectCase of the template) */
+	char Name[TEDS_NAME_SIZE];
+	char Unit[TEDS_NAME_SIZE];
+} TEDS_PROP_DEF;
+
+/* One decoded TEDS property, see GSV86extTedsGetEntries. Value as GSV86readTEDSentry */
+typedef struct
+{
+	int TemplID;		/* 0: Basic TEDS */
+	int PropID;
+	int Flags;		/* TEDS_ANSW_IS_FLT, TEDS_IS_PACKED_CHR5, TEDS_IS_DATE_DAYS or TEDS_ENTRY_NOT_SET, TEDS_ENTRY_INVALID */
+	unsigned long Udata;	/* raw value, if not TEDS_ANSW_IS_FLT */
+	double DblData;		/* value, if TEDS_ANSW_IS_FLT */
+	char Text[TEDS_TEXT_SIZE];	/* TEDS_IS_PACKED_CHR5: decoded characters */
+} TEDS_ENTRY;
+
+/* Constants for the sensor scan (GSV86extScan*) */
+#define SCAN_THREADS_MAX	16	/* Maximum number of devices scanned at the same time */
+#define SCAN_PERIOD_MIN_MS	100	/* Minimum period of GSV86extScanStart */
+/* Flags for GSV86extScan and GSV86extScanStart */
+#define SCAN_FLAG_VERIFY_ID	1	/* read the Basic TEDS of all channels with TEDS, see TEDS_FLAG_VERIFY_ID */
+#define SCAN_FLAG_NO_ACTIVE	2	/* don't query GSV86getTEDSactive, TedsActive is 0 */
+/* SCAN_INFO.Changed besides the channel bits */
+#define SCAN_CHANGED_RESULT	0x100	/* Result differs from the previous scan, e.g. the device vanished */
+
+/* Result of GSV86extScan for one ComNo. Masks: Bit<7:0> correspond to input channel 8..1 */
+typedef struct
+{
+	int ComNo;
+	int Result;		/* GSV_OK: scanned, GSV_ERROR: device failed, see ErrCode */
+	int ErrCode;		/* GSV86extGetLastError after GSV_ERROR, otherwise 0 */
+	int Bridge;		/* bridge sensor connected, see GSV86getSensorPlugged */
+	int TedsPresent;	/* 1-wire EEPROM connected */
+	int TedsWritable;	/* input channel capable of writing TEDS */
+	int TedsActive;		/* TEDS used for scaling, see GSV86getTEDSactive */
+	int TedsError;		/* TEDS present, but could not be read (SensorId is 0) */
+	int Changed;		/* Bridge, TedsPresent or SensorId differ from the previous scan of this ComNo,
+				   plus SCAN_CHANGED_RESULT. A failed scan after a successful one reports all
+				   channels of the previous scan as changed. */
+	unsigned long ScanNo;	/* number of scans of this ComNo, starting with 1 */
+	unsigned long long SensorId[TEDS_CHAN_MAX];	/* Basic TEDS of input channel 1..8, 0: no TEDS */
+} SCAN_INFO;
+
+/* Callback of the background scan (GSV86extScanStart), called from the scan thread for each ComNo
+   with Changed != 0. Must not call GSV86extScanStop. */
+typedef void (CALLTYP *EXT_SCAN_CHANGED)(const SCAN_INFO* Info, void* User);
+
+/* Constants for port discovery (GSV86extDiscover*) */
+#define DISC_COMNO_FIRST	1	/* ComNos probed if no list is given: DISC_COMNO_FIRST..DISC_COMNO_LAST */
+#define DISC_COMNO_LAST	64
+#define DISC_THREADS_MAX	16	/* Maximum number of ports probed at the same time */
+/* Flags for GSV86extDiscover */
+#define DISC_FLAG_USE_CACHE	1	/* ports already probed are not probed again, the cached result is returned */
+#define DISC_FLAG_KEEP_OPEN	2	/* ports with a device found are left activated, otherwise released */
+/* DISC_INFO.Found besides GSV_TRUE (device answered) and GSV_OK (port opened, no device answered) */
+#define DISC_BUSY	2	/* port is already open (ERR_COM_ALREADY_OPEN), not cached */
+#define DISC_FAILED	3	/* port could not be probed (e.g. not present, driver error), not cached */
+
+/* Result of GSV86extDiscover for one ComNo */
+typedef struct
+{
+	int ComNo;
+	int Found;		/* GSV_TRUE: device answered, GSV_OK: no device, DISC_BUSY, DISC_FAILED (other fields 0) */
+	int Error;		/* error code of the failed probe (see GSV86getLastProtocollError), 0 if a device answered */
+	int SerialNo;		/* see GSV86getSerialNo */
+	int DeviceModel;	/* GSV6 or GSV8, see GSV86getInterfaceIdentity */
+	int Firmware;		/* see GSV86firmwareVersion */
+	int NumOfIntfDescr;	/* see GSV86getInterfaceIdentity */
+	int ThisInterfNo;
+	int Protocol;
+	int DataType;		/* DATATYP_* */
+	int NumObj;		/* number of objects in measuring value frame */
+	unsigned long Bitrate;	/* bitrate the device answered at */
+} DISC_INFO;
+
+/* Constants for the network streaming server (GSV86extNet*) */
+#define NET_PORT_DEF	48086	/* Default TCP port */
+#define NET_CLIENT_MAX	8	/* Maximum number of clients per ComNo */
+#define NET_MAGIC_SUB	0x4E565347	/* "GSVN": NET_SUBSCRIBE and NET_STREAM_INFO */
+#define NET_MAGIC_DATA	0x44565347	/* "GSVD": NET_PACKET_HEADER */
+#define NET_PROT_VER	1	/* Protocol version */
+#define NET_TRANSPORT_TCP	0	/* data packets on the TCP connection */
+#define NET_TRANSPORT_UDP	1	/* data packets as UDP datagrams to the client address, port UdpPort */
+#define NET_FORMAT_DOUBLE	0	/* values as IEEE754 64-Bit */
+#define NET_FORMAT_FLOAT	1	/* values as IEEE754 32-Bit */
+#define NET_UDP_PAYLOAD_MAX	1472	/* maximum datagram size (Ethernet MTU without IP/UDP headers) */
+#define NET_FLUSH_MS	20	/* partially filled packets are sent after this time */
+/* Flags for GSV86extNetStart */
+#define NET_FLAG_LOCALHOST	1	/* bind to 127.0.0.1 only (default, overrides NET_FLAG_ALL_INTERFACES) */
+#define NET_FLAG_ALL_INTERFACES	2	/* bind to all interfaces: the stream is reachable from the network */
+/* Index parameter of GSV86extNetGetInfo */
+#define NET_INFO_CLIENTS	0	/* number of connected clients */
+#define NET_INFO_PACKETS	1	/* number of data packets sent, modulo 2^31 */
+#define NET_INFO_KBYTES	2	/* kBytes of data packets sent, modulo 2^31 */
+#define NET_INFO_PORT	3	/* TCP port listening on */
+
+/* 	Network protocol. All fields little-endian, structs packed.
+	1. Client connects via TCP and sends NET_SUBSCRIBE (may be sent again later to change it).
+	2. Server answers with NET_STREAM_INFO on the TCP connection.
+	3. Server sends data packets: NET_PACKET_HEADER followed by NumFrames*NumObj values in Format,
+	   sorted Obj1..ObjN of oldest frame first. With UDP, one packet per datagram.
+	Frame numbers count device frames (see GSV86extGetFrameCount), so gaps and decimation are visible. */
+#pragma pack(push, 1)
+typedef struct
+{
+	unsigned int Magic;		/* NET_MAGIC_SUB */
+	unsigned short Version;		/* NET_PROT_VER */
+	unsigned char Format;		/* NET_FORMAT_* */
+	unsigned char Transport;	/* NET_TRANSPORT_* */
+	unsigned int ObjMask;		/* Bit n set: object n+1 is sent. =0: all objects */
+	unsigned int Decimation;	/* send every Decimation-th frame. =0 or 1: every frame */
+	unsigned short FramesPerPacket;	/* frames batched into one packet. =0: as many as fit into NET_UDP_PAYLOAD_MAX */
+	unsigned short UdpPort;		/* NET_TRANSPORT_UDP: client port receiving the datagrams */
+} NET_SUBSCRIBE;
+
+typedef struct
+{
+	unsigned int Magic;		/* NET_MAGIC_SUB */
+	unsigned short Version;		/* NET_PROT_VER */
+	unsigned char Format;		/* NET_FORMAT_* as subscribed */
+	unsigned char Transport;	/* NET_TRANSPORT_* as subscribed */
+	unsigned char NumObjDevice;	/* NumberOfMappedObjects of the device */
+	unsigned char NumObj;		/* number of objects sent */
+	unsigned char DataType;		/* DATATYP_* */
+	unsigned char reserved;
+	unsigned int ObjMask;		/* objects sent, never 0 */
+	unsigned int Decimation;	/* as used, >=1 */
+	unsigned short FramesPerPacket;	/* as used */
+	unsigned short reserved2;
+	double Frequency;		/* device data rate; stream rate is Frequency/Decimation */
+	double ScaleFactors[VALOBJ_NUM_MAX];	/* of the objects sent, in sent order */
+	unsigned int ObjMapping[VALOBJ_NUM_MAX];	/* of the objects sent, in sent order */
+} NET_STREAM_INFO;
+
+typedef struct
+{
+	unsigned int Magic;		/* NET_MAGIC_DATA */
+	unsigned int Seq;		/* packet sequence number per client, starting with 0 */
+	unsigned long long FirstFrame;	/* frame number of the first frame; following frames are FirstFrame+i*Decimation, unless a gap occurred (new packet) */
+	unsigned short NumFrames;	/* frames in this packet */
+	unsigned char NumObj;		/* values per frame */
+	unsigned char Format;		/* NET_FORMAT_* */
+} NET_PACKET_HEADER;
+#pragma pack(pop)
+
+///////////////////////////////////////////////////////////////////////////////////
+//// Exported functions Prototypes
+//--------------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////////
+
+/**
+	@brief Get library version Number
+--------------------------------------------------------------------------------------
+ @return Version Number High in Bits<31:16>, Version number Low in Bits<15:0>
+*
+ Device access: No
+ ********************************************************************************** */
+unsigned long CALLTYP GSV86extVersion(void);
+
+/*!  ****************************************************************************
+@brief	Attach host-side stream processing to an activated device
+--------------------------------------------------------------------------------------
+	Reads the value object info (GSV86getValObjectInfo) and the data rate (GSV86getFrequency)
+	and allocates the host frame ring. Must be called after GSV86actExt / GSV86activateExtended
+	and again (after GSV86extDetach) if the object mapping or data type was changed.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	RingFrames: Capacity of the host frame ring in frames (one frame = one value of every mapped object).
+ 		=0: EXT_RING_FRAMES_DEF. Rounded up to the next power of two, minimum EXT_RING_FRAMES_MIN.
+ @param[in]	flags: reserved, set to 0
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: Yes, CmdNo: 0x26, 0x80, 0x8A
+ ********************************************************************************** */
+int CALLTYP GSV86extAttach(int ComNo, unsigned long RingFrames, unsigned long flags);
+
+/*!  ****************************************************************************
+@brief	Detach host-side stream processing and free all associated ressources
+--------------------------------------------------------------------------------------
+	Must be called before GSV86release of the same ComNo.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if ComNo was not attached.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extDetach(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Move measuring values from the DLL buffers into the host frame ring
+--------------------------------------------------------------------------------------
+	Reads all complete frames available in the DLL (GSV86readMultiple with Chan=0),
+	appends them to the host frame ring and runs all attached processing stages on them.
+	Must be called periodically, often enough that the DLL buffer (BufSize of
+	GSV86activateExtended) does not overflow.<br>
+	Frames not yet read by the slowest blocking reader cursor are never overwritten; if the ring
+	is full for that cursor, the remaining frames are left in the DLL buffer.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @return Number of frames moved (>=0) or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+ \note: With GSV86extReconnectEnable, a lost link is not an error: 0 is returned until the
+ 	device is re-activated.
+*
+ Device access: No (Yes while reconnecting, see GSV86extReconnectEnable)
+ ********************************************************************************** */
+int CALLTYP GSV86extPoll(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Get number of frames written into the host frame ring since GSV86extAttach
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[out] *FrameCount: Pointer to 64-bit value, where the total frame count is written to
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if ComNo was not attached.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extGetFrameCount(int ComNo, unsigned long long* FrameCount);
+
+/*!  ****************************************************************************
+@brief	Get Last Error Code of a GSV86ext* function
+--------------------------------------------------------------------------------------
+	Can be called after a GSV86ext* function returned GSV_ERROR.
+
+ @param[in] ComNo: 	Number of Device Comport
+ @return One of the ERR_EXT_* codes defined above, or, if the error was raised by a
+ 	function of MEGSV86xx.DLL, the code retrieved with GSV86getLastProtocollError().
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extGetLastError(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Get Last Error Code and error describing text of a GSV86ext* function
+--------------------------------------------------------------------------------------
+ @param[in] ComNo: 	Number of Device Comport
+ @param[out] ErrText: pointer to ASCII coded 8-Bit char array of size ERRTEXT_SIZE, where error text is written to.
+ @return Error code, see GSV86extGetLastError
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extGetLastErrorText(int ComNo, char* ErrText);
+
+/*!  ****************************************************************************
+@brief	Create a host-side trigger engine with pre-/post-trigger capture
+--------------------------------------------------------------------------------------
+	The engine evaluates its conditions on every frame moved by GSV86extPoll.
+	On a trigger event, PreFrames frames before and PostFrames frames from the trigger
+	frame on are copied from the host frame ring into one of NumSlots capture slots,
+	which are allocated here once. Acquisition is never stopped.<br>
+	The engine is created disarmed; add conditions and arm it with GSV86extTrigArm.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	PreFrames: Number of frames before the trigger frame. PreFrames+PostFrames+EXT_PULL_FRAMES
+ 		must not exceed the capacity of the host frame ring.
+ @param[in]	PostFrames: Number of frames beginning with the trigger frame. Must be >=1.
+ @param[in]	NumSlots: Number of capture slots (>=1)
+ @param[in]	flags: TRIG_FLAG_* constants, can be ORed together
+ @return Trigger handle (1..TRIG_NUM_MAX) or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTrigCreate(int ComNo, int PreFrames, int PostFrames, int NumSlots, unsigned long flags);
+
+/*!  ****************************************************************************
+@brief	Add a condition to a trigger engine
+--------------------------------------------------------------------------------------
+	Conditions with the same Group number are ANDed, the groups are ORed together
+	(i.e. the trigger expression is a sum of products). A trigger event occurs on the frame
+	where the expression changes from false to true.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Trig: Trigger handle returned by GSV86extTrigCreate
+ @param[in]	Type: Condition type, one of TRIG_COND_*
+ @param[in]	Obj: Value object the condition is evaluated on. Range: 1..NumMappedObjects
+ @param[in]	Group: Condition group. Range: 0..TRIG_GROUP_MAX-1
+ @param[in]	Thres1: First threshold, see TRIG_COND_* definition
+ @param[in]	Thres2: Second threshold or hysteresis, see TRIG_COND_* definition
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+ \note: Thresholds are compared with scaled values if TRIG_FLAG_SCALED was given, otherwise with
+ 	values as read by GSV86readMultiple.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTrigAddCondition(int ComNo, int Trig, int Type, int Obj, int Group, double Thres1, double Thres2);
+
+/*!  ****************************************************************************
+@brief	Arm or disarm a trigger engine
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Trig: Trigger handle returned by GSV86extTrigCreate
+ @param[in]	OnOff: =1: arm, =0: disarm (captures in progress are discarded)
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTrigArm(int ComNo, int Trig, int OnOff);
+
+/*!  ****************************************************************************
+@brief	Get trigger engine state information
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Trig: Trigger handle returned by GSV86extTrigCreate
+ @param[in]	Index: One of TRIG_INFO_*
+ @return Requested value or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTrigGetInfo(int ComNo, int Trig, int Index);
+
+/*!  ****************************************************************************
+@brief	Fetch the oldest completed capture of a trigger engine
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Trig: Trigger handle returned by GSV86extTrigCreate
+ @param[out] *out: Pointer to array of double, where the capture is written to, sorted like
+ 		GSV86readMultiple with Chan=0: Obj1,Obj2..ObjN of oldest frame first.
+ @param[in]	count: Size of out array. Must be >= (PreFrames+PostFrames)*NumMappedObjects
+ @param[out] *TrigFrame: Pointer to 64-bit value, where the frame number (see GSV86extGetFrameCount)
+ 		of the trigger frame is written to. May be NULL.
+ @return Number of values written to out, GSV_OK (=0) if no capture is ready, or GSV_ERROR if function failed.
+ \note: The trigger frame is at index PreFrames*NumMappedObjects of out.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTrigGetCapture(int ComNo, int Trig, double* out, int count, unsigned long long* TrigFrame);
+
+/*!  ****************************************************************************
+@brief	Delete a trigger engine and free its capture slots
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Trig: Trigger handle returned by GSV86extTrigCreate
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTrigDelete(int ComNo, int Trig);
+
+/*!  ****************************************************************************
+@brief	Create a resampling subscriber with its own read cursor
+--------------------------------------------------------------------------------------
+	The subscriber delivers all value objects at a rate of Frequency*Up/Down, where Frequency is the
+	device data rate at GSV86extAttach. Resampling is done with a polyphase FIR filter
+	(Kaiser-windowed sinc, cut-off at the lower of both Nyquist frequencies), which is designed
+	here once. The filter has Taps*max(Up,Down) coefficients, i.e. Taps*max(Up,Down)/Up per output
+	value; its stop band attenuation from 1.5 times the cut-off upwards is checked to be at least 60dB,
+	so that input frequencies up to half the output Nyquist frequency are free of aliasing.
+	Values are computed from the host frame ring on GSV86extResampRead, so every subscriber reads
+	independently of the others and of GSV86extPoll.<br>
+	Example for 48kHz data rate: Up=1,Down=48 gives 1kHz (1152 taps per output value with Taps=24);
+	Up=1,Down=960 gives 50Hz (23040 taps, the host ring must hold them, see GSV86extAttach).
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Up: Interpolation factor. Range: 1..RESAMP_UP_MAX
+ @param[in]	Down: Decimation factor. Range: 1..RESAMP_DOWN_MAX
+ @param[in]	Taps: Filter length in periods of the lower cut-off. =0: RESAMP_TAPS_DEF. Range: 1..RESAMP_TAPS_MAX,
+ 	values below about 12 fail the stop band check (ERR_WRONG_PARAMETER)
+ @param[in]	flags: RESAMP_FLAG_* constants, can be ORed together
+ @return Subscriber handle (1..RESAMP_NUM_MAX) or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+ \note: The read cursor starts at the newest frame in the host ring at creation time.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extResampCreate(int ComNo, int Up, int Down, int Taps, unsigned long flags);
+
+/*!  ****************************************************************************
+@brief	Read resampled values of a subscriber
+--------------------------------------------------------------------------------------
+	Same behaviour as GSV86readMultiple with Chan=0, but for the output of the subscriber.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Sub: Subscriber handle returned by GSV86extResampCreate
+ @param[out] *out: Pointer to array of double, where values are written to: Obj1,Obj2..ObjN of oldest frame first.
+ @param[in]	count: Maximum number of values to read. Must be dividible by NumMappedObjects.
+ @param[out] *valsread: Pointer to int value, where the actual number of values written into *out is stored.
+ @return Simple errorcode: GSV_OK, if no values were read, GSV_TRUE if value(s) were read, or GSV_ERROR if function failed.
+ \note: If the subscriber lagged behind by more than the ring capacity, the cursor is moved
+ 	to the oldest frame still in the ring and RESAMP_INFO_OVERRUNS is incremented.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extResampRead(int ComNo, int Sub, double* out, int count, int* valsread);
+
+/*!  ****************************************************************************
+@brief	Get resampling subscriber state information
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Sub: Subscriber handle returned by GSV86extResampCreate
+ @param[in]	Index: One of RESAMP_INFO_*
+ @return Requested value or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extResampGetInfo(int ComNo, int Sub, int Index);
+
+/*!  ****************************************************************************
+@brief	Delete a resampling subscriber
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Sub: Subscriber handle returned by GSV86extResampCreate
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extResampDelete(int ComNo, int Sub);
+
+/*!  ****************************************************************************
+@brief	Create a named reader cursor on the host frame ring
+--------------------------------------------------------------------------------------
+	Every cursor sees all frames written by GSV86extPoll from its creation on, independently of
+	the other cursors. The slowest blocking cursor governs overwriting of the ring (see GSV86extPoll).
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Name: Zero-terminated name of the consumer, unique per ComNo, max. CURSOR_NAME_SIZE-1 chars
+ @param[in]	flags: CURSOR_FLAG_* constants, can be ORed together
+ @return Cursor handle (1..CURSOR_NUM_MAX) or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCursorCreate(int ComNo, const char* Name, unsigned long flags);
+
+/*!  ****************************************************************************
+@brief	Find a reader cursor by name
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Name: Zero-terminated name given to GSV86extCursorCreate
+ @return Cursor handle or GSV_ERROR if no cursor with this name exists.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCursorFind(int ComNo, const char* Name);
+
+/*!  ****************************************************************************
+@brief	Read values through a reader cursor
+--------------------------------------------------------------------------------------
+	Same parameters and behaviour as GSV86readMultiple, but reads from the host frame ring at the
+	position of the cursor and advances only this cursor.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Cur: Cursor handle returned by GSV86extCursorCreate
+ @param[in]	Chan:	=0: Read all objects, sorted Obj1,Obj2..ObjN of oldest frame first<br>
+ 		=1..NumMappedObjects: Read values of specified object only
+ @param[out] *out: Pointer to array of double, where values are written to
+ @param[in]	count: Maximum number of values to read. If Chan=0, must be dividible by NumMappedObjects.
+ @param[out] *valsread: Pointer to int value, where the actual number of values written into *out is stored.
+ @return Simple errorcode: GSV_OK, if no values were read, GSV_TRUE if value(s) were read, or GSV_ERROR if function failed.
+ \note: The cursor position is kept per frame: with Chan>0 the values of the other objects of the
+ 	frames read are skipped for this cursor.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCursorRead(int ComNo, int Cur, int Chan, double* out, int count, int* valsread);
+
+/*!  ****************************************************************************
+@brief	Read values through a reader cursor as 32-bit float
+--------------------------------------------------------------------------------------
+	Same as GSV86extCursorRead, but the values are converted to float. Halves the memory
+	traffic of the consumer; the device resolution (max. 24 bits) is kept, if values are
+	read unscaled with DATATYP_INT16 or DATATYP_INT24.
+
+ @param[out] *out: Pointer to array of float, where values are written to
+ Other parameters and return value: see GSV86extCursorRead
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCursorReadFloat(int ComNo, int Cur, int Chan, float* out, int count, int* valsread);
+
+/*!  ****************************************************************************
+@brief	Read frames through a reader cursor in interleaved or planar layout
+--------------------------------------------------------------------------------------
+	Reads all objects of up to MaxFrames frames. With CURSOR_LAYOUT_PLANAR the values are written
+	directly from the host frame ring into one contiguous array per object, so consumers working
+	per channel need no transpose.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Cur: Cursor handle returned by GSV86extCursorCreate
+ @param[out] *out: Pointer to array of double, where values are written to.
+ 		Size must be >= MaxFrames*NumMappedObjects (interleaved) or (NumMappedObjects-1)*Stride+MaxFrames (planar).
+ @param[in]	MaxFrames: Maximum number of frames to read
+ @param[in]	Layout: CURSOR_LAYOUT_INTERLEAVED or CURSOR_LAYOUT_PLANAR
+ @param[in]	Stride: CURSOR_LAYOUT_PLANAR: distance in values between the arrays of two objects, >= MaxFrames.
+ 		Ignored with CURSOR_LAYOUT_INTERLEAVED.
+ @param[out] *framesread: Pointer to int value, where the number of frames read is stored.
+ @return Simple errorcode: GSV_OK, if no frames were read, GSV_TRUE if frame(s) were read, or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCursorReadLayout(int ComNo, int Cur, double* out, int MaxFrames, int Layout, int Stride, int* framesread);
+
+/*!  ****************************************************************************
+@brief	Read frames through a reader cursor in interleaved or planar layout as 32-bit float
+--------------------------------------------------------------------------------------
+	Same as GSV86extCursorReadLayout, but the values are converted to float.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCursorReadLayoutFloat(int ComNo, int Cur, float* out, int MaxFrames, int Layout, int Stride, int* framesread);
+
+/*!  ****************************************************************************
+@brief	Get reader cursor statistics
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Cur: Cursor handle returned by GSV86extCursorCreate
+ @param[in]	Index: One of CURSOR_INFO_*
+ @return Requested value or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCursorGetInfo(int ComNo, int Cur, int Index);
+
+/*!  ****************************************************************************
+@brief	Delete a reader cursor
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Cur: Cursor handle returned by GSV86extCursorCreate
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCursorDelete(int ComNo, int Cur);
+
+/*!  ****************************************************************************
+@brief	Publish the host frame ring in a named shared memory segment
+--------------------------------------------------------------------------------------
+	The ring is moved into the segment (header SHM_HEADER, then the frames), so other local
+	processes can read the frames without any further copy by the publisher.
+	Windows: named file mapping "Local\<Name>". POSIX: shm_open("/<Name>").
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Name: Zero-terminated segment name, max. SHM_NAME_SIZE-1 chars. NULL: SHM_NAME_DEF
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extShmPublish(int ComNo, const char* Name);
+
+/*!  ****************************************************************************
+@brief	Stop publishing the host frame ring
+--------------------------------------------------------------------------------------
+	Sets State to SHM_STATE_CLOSED and moves the ring back into process memory.
+	Readers keep their mapping until GSV86extShmClose.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extShmUnpublish(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Open a shared memory segment published by another process (reader side)
+--------------------------------------------------------------------------------------
+	Can be used in any process, no device needs to be activated.
+	Errors of the reader side functions are retrieved with GSV86extGetLastError(0).
+
+ @param[in]	Name: Zero-terminated segment name given to GSV86extShmPublish
+ @return Reader handle (1..SHM_READER_MAX) or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extShmOpen(const char* Name);
+
+/*!  ****************************************************************************
+@brief	Get value object info of a published stream (reader side)
+--------------------------------------------------------------------------------------
+	Consistent copy of the header fields, taken under the sequence lock.
+	Fails with ERR_EXT_WRONG_STATE if the publisher does not finish a header update
+	within 100 ms, e.g. because its process ended during the update.
+
+ @param[in]	Handle: Reader handle returned by GSV86extShmOpen
+ @param[out] ScaleFactors: Pointer to array of double with size = 16, or NULL
+ @param[out] ObjMapping: Pointer to array with size = 16, or NULL
+ @param[out] DataType: Pointer to one value, or NULL
+ @param[out] Frequency: Pointer to one value, or NULL
+ @return NumberOfMappedObjects or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extShmGetInfo(int Handle, double* ScaleFactors, unsigned long* ObjMapping, int* DataType, double* Frequency);
+
+/*!  ****************************************************************************
+@brief	Read frames of a published stream (reader side)
+--------------------------------------------------------------------------------------
+ @param[in]	Handle: Reader handle returned by GSV86extShmOpen
+ @param[in,out] *Pos: Frame number of the next frame to read; advanced by the number of frames read.
+ 		Set to SHM_POS_NEWEST to start with the next frame published.
+ 		If frames were already overwritten, *Pos is moved forward to the oldest valid frame.
+ @param[out] *out: Pointer to array of double, sorted like GSV86readMultiple with Chan=0
+ @param[in]	count: Maximum number of values to read. Must be dividible by NumMappedObjects.
+ @param[out] *valsread: Pointer to int value, where the actual number of values written into *out is stored.
+ @return GSV_OK, if no values were read, GSV_TRUE if value(s) were read, or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extShmRead(int Handle, unsigned long long* Pos, double* out, int count, int* valsread);
+
+/*!  ****************************************************************************
+@brief	Get direct (zero-copy) access to a published segment (reader side)
+--------------------------------------------------------------------------------------
+ @param[in]	Handle: Reader handle returned by GSV86extShmOpen
+ @return Pointer to the read-only SHM_HEADER at the segment base, or NULL if Handle is wrong.
+ 	The frame ring begins at (const char*)header + DataOffset. See SHM_HEADER for validity rules.
+*
+ Device access: No
+ ********************************************************************************** */
+const SHM_HEADER* CALLTYP GSV86extShmGetHeader(int Handle);
+
+/*!  ****************************************************************************
+@brief	Close a segment opened with GSV86extShmOpen (reader side)
+--------------------------------------------------------------------------------------
+ @param[in]	Handle: Reader handle returned by GSV86extShmOpen
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extShmClose(int Handle);
+
+/*!  ****************************************************************************
+@brief	Start the network streaming server of a device
+--------------------------------------------------------------------------------------
+	Starts a server thread, which serves the frames written by GSV86extPoll to up to NET_CLIENT_MAX
+	TCP clients (protocol see NET_SUBSCRIBE). Every client reads through its own non-blocking reader
+	cursor (named "net<n>"), so slow clients lose frames instead of stalling acquisition.
+	Sends are non-blocking: a client whose connection accepts no data for 1s, or lags behind by more
+	than 1 MByte, is disconnected without delaying the other clients.
+	The server listens on 127.0.0.1 only, unless NET_FLAG_ALL_INTERFACES is given.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Port: TCP port to listen on. =0: NET_PORT_DEF
+ @param[in]	flags: NET_FLAG_* constants, can be ORed together
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extNetStart(int ComNo, int Port, unsigned long flags);
+
+/*!  ****************************************************************************
+@brief	Stop the network streaming server of a device and disconnect all clients
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extNetStop(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Get network streaming server information
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Index: One of NET_INFO_*
+ @return Requested value or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extNetGetInfo(int ComNo, int Index);
+
+/*!  ****************************************************************************
+@brief	Calculate the maximum sustainable data frequency of a configuration
+--------------------------------------------------------------------------------------
+	A measuring value frame has PLAN_FRAME_OVERHEAD bytes plus NumObj values of 2 (DATATYP_INT16),
+	3 (DATATYP_INT24) or 4 (DATATYP_FLOAT) bytes, each byte takes PLAN_UART_BITS_PER_BYTE bits
+	on the serial line, and PLAN_LOAD_MAX of the bitrate may be used by measuring values.
+
+ @param[in]	Bitrate: Interface bitrate as for GSV86activateExtended / GSV86writeInterfaceBaud.
+ 		=0: CONST_BAUDRATE
+ @param[in]	DataType: DATATYP_INT16, DATATYP_INT24 or DATATYP_FLOAT
+ @param[in]	NumObj: Number of mapped value objects. Range: 1..VALOBJ_NUM_MAX
+ @return Maximum data frequency in frames per second, or GSV_ERROR if a parameter is wrong.
+ If GSV_ERROR, the error code is available with GSV86extGetLastError(0).
+*
+ Device access: No
+ ********************************************************************************** */
+double CALLTYP GSV86extPlanMaxFrequency(unsigned long Bitrate, int DataType, int NumObj);
+
+/*!  ****************************************************************************
+@brief	Check a data frequency against the link bandwidth of the actual device configuration
+--------------------------------------------------------------------------------------
+	Reads data type and number of mapped objects (GSV86getValObjectInfo) and the device
+	data rate range (GSV86getDataRateRange) of the activated device.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Bitrate: Interface bitrate. =0: bitrate of the actual interface (GSV86readAllInterfSettings);
+ 		no bandwidth limit besides the device one, if it is USB
+ @param[in]	Frequency: Data frequency to be checked, as for GSV86setFrequency
+ @param[out] *MaxFrequency: Pointer to double value, where the maximum sustainable data frequency
+ 		(limited by bandwidth and device) is written to. May be NULL.
+ @return GSV_TRUE if Frequency can be sustained, GSV_OK if not, or GSV_ERROR if function failed.
+*
+ Device access: Yes, CmdNo: see GSV86getValObjectInfo, 0x63; if Bitrate=0: 0x01, 0x7B
+ ********************************************************************************** */
+int CALLTYP GSV86extPlanCheck(int ComNo, unsigned long Bitrate, double Frequency, double* MaxFrequency);
+
+/*!  ****************************************************************************
+@brief	Recommend a data type / number of objects for a data frequency
+--------------------------------------------------------------------------------------
+	If the actual configuration doesn't fit, the data types narrower than the actual one are
+	tried with all objects (DATATYP_FLOAT, then DATATYP_INT24, then DATATYP_INT16).
+	If even DATATYP_INT16 doesn't fit, the largest number of objects fitting with DATATYP_INT16
+	is recommended; the application decides which objects to unmap.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Bitrate: Interface bitrate, =0: as for GSV86extPlanCheck
+ @param[in]	Frequency: Requested data frequency
+ @param[out] *DataType: Pointer to int value, where the recommended data type is written to
+ @param[out] *NumObj: Pointer to int value, where the recommended number of objects is written to
+ @return GSV_TRUE if the actual configuration fits (returned unchanged), GSV_OK if a changed
+ 	configuration is recommended, or GSV_ERROR if function failed or Frequency can't be
+ 	sustained at all (ERR_EXT_BANDWIDTH).
+*
+ Device access: Yes, see GSV86extPlanCheck
+ ********************************************************************************** */
+int CALLTYP GSV86extPlanRecommend(int ComNo, unsigned long Bitrate, double Frequency, int* DataType, int* NumObj);
+
+/*!  ****************************************************************************
+@brief	Set data frequency after admission check
+--------------------------------------------------------------------------------------
+	Calls GSV86setFrequency only if GSV86extPlanCheck accepts the frequency.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Bitrate: Interface bitrate, =0: as for GSV86extPlanCheck
+ @param[in]	Frequency: Data frequency
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+ 	ERR_EXT_BANDWIDTH, if Frequency can't be sustained.
+*
+ Device access: Yes, see GSV86extPlanCheck and GSV86setFrequency
+ ********************************************************************************** */
+int CALLTYP GSV86extSetFrequencyChecked(int ComNo, unsigned long Bitrate, double Frequency);
+
+/*!  ****************************************************************************
+@brief	Activate a device and switch to the highest bitrate supported by both ends
+--------------------------------------------------------------------------------------
+	Opens the port with GSV86activateExtended at CONST_BAUDRATE or, if the device doesn't answer
+	there, at the bitrate this function last used, MaxBitrate or the standard UART bitrates up to
+	MaxBitrate (highest first). Then it reads the bitrates supported by the actual interface (GSV86readAllInterfSettings) and tries them from the highest
+	down to the actual one: the device is switched with GSV86writeInterfaceBaud, the port is
+	re-opened at the new bitrate and verified by reading the serial number and, if value
+	transmission is on, by a throughput probe of BAUD_PROBE_MS.
+	If verification fails, the device is switched back and the next lower bitrate is tried.
+
+ @param[in]	ComNo: 	Number of Comport to be opened
+ @param[in]	BufSize: As for GSV86activateExtended
+ @param[in]	flags: As for GSV86activateExtended
+ @param[in]	MaxBitrate: Highest bitrate the host port supports. =0: BAUD_MAX
+ @param[out] *Bitrate: Pointer to value, where the bitrate in use is written to. May be NULL.
+ @return GSV_TRUE if the bitrate was raised, GSV_OK if the device is open at the initial bitrate
+ 	(no higher bitrate available or all failed), or GSV_ERROR if the device could not be opened
+ 	or was lost while switching.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+ \note: Call before GSV86extAttach. With USB-CDC the bitrate has no effect; the interface
+ 	usually reports no alternative bitrates then.
+ \note: GSV86writeInterfaceBaud may store the bitrate in the device's non-volatile memory.
+*
+ Device access: Yes, see GSV86activateExtended, GSV86readAllInterfSettings, GSV86writeInterfaceBaud
+ ********************************************************************************** */
+int CALLTYP GSV86extActivateFast(int ComNo, unsigned long BufSize, unsigned long flags, unsigned long MaxBitrate,
+	unsigned long* Bitrate);
+
+/*!  ****************************************************************************
+@brief	Probe several ports for devices at the same time
+--------------------------------------------------------------------------------------
+	Each port is probed with GSV86activateExtended, GSV86getSerialNo, GSV86getInterfaceIdentity
+	and GSV86firmwareVersion. Up to DISC_THREADS_MAX ports are probed in parallel, so the
+	activation timeouts of ports without device overlap instead of adding up.
+	Results are cached per ComNo, see GSV86extDiscoverCached. Only ports with a device and ports
+	where no device answered (ERR_NO_GSV_ANSWER, ERR_NO_GSV_FOUND) are cached; busy ports (DISC_BUSY)
+	and ports that failed otherwise (DISC_FAILED) are probed again on the next call.
+	A cached result is only used with DISC_FLAG_USE_CACHE and if it was probed with the same Bitrate.
+	A ComNo listed more than once is probed once and counted once.
+
+ @param[in]	ComNos: Array of Count ComNos to probe. If NULL, DISC_COMNO_FIRST..DISC_COMNO_LAST are probed
+ 	and Count is ignored.
+ @param[in]	Count: Number of ComNos in ComNos
+ @param[in]	Bitrate: Bitrate for GSV86activateExtended. =0: CONST_BAUDRATE
+ @param[in]	flags: DISC_FLAG_* combined by OR, plus ACTEX_FLAG_* passed to GSV86activateExtended
+ @param[out] Info: Array receiving one DISC_INFO per element of ComNos, in the order of ComNos.
+ 	Must hold Count entries, or DISC_COMNO_LAST-DISC_COMNO_FIRST+1 if ComNos is NULL. May be NULL.
+ @return Number of devices found or GSV_ERROR if parameters were wrong.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError(0).
+ \note: Ports already activated by the application must not be probed.
+*
+ Device access: Yes, see GSV86activateExtended
+ ********************************************************************************** */
+int CALLTYP GSV86extDiscover(const int* ComNos, int Count, unsigned long Bitrate, unsigned long flags, DISC_INFO* Info);
+
+/*!  ****************************************************************************
+@brief	Get the cached result of GSV86extDiscover for a ComNo
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Comport
+ @param[out] Info: Pointer to DISC_INFO receiving the result
+ @return GSV_TRUE if a device was found, GSV_OK if no device was found,
+ 	or GSV_ERROR if the port was not probed yet (ERR_EXT_WRONG_STATE) or parameters were wrong.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extDiscoverCached(int ComNo, DISC_INFO* Info);
+
+/*!  ****************************************************************************
+@brief	Remove the cached result of GSV86extDiscover, e.g. after a device was plugged elsewhere
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Comport or -1 for all
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if ComNo is wrong.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extDiscoverInvalidate(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Enable automatic reconnection after the link to an attached device is lost
+--------------------------------------------------------------------------------------
+	If GSV86readMultiple fails in GSV86extPoll with a port error (ERR_COM_GEN_FAILURE after
+	a USB-CDC reset, or a system error such as OWN_ERR_MASK|ERROR_DEVICE_NOT_CONNECTED), the port is released and GSV86extPoll re-activates it at most every
+	RECON_RETRY_MS instead of returning GSV_ERROR. The host frame ring, all processing stages
+	and cursors are kept. After re-activation the serial number and the value objects are
+	compared with those at enabling; value transmission is restarted if it was on then.
+	Each reconnect records a gap at the frame number where frames were lost, see
+	GSV86extReconnectGetGaps.
+	If another device answers, GSV86extPoll fails with ERR_EXT_DEVICE_CHANGED and
+	reconnection stops.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Bitrate: Bitrate for GSV86activateExtended. =0: CONST_BAUDRATE
+ @param[in]	BufSize: BufSize for GSV86activateExtended. =0: CONST_BUFSIZE
+ @param[in]	flags: RECON_FLAG_* combined by OR with ACTEX_FLAG_* passed to GSV86activateExtended
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: Yes, see GSV86getSerialNo, GSV86getTXmode
+ ********************************************************************************** */
+int CALLTYP GSV86extReconnectEnable(int ComNo, unsigned long Bitrate, unsigned long BufSize, unsigned long flags);
+
+/*!  ****************************************************************************
+@brief	Disable automatic reconnection. Recorded gaps are discarded.
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extReconnectDisable(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Get automatic reconnection information
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Index: One of RECON_INFO_*
+ @return Requested value or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extReconnectGetInfo(int ComNo, int Index);
+
+/*!  ****************************************************************************
+@brief	Get the gaps recorded by automatic reconnection, oldest first
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[out] Frame: Array receiving the frame number of the first frame after each gap
+ 	(with RECON_FLAG_GAP_NAN: of the NaN frame)
+ @param[out] Seconds: Array receiving the time between link loss and reconnect. May be NULL.
+ @param[in]	Max: Size of the arrays
+ @return Number of gaps written (at most RECON_GAP_MAX) or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extReconnectGetGaps(int ComNo, unsigned long long* Frame, double* Seconds, int Max);
+
+/*!  ****************************************************************************
+@brief	Start a thread calling GSV86extPoll with short, bounded period
+--------------------------------------------------------------------------------------
+	For closed-loop control, where the time from frame arrival to the application matters more
+	than throughput. The thread polls every PeriodUs or continuously (LOWLAT_FLAG_BUSY),
+	optionally at raised priority and bound to a set of CPU cores.
+	Values are read by the application with GSV86extGetLatest or through reader cursors;
+	GSV86extPoll must not be called by the application meanwhile.
+	\note The DLL's own receive thread and its port timeouts are not affected.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	PeriodUs: Poll period in microseconds, >=LOWLAT_PERIOD_MIN_US. With LOWLAT_FLAG_BUSY the pause
+ 	after a failed poll, at least LOWLAT_PERIOD_MIN_US; polls without frames only yield the CPU then.
+ @param[in]	Priority: One of LOWLAT_PRIO_*
+ @param[in]	Affinity: Bit mask of CPU cores the thread may run on. =0: not changed
+ @param[in]	flags: LOWLAT_FLAG_* constants, can be ORed together
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+ A priority or affinity refused by the OS is no error, see LOWLAT_INFO_PRIO_SET.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extLowLatStart(int ComNo, unsigned long PeriodUs, int Priority, unsigned long long Affinity,
+	unsigned long flags);
+
+/*!  ****************************************************************************
+@brief	Stop the low-latency poll thread
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extLowLatStop(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Get low-latency poll thread information
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Index: One of LOWLAT_INFO_*
+ @return Requested value or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extLowLatGetInfo(int ComNo, int Index);
+
+/*!  ****************************************************************************
+@brief	Get the newest frame in the host frame ring without consuming it
+--------------------------------------------------------------------------------------
+	Unlike GSV86read, no value is removed; reader cursors and stages are not affected,
+	so GSV86clearDLLbuffer before reading the current values is not needed anymore.
+	The frame is published by GSV86extPoll through a sequence lock: this function does not
+	wait for GSV86extPoll and can be called from any thread at any rate.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[out] out: Array of NumObj values (see GSV86getValObjectInfo), as one frame of GSV86readMultiple with Chan=0
+ @param[out] *FrameNo: Pointer to value, where the frame number is written to. May be NULL.
+ @return GSV_TRUE if a frame was copied, GSV_OK if no frame was polled yet, or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extGetLatest(int ComNo, double* out, unsigned long long* FrameNo);
+
+/*!  ****************************************************************************
+@brief	Enable or disable latency statistics of an attached device
+--------------------------------------------------------------------------------------
+	Records timestamps per GSV86extPoll call, per batch of frames and per frame read through
+	reader cursors and GSV86extGetLatest, aggregated into log-linear (HDR style) histograms,
+	see STATS_HIST_*. Enabling again keeps the recorded samples, see GSV86extStatsReset.
+	\note Arrival of the bytes at the port and parsing take place inside the DLL and can't be
+	timestamped from outside; STATS_HIST_DLL and STATS_HIST_POLL_GAP bound them from the host side.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	OnOff: =1: enable, =0: disable
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extStatsEnable(int ComNo, int OnOff);
+
+/*!  ****************************************************************************
+@brief	Clear all latency histograms of an attached device
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if statistics were never enabled.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extStatsReset(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Get the summary of a latency histogram
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Hist: One of STATS_HIST_*
+ @param[out] Stats: Pointer to STATS_LATENCY receiving the summary
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extStatsGet(int ComNo, int Hist, STATS_LATENCY* Stats);
+
+/*!  ****************************************************************************
+@brief	Get the non-empty buckets of a latency histogram, e.g. for plotting
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Hist: One of STATS_HIST_*
+ @param[out] UpperUs: Array receiving the upper bound of each bucket in microseconds
+ @param[out] Counts: Array receiving the number of samples of each bucket
+ @param[in]	Max: Size of the arrays. STATS_BUCKETS is always sufficient.
+ @return Number of buckets written, in ascending order, or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extStatsGetHistogram(int ComNo, int Hist, double* UpperUs, unsigned long long* Counts, int Max);
+
+/*!  ****************************************************************************
+@brief	Enable or disable per-CmdNo accounting of device commands
+--------------------------------------------------------------------------------------
+	Counts commands executed through GSV86extCmdCall or reported with GSV86extCmdRecord.
+	The device need not be attached; the share of measuring values in GSV86extCmdGetLoad
+	is only known for attached devices. Enabling again restarts all counters.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	OnOff: =1: enable, =0: disable
+ @param[in]	Retries: Number of retries of GSV86extCmdCall after ERR_NO_GSV_ANSWER, 0..CMD_RETRY_MAX.
+ 	Retries take place also while accounting is disabled.
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCmdStatsEnable(int ComNo, int OnOff, int Retries);
+
+/*!  ****************************************************************************
+@brief	Execute a device command with timing, retry and accounting
+--------------------------------------------------------------------------------------
+	Calls Func(ComNo, Ctx), repeats it after ERR_NO_GSV_ANSWER (see GSV86extCmdStatsEnable)
+	and accounts each attempt under CmdNo. Example for GSV86setZero (CmdNo 0x0C):<br>
+	static int CALLTYP doZero(int ComNo, void* Ctx) { return GSV86setZero(ComNo, *(int*)Ctx); }<br>
+	int chan = 1; GSV86extCmdCall(ComNo, 0x0C, 1, 0, doZero, &chan);
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	CmdNo: Device command number, as documented in "Device access" of the DLL function
+ @param[in]	TxParBytes: Number of parameter bytes sent with the command (frame overhead is added)
+ @param[in]	RxParBytes: Number of parameter bytes in the answer (frame overhead is added)
+ @param[in]	Func: Function executing the command
+ @param[in]	Ctx: Passed to Func
+ @return Return value of the last call of Func, or GSV_ERROR if parameters were wrong.
+ If Func failed, error information is available from GSV86getLastProtocollError as usual.
+*
+ Device access: Yes, see Func
+ ********************************************************************************** */
+int CALLTYP GSV86extCmdCall(int ComNo, int CmdNo, int TxParBytes, int RxParBytes, EXT_CMD_FUNC Func, void* Ctx);
+
+/*!  ****************************************************************************
+@brief	Account a device command executed and timed by the application
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	CmdNo: Device command number
+ @param[in]	TxParBytes: Number of parameter bytes sent with the command
+ @param[in]	RxParBytes: Number of parameter bytes in the answer
+ @param[in]	Seconds: Round-trip time
+ @param[in]	Result: Return value of the DLL function. If GSV_ERROR, GSV86getLastProtocollError
+ 	is read to detect a timeout.
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCmdRecord(int ComNo, int CmdNo, int TxParBytes, int RxParBytes, double Seconds, int Result);
+
+/*!  ****************************************************************************
+@brief	Get the accounting of one CmdNo
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	CmdNo: Device command number
+ @param[out] Stats: Pointer to CMD_STATS receiving the counters
+ @return GSV_TRUE if the command was used, GSV_OK if not (Stats zeroed) or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCmdGet(int ComNo, int CmdNo, CMD_STATS* Stats);
+
+/*!  ****************************************************************************
+@brief	Get the CmdNos used since accounting was enabled
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[out] CmdNos: Array receiving the CmdNos in ascending order
+ @param[in]	Max: Size of CmdNos. CMD_NUM is always sufficient.
+ @return Number of CmdNos written or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCmdList(int ComNo, int* CmdNos, int Max);
+
+/*!  ****************************************************************************
+@brief	Get the share of the interface bitrate used by commands and by measuring values
+--------------------------------------------------------------------------------------
+	Refers to the direction from device to host, which command answers share with the
+	measuring values (the serial link is full duplex). Averaged since accounting was enabled,
+	from the estimated answer bytes and, for attached devices, the frames moved by
+	GSV86extPoll (frame size see GSV86extPlanMaxFrequency).
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Bitrate: Interface bitrate. =0: bitrate of the actual interface (GSV86readAllInterfSettings);
+ 		PLAN_USB_BITRATE with 8 bits per byte, if it is USB
+ @param[out] *CmdShare: Pointer to value receiving the share of command answers, 0..1
+ @param[out] *ValShare: Pointer to value receiving the share of measuring values, 0..1. May be NULL.
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: Only if Bitrate=0, CmdNo: 0x01, 0x7B
+ ********************************************************************************** */
+int CALLTYP GSV86extCmdGetLoad(int ComNo, unsigned long Bitrate, double* CmdShare, double* ValShare);
+
+/*!  ****************************************************************************
+@brief	Start the asynchronous command queue of a ComNo
+--------------------------------------------------------------------------------------
+	Creates a thread executing the commands submitted with GSV86extAsyncSubmit one after the
+	other, so that configuration and status reads can be issued e.g. from a UI thread without
+	blocking it or the acquisition loop. Measuring values keep flowing to GSV86extPoll meanwhile,
+	since the DLL receives them in its own thread.
+	The device need not be attached.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extAsyncOpen(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Stop the asynchronous command queue of a ComNo
+--------------------------------------------------------------------------------------
+	Waits for the command in execution. Commands not started yet complete with
+	GSV_ERROR and ERR_EXT_CANCELLED. Handles not collected yet become invalid.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extAsyncClose(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Submit a device command to the asynchronous command queue
+--------------------------------------------------------------------------------------
+	Func(ComNo, Ctx) is executed in the queue thread through GSV86extCmdCall, so it is timed,
+	retried and accounted like a synchronous call. Ctx must stay valid until completion.
+	Commands are executed by priority of CmdNo (see GSV86extAsyncSetPriority), in order of
+	submission within one priority. A command in execution can't be interrupted; to let
+	time-critical commands get ahead of a long transfer, Func does it in steps and returns
+	ASYNC_CONTINUE after each step.
+	Completion is reported either by Done or, if Done is NULL, by GSV86extAsyncPoll
+	or GSV86extAsyncWait, which release the handle.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	CmdNo: Device command number, see GSV86extCmdCall
+ @param[in]	TxParBytes: Number of parameter bytes sent with the command
+ @param[in]	RxParBytes: Number of parameter bytes in the answer
+ @param[in]	Func: Function executing the command
+ @param[in]	Ctx: Passed to Func
+ @param[in]	Done: Completion function or NULL
+ @param[in]	User: Passed to Done
+ @return Handle (>0) of the command or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: Yes, see Func
+ ********************************************************************************** */
+int CALLTYP GSV86extAsyncSubmit(int ComNo, int CmdNo, int TxParBytes, int RxParBytes, EXT_CMD_FUNC Func, void* Ctx,
+	EXT_ASYNC_DONE Done, void* User);
+
+/*!  ****************************************************************************
+@brief	Submit GSV86readFormattedTEDSList to the asynchronous command queue
+--------------------------------------------------------------------------------------
+	Parameters as GSV86readFormattedTEDSList; TEDSfilePath is copied, ListOut and ExtListOut
+	must stay valid until completion. Completion as GSV86extAsyncSubmit.
+
+ @return Handle (>0) of the command or GSV_ERROR if function failed.
+*
+ Device access: Yes, CmdNo: 0x64
+ ********************************************************************************** */
+int CALLTYP GSV86extAsyncReadTEDSList(int ComNo, int Chan, const char* TEDSfilePath, char* ListOut, int ListSize,
+	int Code, char* ExtListOut, EXT_ASYNC_DONE Done, void* User);
+
+/*!  ****************************************************************************
+@brief	Check whether a submitted command has completed
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Handle: Returned by GSV86extAsyncSubmit without completion function
+ @param[out] *Result: Pointer to value receiving the return value of the command
+ @param[out] *ErrCode: Pointer to value receiving the error code, see EXT_ASYNC_DONE. May be NULL.
+ @return GSV_TRUE if completed (Handle is released), GSV_OK if not yet, or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extAsyncPoll(int ComNo, int Handle, int* Result, int* ErrCode);
+
+/*!  ****************************************************************************
+@brief	Wait until a submitted command has completed
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Handle: Returned by GSV86extAsyncSubmit without completion function
+ @param[in]	TimeoutMs: Maximum waiting time in milliseconds or ASYNC_WAIT_INFINITE
+ @param[out] *Result: Pointer to value receiving the return value of the command
+ @param[out] *ErrCode: Pointer to value receiving the error code, see EXT_ASYNC_DONE. May be NULL.
+ @return GSV_TRUE if completed (Handle is released), GSV_OK at timeout, or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extAsyncWait(int ComNo, int Handle, unsigned long TimeoutMs, int* Result, int* ErrCode);
+
+/*!  ****************************************************************************
+@brief	Remove a submitted command from the queue before it is executed
+--------------------------------------------------------------------------------------
+	A cancelled command completes with GSV_ERROR and ERR_EXT_CANCELLED. A command in execution
+	in steps (ASYNC_CONTINUE) is cancelled after the current step.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Handle: Returned by GSV86extAsyncSubmit
+ @return GSV_TRUE if cancelled, GSV_OK if already in execution or completed, or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extAsyncCancel(int ComNo, int Handle);
+
+/*!  ****************************************************************************
+@brief	Submit the reading of a six-axis sensor calibration to the asynchronous command queue
+--------------------------------------------------------------------------------------
+	Result as GSV86readFTsensorCalArray, but read with GSV86setFTarrayToRead and one
+	GSV86readFTsensorCalValue per value, so that commands of higher priority are executed
+	between the values. If a job of the queue executed another FT calibration command in between,
+	the array is selected again before the next value. All arrays must stay valid until completion.
+	\note GSV86setFTarrayToRead must not be called by the application outside of the queue until completion.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	ArrNo: Index of calibration array, see GSV86setFTarrayToRead
+ @param[out] SensorSerNo: String of at least 9 characters receiving the sensor serial number (8 digits).
+ 	A serial number of more than 8 digits fails with ERR_UNKNOWN_VALUE.
+ @param[out] MatrixNorm, InSens, Matrix, Offsets, MaxVals, Zvals: see GSV86readFTsensorCalArray
+ @param[in]	Done: Completion function or NULL, see GSV86extAsyncSubmit
+ @param[in]	User: Passed to Done
+ @return Handle (>0) of the command or GSV_ERROR if function failed.
+*
+ Device access: Yes, CmdNo: 0x7D, 0x47
+ ********************************************************************************** */
+int CALLTYP GSV86extAsyncReadFTCalArray(int ComNo, int ArrNo, char* SensorSerNo, double* MatrixNorm, double* InSens,
+	double* Matrix, double* Offsets, double* MaxVals, double* Zvals, EXT_ASYNC_DONE Done, void* User);
+
+/*!  ****************************************************************************
+@brief	Set the priority of a CmdNo in the asynchronous command queue
+--------------------------------------------------------------------------------------
+	Applies to commands submitted afterwards.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	CmdNo: Device command number
+ @param[in]	Prio: One of ASYNC_PRIO_*
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extAsyncSetPriority(int ComNo, int CmdNo, int Prio);
+
+/*!  ****************************************************************************
+@brief	Get the time commands waited in the asynchronous command queue
+--------------------------------------------------------------------------------------
+	From submission until the first call of Func, per priority, since GSV86extAsyncOpen.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Prio: One of ASYNC_PRIO_*
+ @param[out] Stats: Pointer to STATS_LATENCY receiving the summary
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extAsyncGetWait(int ComNo, int Prio, STATS_LATENCY* Stats);
+
+/*!  ****************************************************************************
+@brief	Probe the commands available on a device into the capability cache
+--------------------------------------------------------------------------------------
+	Call once after activation. The cache is keyed by serial number and firmware version:
+	if the device is already cached, only these two are read. Otherwise
+	GSV86getSoftwareConfiguration and GSV86getIsCmdAvailable are read for the CmdNos used by
+	MEGSV86xx.DLL, whole ranges at once, split only where commands are missing. Other CmdNos
+	are reported as not available. Afterwards
+	GSV86extCapsIsCmdAvailable and GSV86extCapsGetSoftwareConfiguration answer from memory.
+	The device need not be attached.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	flags: CAPS_FLAG_* constants
+ @param[out] *Queries: Pointer to value receiving the number of device requests. May be NULL.
+ @return GSV_TRUE if the device was probed, GSV_OK if it was found in the cache, or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: Yes, CmdNo: 0x1F, 0x2B, 0x2A, 0x93
+ ********************************************************************************** */
+int CALLTYP GSV86extCapsProbe(int ComNo, unsigned long flags, int* Queries);
+
+/*!  ****************************************************************************
+@brief	See, if command number (range) is available, from the capability cache
+--------------------------------------------------------------------------------------
+	As GSV86getIsCmdAvailable, without device access.
+
+ @param[in]	ComNo: 	Number of Device Comport, probed with GSV86extCapsProbe
+ @param[in]	CmdUp: Higher command number of range to check
+ @param[in]	CmdLo: Lower command number of range to check
+ @return GSV_TRUE if all commands of the range are available, GSV_OK if not, or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCapsIsCmdAvailable(int ComNo, int CmdUp, int CmdLo);
+
+/*!  ****************************************************************************
+@brief	Get flag value of device capabilities, from the capability cache
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport, probed with GSV86extCapsProbe
+ @return Flags as GSV86getSoftwareConfiguration (HAS_*) or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCapsGetSoftwareConfiguration(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Get the bitmap of available commands from the capability cache
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport, probed with GSV86extCapsProbe
+ @param[out] Bitmap: Array of CAPS_BITMAP_WORDS values. Bit (CmdNo % 32) of Bitmap[CmdNo / 32] is set,
+ 	if CmdNo is available.
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCapsGetBitmap(int ComNo, unsigned long* Bitmap);
+
+/*!  ****************************************************************************
+@brief	Forget which cached device is connected to a ComNo
+--------------------------------------------------------------------------------------
+	The cached devices are kept; the next GSV86extCapsProbe reads serial number and firmware
+	version again. Needed after the device at ComNo was exchanged.
+
+ @param[in]	ComNo: 	Number of Device Comport, or -1 for all
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCapsInvalidate(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Save the capability cache to a file
+--------------------------------------------------------------------------------------
+	For skipping the command range probing at the next start of the application, see GSV86extCapsLoad.
+	Text file, one line per device. Errors are reported for ComNo 0.
+
+ @param[in]	Path: File path
+ @return Number of devices saved or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCapsSave(const char* Path);
+
+/*!  ****************************************************************************
+@brief	Load a capability cache saved with GSV86extCapsSave
+--------------------------------------------------------------------------------------
+	Devices probed already in this process are not replaced. Errors are reported for ComNo 0.
+
+ @param[in]	Path: File path
+ @return Number of devices in the file or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extCapsLoad(const char* Path);
+
+/*!  ****************************************************************************
+@brief	Define the properties of a TEDS template for the host-side TEDS decoder
+--------------------------------------------------------------------------------------
+	The Basic TEDS (TemplID 0, TEDS_PROP_*) and the bridge sensor template (TEDS_TEMPL_BRIDGE,
+	TEDS_BRIDGE_*) are built in; a definition of TEDS_TEMPL_BRIDGE replaces the built-in one until
+	it is removed. Templates not defined end the decoding of a sensor at their position. Cached
+	sensors are decoded again with the new definition, without device access. Errors are reported
+	for ComNo 0.
+
+ @param[in]	TemplID: Template ID, 1..255
+ @param[in]	Props: Array of Num properties in the order stored in the TEDS memory
+ @param[in]	Num: Number of properties, 0..TEDS_PROPS_MAX. =0: remove definition (built-in one is used again)
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTedsDefineTemplate(int TemplID, const TEDS_PROP_DEF* Props, int Num);
+
+/*!  ****************************************************************************
+@brief	Check which input channels have a TEDS memory plugged
+--------------------------------------------------------------------------------------
+	Channels without TEDS memory are unbound from their cached sensor, so that the next
+	GSV86extTedsRead identifies the sensor again. Call periodically to notice sensor swaps.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[out] *Present: Pointer to value receiving Bits<7:0>: TEDS memory present at input channel 8..1. May be NULL.
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: Yes, CmdNo: 0x45
+ ********************************************************************************** */
+int CALLTYP GSV86extTedsCheck(int ComNo, int* Present);
+
+/*!  ****************************************************************************
+@brief	Read and decode the TEDS of a sensor on the host, with sensor cache
+--------------------------------------------------------------------------------------
+	Unlike GSV86readFormattedTEDSList and GSV86readTEDSentry, the TEDS memory is read once
+	with GSV86readTEDSrawData and decoded in memory (see TEDS_PROP_DEF, GSV86extTedsDefineTemplate).
+	Decoded sensors are cached by their Basic TEDS, which is unique per sensor:
+	- channel not unplugged since the last read (see GSV86extTedsCheck): no device access
+	- sensor cached: one request of TEDS_RAW_CHUNK bytes
+	- otherwise: TEDS memory read up to the end of the last template, at most TEDS_RAW_MAX bytes
+	Afterwards, entries are retrieved with GSV86extTedsGetEntries and GSV86extTedsGetEntry.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Chan: Input channel No (1..8) with TEDS sensor connected
+ @param[in]	flags: TEDS_FLAG_* constants, can be ORed together
+ @return GSV_TRUE if the TEDS memory was read and decoded, GSV_OK if the sensor was cached,
+ or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError().
+*
+ Device access: Yes, CmdNo: 0x65 (unless cached)
+ ********************************************************************************** */
+int CALLTYP GSV86extTedsRead(int ComNo, int Chan, unsigned long flags);
+
+/*!  ****************************************************************************
+@brief	Get the identity of the sensor read last at a channel
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Chan: Input channel No (1..8), read with GSV86extTedsRead
+ @param[out] *Id: Pointer to value receiving the Basic TEDS (64 bits). May be NULL.
+ @param[out] *Complete: Pointer to value receiving =1, if all templates were decoded, =0 if a template
+ 	is not defined or the TEDS memory ended early. May be NULL.
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTedsGetId(int ComNo, int Chan, unsigned long long* Id, int* Complete);
+
+/*!  ****************************************************************************
+@brief	Get all decoded TEDS entries of the sensor read last at a channel
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Chan: Input channel No (1..8), read with GSV86extTedsRead
+ @param[out] Entries: Array receiving the entries in the order stored, Basic TEDS first.
+ 	If NULL (and Max=0), only the number of entries is returned.
+ @param[in]	Max: Size of Entries
+ @return Number of entries written (or available, if Entries is NULL) or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTedsGetEntries(int ComNo, int Chan, TEDS_ENTRY* Entries, int Max);
+
+/*!  ****************************************************************************
+@brief	Get one decoded TEDS entry, as GSV86readTEDSentry without device access
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Chan: Input channel No (1..8), read with GSV86extTedsRead
+ @param[in]	TemplID: Template ID. Basic TEDS: =0
+ @param[in]	PropID: Property ID
+ @param[out] Entry: Pointer to TEDS_ENTRY receiving the entry. If not found, Flags is TEDS_ENTRY_NOT_EXIST.
+ @return GSV_TRUE if found, GSV_OK if not, or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTedsGetEntry(int ComNo, int Chan, int TemplID, int PropID, TEDS_ENTRY* Entry);
+
+/*!  ****************************************************************************
+@brief	Unbind the channels of a ComNo from their cached sensors
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport, or -1 for all ComNos; the sensor cache is cleared then, too.
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTedsInvalidate(int ComNo);
+
+/*!  ****************************************************************************
+@brief	Compile a TEDS dictionary file into the binary form loaded by GSV86extTedsDictLoad
+--------------------------------------------------------------------------------------
+	The text file (TEDSdictionary.ini, as passed to GSV86readFormattedTEDSList) is parsed once here,
+	instead of at each GSV86readFormattedTEDSList call. Assumed INI layout, since property IDs are
+	shared by all templates (lines starting with ';' are comments, section and key names are not
+	case-sensitive, other sections and keys are ignored):<br>
+	[PropertyPropID]<br>
+	Name=Text<br>
+	Unit=Text<br>
+	EnumValue=Text<br>
+	[TemplateTemplID]<br>
+	Propn=PropID,Bits,Type[,Start,Step[,CondPropID,CondValue]]<br>
+	Prop1, Prop2, ... list the properties in the order stored in the TEDS memory, see TEDS_PROP_DEF.
+	Type is the number or the name of a TEDS_TYPE_* constant (e.g. ConRes). EnumValue (e.g. Enum2)
+	defines the text of a value of an enumeration property. Errors are reported for ComNo 0.
+
+ @param[in]	IniPath: Path of the text file
+ @param[in]	DictPath: Path of the binary file to write
+ @return Number of templates compiled or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError(0):
+ ERR_EXT_FILE_OPEN, or ERR_FILE_CONTENT if the text file is malformed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTedsDictCompile(const char* IniPath, const char* DictPath);
+
+/*!  ****************************************************************************
+@brief	Load a compiled TEDS dictionary
+--------------------------------------------------------------------------------------
+	The file is memory-mapped read-only and shared by all ComNos (and, through the page cache,
+	by all processes using it). Its templates are defined with GSV86extTedsDefineTemplate.
+	A dictionary loaded before is replaced, its templates not defined again are removed. If the
+	file is no valid dictionary, the loaded one is kept; if memory runs out while defining the
+	templates, no dictionary is left loaded. Errors are reported for ComNo 0.
+
+ @param[in]	DictPath: Path of the file written by GSV86extTedsDictCompile
+ @return Number of templates defined or GSV_ERROR if function failed.
+ If GSV_ERROR, more detailed error information ca be retrieved with GSV86extGetLastError(0):
+ ERR_EXT_FILE_OPEN, or ERR_FILE_CONTENT if the file is no valid dictionary.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTedsDictLoad(const char* DictPath);
+
+/*!  ****************************************************************************
+@brief	Unmap the compiled TEDS dictionary
+--------------------------------------------------------------------------------------
+	Templates defined by GSV86extTedsDictLoad stay defined; enumeration texts are no longer available.
+
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTedsDictUnload(void);
+
+/*!  ****************************************************************************
+@brief	Get the text of a value of an enumeration property from the compiled TEDS dictionary
+--------------------------------------------------------------------------------------
+	Texts of the built-in bridge sensor template (TEDS_BRIDGE_TYPE) are available without dictionary.
+
+ @param[in]	TemplID: Template ID
+ @param[in]	PropID: Property ID
+ @param[in]	Value: Decoded (unsigned) value, see TEDS_ENTRY.Udata
+ @param[out] Text: String receiving the text, size must be >= TEDS_NAME_SIZE
+ @return GSV_TRUE if found, GSV_OK if not, or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTedsDictGetEnumText(int TemplID, int PropID, unsigned long Value, char* Text);
+
+/*!  ****************************************************************************
+@brief	Format the decoded TEDS of a sensor as text list, as GSV86readFormattedTEDSList
+--------------------------------------------------------------------------------------
+	Names and units are taken from the template definitions, enumeration texts from the
+	compiled TEDS dictionary (see GSV86extTedsDictLoad). No text file is parsed.
+
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[in]	Chan: Input channel No (1..8), read with GSV86extTedsRead
+ @param[out] *ListOut: String list. One line per entry, ending with CR LF. Format: <br>
+	Name	Value	Unit
+ @param[in] ListSize: Size of ListOut String in Bytes
+ @param[in] Code: Bits<7:0>: Flags: TEDSLISTFLG_* constants of GSV86readFormattedTEDSList.
+ 	Other bits are ignored, the list is ASCII only.
+ @return Number of lines written or GSV_ERROR if function failed, e.g. ERR_WRONG_PARAMETER if
+ ListSize is too small.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extTedsFormatList(int ComNo, int Chan, char* ListOut, int ListSize, int Code);
+
+/*!  ****************************************************************************
+@brief	Scan the sensors of all input channels of several devices at once
+--------------------------------------------------------------------------------------
+	Replaces querying GSV86getSensorPlugged and GSV86getTEDSactive channel by channel: each device
+	is queried for all 8 channels with Chan=0, and the TEDS of channels with TEDS memory are
+	identified with GSV86extTedsRead (no device access for sensors not unplugged since the last scan,
+	unless SCAN_FLAG_VERIFY_ID). Up to SCAN_THREADS_MAX devices are scanned in parallel, the commands
+	of one device are sent one after the other. Measuring value transmission is not stopped.
+	Scans of the same ComNo are never executed at the same time, also not by GSV86extScanStart.
+
+ @param[in]	ComNos: Array of Count ComNos to scan. If NULL, all ComNos attached with GSV86extAttach are scanned.
+ 	A ComNo listed more than once is scanned once.
+ @param[in]	Count: Number of elements of ComNos
+ @param[in]	flags: SCAN_FLAG_* combined by OR
+ @param[out] Info: Array receiving one SCAN_INFO per element of ComNos, in the order of ComNos
+ 	(duplicates receive the same result). May be NULL. If ComNos is NULL, its size must be EXT_COMNO_MAX.
+ @return Number of devices scanned successfully or GSV_ERROR if function failed.
+*
+ Device access: Yes, CmdNo: 0x45, 0x68, 0x65
+ ********************************************************************************** */
+int CALLTYP GSV86extScan(const int* ComNos, int Count, unsigned long flags, SCAN_INFO* Info);
+
+/*!  ****************************************************************************
+@brief	Get the result of the last scan of a ComNo
+--------------------------------------------------------------------------------------
+ @param[in]	ComNo: 	Number of Device Comport
+ @param[out] Info: Pointer to SCAN_INFO receiving the result of GSV86extScan or of the background scan
+ @return GSV_OK or GSV_ERROR if function failed, e.g. ERR_EXT_WRONG_STATE if not scanned yet.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extScanGet(int ComNo, SCAN_INFO* Info);
+
+/*!  ****************************************************************************
+@brief	Start scanning sensors periodically in a background thread
+--------------------------------------------------------------------------------------
+	Runs GSV86extScan every PeriodMs, so that sensor swaps are noticed without polling from the
+	application. Results are retrieved with GSV86extScanGet or passed to Callback on changes.
+	Only one background scan can run. Errors are reported for ComNo 0.
+
+ @param[in]	ComNos: Array of Count ComNos to scan. If NULL, the ComNos attached at each scan are scanned
+ @param[in]	Count: Number of elements of ComNos
+ @param[in]	PeriodMs: Scan period in milliseconds, >= SCAN_PERIOD_MIN_MS
+ @param[in]	flags: SCAN_FLAG_* combined by OR
+ @param[in]	Callback: Function called for each ComNo with changed sensors. May be NULL.
+ @param[in]	User: Passed to Callback
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: Yes, from the background thread, see GSV86extScan
+ ********************************************************************************** */
+int CALLTYP GSV86extScanStart(const int* ComNos, int Count, unsigned long PeriodMs, unsigned long flags,
+	EXT_SCAN_CHANGED Callback, void* User);
+
+/*!  ****************************************************************************
+@brief	Stop the background scan
+--------------------------------------------------------------------------------------
+	Waits until a scan in progress has finished.
+
+ @return Simple errorcode: GSV_OK,if successful or GSV_ERROR if function failed.
+*
+ Device access: No
+ ********************************************************************************** */
+int CALLTYP GSV86extScanStop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MEGSV86EXT_H */
@@ -0,0 +1,681 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: asynchronous command queue
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+#define ASYNC_CMD_TEDS_LIST	0x64	/* CmdNo of GSV86readFormattedTEDSList */
+#define ASYNC_TEDS_RX_BYTES	128	/* TEDS memory read for the list: 1-wire EEPROM of 1024 bits */
+#define ASYNC_CMD_FT_SELECT	0x7D	/* CmdNo of GSV86setFTarrayToRead */
+#define ASYNC_CMD_FT_READ	0x47	/* CmdNo of GSV86readFTsensorCalValue */
+#define ASYNC_CMD_FT_WRITE	0x48	/* CmdNos of GSV86writeFTsensorCalArray */
+#define ASYNC_CMD_FT_STORE	0x7F
+
+enum AsyncState
+{
+	ASYNC_PENDING,
+	ASYNC_RUNNING,
+	ASYNC_DONE
+};
+
+/* Hooks of internal jobs running several different commands, e.g. GSV86extAsyncReadFTCalArray */
+struct AsyncStepOps
+{
+	/* CmdNo and parameter bytes of the next call of Func, accounted by GSV86extCmdCall */
+	void (*NextCmd)(const void* Ctx, int* CmdNo, int* TxParBytes, int* RxParBytes);
+	/* Error code of a failed step not raised by the DLL, 0: GSV86getLastProtocollError */
+	int (*Error)(const void* Ctx);
+	/* Called before the next step if another job executed one of StateCmds since the previous
+	   step, i.e. changed the device state the steps rely on. NULL: steps are independent. */
+	void (*Interrupted)(void* Ctx);
+	const int* StateCmds;		/* ended by -1 */
+};
+
+struct AsyncJob
+{
+	int Handle;
+	int CmdNo;
+	int TxParBytes;
+	int RxParBytes;
+	EXT_CMD_FUNC Func;
+	void* Ctx;
+	void (*FreeCtx)(void* Ctx);	/* Ctx owned by the job, =NULL: owned by the application */
+	const AsyncStepOps* Ops;	/* NULL: every step is CmdNo */
+	EXT_ASYNC_DONE Done;
+	void* User;
+	int Prio;			/* ASYNC_PRIO_* */
+	AsyncState State;
+	bool Started;			/* Func was called at least once (ASYNC_CONTINUE) */
+	bool CancelReq;			/* GSV86extAsyncCancel while in execution: no further step */
+	uint64_t SubmitNs;		/* extNowNs() at submission */
+	uint64_t StepSeq;		/* AsyncQueue.Seq of the last step, =0: none yet */
+	int Result;
+	int ErrCode;
+};
+
+struct AsyncQueue
+{
+	int ComNo;
+	std::thread Thread;
+	std::mutex Lock;
+	std::condition_variable Work;		/* Pending not empty or Stop */
+	std::condition_variable Finished;	/* a job reached ASYNC_DONE */
+	std::deque<AsyncJob*> Pending[ASYNC_PRIO_NUM];	/* per priority, in order of execution */
+	std::map<int, AsyncJob*> Jobs;		/* all jobs not collected yet, by handle */
+	bool Stop;
+	int NextHandle;
+	unsigned char CmdPrio[CMD_NUM];		/* priority of each CmdNo */
+	ExtHist Wait[ASYNC_PRIO_NUM];		/* submission until first call of Func */
+	uint64_t Seq;				/* steps executed; used by the queue thread only */
+	uint64_t CmdSeq[CMD_NUM];		/* Seq of the last step of each CmdNo */
+
+	~AsyncQueue();
+};
+
+/* Queues are shared with threads waiting in GSV86extAsyncWait, which may outlive GSV86extAsyncClose */
+static std::shared_ptr<AsyncQueue> g_Async[EXT_COMNO_MAX];
+static std::mutex g_AsyncLock;
+
+static void asyncFreeJob(AsyncJob* J)
+{
+	if (J->FreeCtx)
+		J->FreeCtx(J->Ctx);
+	delete J;
+}
+
+AsyncQueue::~AsyncQueue()
+{
+	for (std::map<int, AsyncJob*>::iterator it = Jobs.begin(); it != Jobs.end(); ++it)
+		asyncFreeJob(it->second);
+}
+
+static std::shared_ptr<AsyncQueue> asyncGet(int ComNo)
+{
+	if (ComNo < 0 || ComNo >= EXT_COMNO_MAX)
+		return std::shared_ptr<AsyncQueue>();
+	std::shared_ptr<AsyncQueue> Q;
+	{
+		std::lock_guard<std::mutex> lk(g_AsyncLock);
+		Q = g_Async[ComNo];
+	}
+	if (!Q)
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+	return Q;
+}
+
+/* Priority of CmdNo if not set with GSV86extAsyncSetPriority */
+static int asyncDefaultPrio(int CmdNo)
+{
+	switch (CmdNo)
+	{
+	case 0x0C:	/* GSV86setZero */
+	case 0x3B:	/* GSV86triggerValue */
+	case 0x3C:	/* GSV86clearMaxMinValue */
+		return ASYNC_PRIO_HIGH;
+	case 0x47:	/* FT sensor calibration read */
+	case 0x48:	/* FT sensor calibration write */
+	case 0x7F:	/* FT sensor calibration store / erase */
+	case 0x64:	/* TEDS entries */
+	case 0x65:	/* TEDS raw data read */
+	case 0x66:	/* TEDS raw data write */
+	case 0x67:
+		return ASYNC_PRIO_LOW;
+	default:
+		return ASYNC_PRIO_NORMAL;
+	}
+}
+
+/* Next job to execute, highest priority first, with Q->Lock held */
+static AsyncJob* asyncNext(AsyncQueue* Q)
+{
+	for (int p = ASYNC_PRIO_NUM - 1; p >= 0; p--)
+		if (!Q->Pending[p].empty())
+		{
+			AsyncJob* J = Q->Pending[p].front();
+			Q->Pending[p].pop_front();
+			return J;
+		}
+	return NULL;
+}
+
+/* Complete J outside of Q->Lock. Jobs with completion function are released here. */
+static void asyncFinish(AsyncQueue* Q, AsyncJob* J, int Result, int ErrCode)
+{
+	if (J->Done)
+	{
+		{
+			std::lock_guard<std::mutex> lk(Q->Lock);
+			Q->Jobs.erase(J->Handle);
+		}
+		J->Done(Q->ComNo, J->Handle, Result, ErrCode, J->User);
+		asyncFreeJob(J);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lk(Q->Lock);
+		J->Result = Result;
+		J->ErrCode = ErrCode;
+		J->State = ASYNC_DONE;
+	}
+	Q->Finished.notify_all();
+}
+
+static void asyncThread(AsyncQueue* Q)
+{
+	for (;;)
+	{
+		AsyncJob* J = NULL;
+		{
+			std::unique_lock<std::mutex> lk(Q->Lock);
+			while (!Q->Stop && !(J = asyncNext(Q)))
+				Q->Work.wait(lk);
+			if (Q->Stop)
+				break;	/* J is NULL, pending jobs are cancelled by GSV86extAsyncClose */
+			J->State = ASYNC_RUNNING;
+		}
+		if (!J->Started)
+		{
+			J->Started = true;
+			extHistAdd(&Q->Wait[J->Prio], extNowNs() - J->SubmitNs);
+		}
+		if (J->Ops && J->Ops->Interrupted && J->StepSeq)
+			for (const int* c = J->Ops->StateCmds; *c >= 0; c++)
+				if (Q->CmdSeq[*c] > J->StepSeq)
+				{
+					J->Ops->Interrupted(J->Ctx);
+					break;
+				}
+		if (J->Ops)
+			J->Ops->NextCmd(J->Ctx, &J->CmdNo, &J->TxParBytes, &J->RxParBytes);
+		int ret = GSV86extCmdCall(Q->ComNo, J->CmdNo, J->TxParBytes, J->RxParBytes, J->Func, J->Ctx);
+		J->StepSeq = Q->CmdSeq[J->CmdNo] = ++Q->Seq;
+		if (ret == ASYNC_CONTINUE)
+		{
+			/* Commands can't be interrupted; a step of a longer transfer is the point where
+			   commands of higher priority get ahead. Same priority: this job continues first. */
+			std::lock_guard<std::mutex> lk(Q->Lock);
+			if (!Q->Stop && !J->CancelReq)
+			{
+				J->State = ASYNC_PENDING;
+				Q->Pending[J->Prio].push_front(J);
+				continue;
+			}
+		}
+		if (ret == ASYNC_CONTINUE)
+			asyncFinish(Q, J, GSV_ERROR, ERR_EXT_CANCELLED);
+		else
+		{
+			int err = 0;
+			if (ret == GSV_ERROR)
+			{
+				err = J->Ops ? J->Ops->Error(J->Ctx) : 0;
+				if (!err)
+					err = GSV86getLastProtocollError(Q->ComNo);
+			}
+			asyncFinish(Q, J, ret, err);
+		}
+	}
+}
+
+int CALLTYP GSV86extAsyncOpen(int ComNo)
+{
+	if (ComNo < 0 || ComNo >= EXT_COMNO_MAX)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(g_AsyncLock);
+	if (g_Async[ComNo])
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	std::shared_ptr<AsyncQueue> Q;
+	try
+	{
+		Q = std::make_shared<AsyncQueue>();
+		Q->ComNo = ComNo;
+		Q->Stop = false;
+		Q->NextHandle = 1;
+		for (int c = 0; c < CMD_NUM; c++)
+			Q->CmdPrio[c] = (unsigned char)asyncDefaultPrio(c);
+		for (int p = 0; p < ASYNC_PRIO_NUM; p++)
+			extHistClear(&Q->Wait[p]);
+		Q->Thread = std::thread(asyncThread, Q.get());
+	}
+	catch (...)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	g_Async[ComNo] = Q;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extAsyncClose(int ComNo)
+{
+	std::shared_ptr<AsyncQueue> Q;
+	if (ComNo < 0 || ComNo >= EXT_COMNO_MAX)
+		return GSV_ERROR;
+	{
+		std::lock_guard<std::mutex> lk(g_AsyncLock);
+		Q.swap(g_Async[ComNo]);
+	}
+	if (!Q)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	std::deque<AsyncJob*> cancelled;
+	{
+		std::lock_guard<std::mutex> lk(Q->Lock);
+		Q->Stop = true;
+		for (int p = ASYNC_PRIO_NUM - 1; p >= 0; p--)
+		{
+			cancelled.insert(cancelled.end(), Q->Pending[p].begin(), Q->Pending[p].end());
+			Q->Pending[p].clear();
+		}
+		for (size_t i = 0; i < cancelled.size(); i++)
+			cancelled[i]->State = ASYNC_RUNNING;
+	}
+	Q->Work.notify_all();
+	if (Q->Thread.joinable())
+		Q->Thread.join();
+	for (size_t i = 0; i < cancelled.size(); i++)
+		asyncFinish(Q.get(), cancelled[i], GSV_ERROR, ERR_EXT_CANCELLED);
+	return GSV_OK;
+}
+
+static int asyncSubmit(int ComNo, int CmdNo, int TxParBytes, int RxParBytes, EXT_CMD_FUNC Func, void* Ctx,
+	void (*FreeCtx)(void*), const AsyncStepOps* Ops, EXT_ASYNC_DONE Done, void* User)
+{
+	std::shared_ptr<AsyncQueue> Q = asyncGet(ComNo);
+	if (!Q)
+		return GSV_ERROR;
+	if (CmdNo < 0 || CmdNo >= CMD_NUM || !Func)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	AsyncJob* J = new (std::nothrow) AsyncJob();
+	if (!J)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	J->CmdNo = CmdNo;
+	J->TxParBytes = TxParBytes;
+	J->RxParBytes = RxParBytes;
+	J->Func = Func;
+	J->Ctx = Ctx;
+	J->FreeCtx = FreeCtx;
+	J->Ops = Ops;
+	J->Done = Done;
+	J->User = User;
+	J->State = ASYNC_PENDING;
+	J->SubmitNs = extNowNs();
+	int handle;
+	{
+		std::lock_guard<std::mutex> lk(Q->Lock);
+		if (Q->Jobs.size() >= ASYNC_QUEUE_MAX)
+		{
+			delete J;
+			extSetError(ComNo, ERR_EXT_NO_RESOURCE);
+			return GSV_ERROR;
+		}
+		/* handles are unique among the jobs not collected yet */
+		while (Q->Jobs.count(Q->NextHandle))
+			Q->NextHandle = Q->NextHandle == 0x7FFFFFFF ? 1 : Q->NextHandle + 1;
+		J->Handle = handle = Q->NextHandle;
+		J->Prio = Q->CmdPrio[CmdNo];
+		Q->NextHandle = Q->NextHandle == 0x7FFFFFFF ? 1 : Q->NextHandle + 1;
+		try
+		{
+			Q->Jobs[J->Handle] = J;
+			Q->Pending[J->Prio].push_back(J);
+		}
+		catch (...)
+		{
+			Q->Jobs.erase(J->Handle);
+			delete J;
+			extSetError(ComNo, ERR_MEM_ALLOC);
+			return GSV_ERROR;
+		}
+	}
+	Q->Work.notify_one();
+	return handle;	/* J may be completed and released already */
+}
+
+int CALLTYP GSV86extAsyncSubmit(int ComNo, int CmdNo, int TxParBytes, int RxParBytes, EXT_CMD_FUNC Func, void* Ctx,
+	EXT_ASYNC_DONE Done, void* User)
+{
+	return asyncSubmit(ComNo, CmdNo, TxParBytes, RxParBytes, Func, Ctx, NULL, NULL, Done, User);
+}
+
+struct AsyncTedsList
+{
+	int Chan;
+	std::string Path;
+	char* ListOut;
+	int ListSize;
+	int Code;
+	char* ExtListOut;
+};
+
+static int CALLTYP asyncTedsListFunc(int ComNo, void* Ctx)
+{
+	AsyncTedsList* T = (AsyncTedsList*)Ctx;
+	return GSV86readFormattedTEDSList(ComNo, T->Chan, T->Path.c_str(), T->ListOut, T->ListSize, T->Code, T->ExtListOut);
+}
+
+static void asyncTedsListFree(void* Ctx)
+{
+	delete (AsyncTedsList*)Ctx;
+}
+
+int CALLTYP GSV86extAsyncReadTEDSList(int ComNo, int Chan, const char* TEDSfilePath, char* ListOut, int ListSize,
+	int Code, char* ExtListOut, EXT_ASYNC_DONE Done, void* User)
+{
+	if (!TEDSfilePath || !ListOut || ListSize <= 0)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	AsyncTedsList* T = new (std::nothrow) AsyncTedsList();
+	if (!T)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	try
+	{
+		T->Path = TEDSfilePath;
+	}
+	catch (...)
+	{
+		delete T;
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	T->Chan = Chan;
+	T->ListOut = ListOut;
+	T->ListSize = ListSize;
+	T->Code = Code;
+	T->ExtListOut = ExtListOut;
+	int h = asyncSubmit(ComNo, ASYNC_CMD_TEDS_LIST, 0, ASYNC_TEDS_RX_BYTES, asyncTedsListFunc, T, asyncTedsListFree, NULL,
+		Done, User);
+	if (h == GSV_ERROR)
+		delete T;
+	return h;
+}
+
+/* GSV86readFTsensorCalArray in steps of one value */
+struct AsyncFTCal
+{
+	int ArrNo;
+	int Step;			/* 0: select array, then one value per step, see asyncFTCalValue */
+	bool Reselect;			/* another job may have selected another array: select again first */
+	int Err;			/* error code of a failed step not raised by the DLL */
+	char* SensorSerNo;		/* ASYNC_FT_SERNO_SIZE characters */
+	double* MatrixNorm;
+	double* InSens;
+	double* Matrix;
+	double* Offsets;
+	double* MaxVals;
+	double* Zvals;
+};
+
+#define ASYNC_FT_SERNO_SIZE	9		/* 8 digits and terminating 0, see GSV86readFTsensorCalArray */
+#define ASYNC_FT_SERNO_MAX	99999999UL
+#define ASYNC_FT_VALUES	(2 + SENSORCAL_MATRIX_SIZE + SENSORCAL_OFFSET_SIZE + SENSORCAL_MAXVAL_SIZE + SENSORCAL_VECTOR_SIZE + 1)
+
+/* Type, index and destination of value number n, 0..ASYNC_FT_VALUES-1 */
+static double* asyncFTCalValue(AsyncFTCal* F, int n, int* typ, int* ix)
+{
+	static const struct { int Typ; int Size; } order[] = {
+		{ SENSORCAL_TYP_MATRIX_NORM, 1 },
+		{ SENSORCAL_TYP_INSENS, 1 },
+		{ SENSORCAL_TYP_MATRIX, SENSORCAL_MATRIX_SIZE },
+		{ SENSORCAL_TYP_OFFSET, SENSORCAL_OFFSET_SIZE },
+		{ SENSORCAL_TYP_MAXVAL, SENSORCAL_MAXVAL_SIZE },
+		{ SENSORCAL_TYP_ZEROVAL, SENSORCAL_VECTOR_SIZE },
+		{ SENSORCAL_TYP_SERNO, 1 }
+	};
+	double* dst[] = { F->MatrixNorm, F->InSens, F->Matrix, F->Offsets, F->MaxVals, F->Zvals, NULL };
+	int k = 0;
+	while (n >= order[k].Size)
+		n -= order[k++].Size;
+	*typ = order[k].Typ;
+	*ix = order[k].Typ == SENSORCAL_TYP_SERNO ? 0 : n;
+	return dst[k] ? dst[k] + n : NULL;
+}
+
+static int CALLTYP asyncFTCalFunc(int ComNo, void* Ctx)
+{
+	AsyncFTCal* F = (AsyncFTCal*)Ctx;
+	if (F->Step == 0 || F->Reselect)
+	{
+		if (GSV86setFTarrayToRead(ComNo, F->ArrNo) == GSV_ERROR)
+			return GSV_ERROR;
+		if (F->Step == 0)
+			F->Step++;
+		F->Reselect = false;
+		return ASYNC_CONTINUE;
+	}
+	int typ, ix;
+	double v = 0;
+	double* dst = asyncFTCalValue(F, F->Step - 1, &typ, &ix);
+	if (GSV86readFTsensorCalValue(ComNo, typ, ix, &v) == GSV_ERROR)
+		return GSV_ERROR;
+	if (dst)
+		*dst = v;
+	else
+	{
+		/* u32, see SENSORCAL_TYP_SERNO, but SensorSerNo holds 8 digits only */
+		if (!(v >= 0 && v <= (double)ASYNC_FT_SERNO_MAX))
+		{
+			F->Err = ERR_UNKNOWN_VALUE;
+			return GSV_ERROR;
+		}
+		snprintf(F->SensorSerNo, ASYNC_FT_SERNO_SIZE, "%08lu", (unsigned long)v);
+	}
+	return ++F->Step <= ASYNC_FT_VALUES ? ASYNC_CONTINUE : GSV_OK;
+}
+
+static void asyncFTCalNextCmd(const void* Ctx, int* CmdNo, int* TxParBytes, int* RxParBytes)
+{
+	/* step 0 selects the array, all others read one float value */
+	const AsyncFTCal* F = (const AsyncFTCal*)Ctx;
+	const bool sel = F->Step == 0 || F->Reselect;
+	*CmdNo = sel ? ASYNC_CMD_FT_SELECT : ASYNC_CMD_FT_READ;
+	*TxParBytes = sel ? 1 : 2;
+	*RxParBytes = sel ? 0 : 4;
+}
+
+static int asyncFTCalError(const void* Ctx)
+{
+	return ((const AsyncFTCal*)Ctx)->Err;
+}
+
+static void asyncFTCalInterrupted(void* Ctx)
+{
+	((AsyncFTCal*)Ctx)->Reselect = true;
+}
+
+/* the array selected by the device may be changed by any other command on FT calibration arrays */
+static const int g_FTCalStateCmds[] = { ASYNC_CMD_FT_SELECT, ASYNC_CMD_FT_READ, ASYNC_CMD_FT_WRITE, ASYNC_CMD_FT_STORE, -1 };
+static const AsyncStepOps g_FTCalOps = { asyncFTCalNextCmd, asyncFTCalError, asyncFTCalInterrupted, g_FTCalStateCmds };
+
+static void asyncFTCalFree(void* Ctx)
+{
+	delete (AsyncFTCal*)Ctx;
+}
+
+int CALLTYP GSV86extAsyncReadFTCalArray(int ComNo, int ArrNo, char* SensorSerNo, double* MatrixNorm, double* InSens,
+	double* Matrix, double* Offsets, double* MaxVals, double* Zvals, EXT_ASYNC_DONE Done, void* User)
+{
+	if (!SensorSerNo || !MatrixNorm || !InSens || !Matrix || !Offsets || !MaxVals || !Zvals)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	AsyncFTCal* F = new (std::nothrow) AsyncFTCal();
+	if (!F)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	F->ArrNo = ArrNo;
+	F->SensorSerNo = SensorSerNo;
+	F->MatrixNorm = MatrixNorm;
+	F->InSens = InSens;
+	F->Matrix = Matrix;
+	F->Offsets = Offsets;
+	F->MaxVals = MaxVals;
+	F->Zvals = Zvals;
+	/* one float value per answer; the priority is the one of ASYNC_CMD_FT_READ */
+	int h = asyncSubmit(ComNo, ASYNC_CMD_FT_READ, 2, 4, asyncFTCalFunc, F, asyncFTCalFree, &g_FTCalOps, Done, User);
+	if (h == GSV_ERROR)
+		delete F;
+	return h;
+}
+
+/* Job of Handle without completion function, with Q->Lock held */
+static AsyncJob* asyncFind(AsyncQueue* Q, int Handle)
+{
+	std::map<int, AsyncJob*>::iterator it = Q->Jobs.find(Handle);
+	if (it == Q->Jobs.end() || it->second->Done)
+	{
+		extSetError(Q->ComNo, ERR_EXT_WRONG_HANDLE);
+		return NULL;
+	}
+	return it->second;
+}
+
+/* Copy the result of a completed job and release it, with Q->Lock held */
+static void asyncCollect(AsyncQueue* Q, AsyncJob* J, int* Result, int* ErrCode)
+{
+	*Result = J->Result;
+	if (ErrCode)
+		*ErrCode = J->ErrCode;
+	Q->Jobs.erase(J->Handle);
+	asyncFreeJob(J);
+}
+
+int CALLTYP GSV86extAsyncPoll(int ComNo, int Handle, int* Result, int* ErrCode)
+{
+	std::shared_ptr<AsyncQueue> Q = asyncGet(ComNo);
+	if (!Q)
+		return GSV_ERROR;
+	if (!Result)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(Q->Lock);
+	AsyncJob* J = asyncFind(Q.get(), Handle);
+	if (!J)
+		return GSV_ERROR;
+	if (J->State != ASYNC_DONE)
+		return GSV_OK;
+	asyncCollect(Q.get(), J, Result, ErrCode);
+	return GSV_TRUE;
+}
+
+int CALLTYP GSV86extAsyncWait(int ComNo, int Handle, unsigned long TimeoutMs, int* Result, int* ErrCode)
+{
+	std::shared_ptr<AsyncQueue> Q = asyncGet(ComNo);
+	if (!Q)
+		return GSV_ERROR;
+	if (!Result)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::unique_lock<std::mutex> lk(Q->Lock);
+	const bool infinite = TimeoutMs == ASYNC_WAIT_INFINITE;
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now()
+		+ std::chrono::milliseconds(infinite ? 0 : TimeoutMs);
+	for (;;)
+	{
+		/* looked up again after each wakeup: another thread may have collected it meanwhile */
+		AsyncJob* J = asyncFind(Q.get(), Handle);
+		if (!J)
+			return GSV_ERROR;
+		if (J->State == ASYNC_DONE)
+		{
+			asyncCollect(Q.get(), J, Result, ErrCode);
+			return GSV_TRUE;
+		}
+		if (infinite)
+			Q->Finished.wait(lk);
+		else if (Q->Finished.wait_until(lk, end) == std::cv_status::timeout && J->State != ASYNC_DONE)
+			return GSV_OK;
+	}
+}
+
+int CALLTYP GSV86extAsyncCancel(int ComNo, int Handle)
+{
+	std::shared_ptr<AsyncQueue> Q = asyncGet(ComNo);
+	if (!Q)
+		return GSV_ERROR;
+	AsyncJob* J = NULL;
+	{
+		std::lock_guard<std::mutex> lk(Q->Lock);
+		std::map<int, AsyncJob*>::iterator it = Q->Jobs.find(Handle);
+		if (it == Q->Jobs.end())
+		{
+			extSetError(ComNo, ERR_EXT_WRONG_HANDLE);
+			return GSV_ERROR;
+		}
+		if (it->second->State != ASYNC_PENDING)
+		{
+			it->second->CancelReq = true;
+			return GSV_OK;
+		}
+		J = it->second;
+		std::deque<AsyncJob*>& pend = Q->Pending[J->Prio];
+		for (std::deque<AsyncJob*>::iterator p = pend.begin(); p != pend.end(); ++p)
+			if (*p == J)
+			{
+				pend.erase(p);
+				break;
+			}
+		J->State = ASYNC_RUNNING;	/* completed below, not cancelled twice */
+	}
+	asyncFinish(Q.get(), J, GSV_ERROR, ERR_EXT_CANCELLED);
+	return GSV_TRUE;
+}
+
+int CALLTYP GSV86extAsyncSetPriority(int ComNo, int CmdNo, int Prio)
+{
+	std::shared_ptr<AsyncQueue> Q = asyncGet(ComNo);
+	if (!Q)
+		return GSV_ERROR;
+	if (CmdNo < 0 || CmdNo >= CMD_NUM || Prio < ASYNC_PRIO_LOW || Prio > ASYNC_PRIO_HIGH)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(Q->Lock);
+	Q->CmdPrio[CmdNo] = (unsigned char)Prio;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extAsyncGetWait(int ComNo, int Prio, STATS_LATENCY* Stats)
+{
+	std::shared_ptr<AsyncQueue> Q = asyncGet(ComNo);
+	if (!Q)
+		return GSV_ERROR;
+	if (Prio < ASYNC_PRIO_LOW || Prio > ASYNC_PRIO_HIGH || !Stats)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	extHistSummary(&Q->Wait[Prio], Stats);
+	return GSV_OK;
+}
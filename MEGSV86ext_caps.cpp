@@ -0,0 +1,316 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: capability cache
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <cstdio>
+#include <cstring>
+
+#define CAPS_SPLIT_MIN	4	/* ranges up to this size are checked per CmdNo, not split further */
+
+/* Runs of the CmdNos used by MEGSV86xx.DLL ("Device access" of its functions). Only these are
+   probed: GSV86getIsCmdAvailable succeeds for a range only if all its commands are available and
+   fails with ERR_CMD_NOTKNOWN/ERR_CMD_NOTIMPL otherwise, so a range containing unused CmdNos
+   would be split down to single commands. */
+static const struct { unsigned char Lo, Hi; } g_CapsRuns[] = {
+	{ 0x00, 0x0A }, { 0x0C, 0x12 }, { 0x14, 0x15 }, { 0x19, 0x1A }, { 0x1F, 0x1F }, { 0x23, 0x27 },
+	{ 0x2A, 0x2B }, { 0x35, 0x36 }, { 0x3B, 0x3C }, { 0x42, 0x45 }, { 0x47, 0x49 }, { 0x4B, 0x4B },
+	{ 0x4D, 0x68 }, { 0x7B, 0x81 }, { 0x8A, 0x8D }, { 0x90, 0x95 }, { 0x9A, 0x9B }, { 0xA2, 0xA3 }
+};
+
+struct CapsEntry
+{
+	int SerNo;
+	int Firmware;
+	int SwConfig;			/* GSV86getSoftwareConfiguration */
+	uint32_t Avail[CAPS_BITMAP_WORDS];	/* bit CmdNo%32 of word CmdNo/32: command available */
+};
+
+static std::vector<CapsEntry> g_Caps;		/* by serial number and firmware version */
+static int g_CapsCom[EXT_COMNO_MAX];		/* index into g_Caps + 1 of the device at ComNo, =0: not probed */
+static std::mutex g_CapsLock;
+
+static bool capsComNoValid(int ComNo)
+{
+	return ComNo >= 0 && ComNo < EXT_COMNO_MAX;
+}
+
+/* Index of the entry of SerNo/Firmware or -1, with g_CapsLock held */
+static int capsFind(int SerNo, int Firmware)
+{
+	for (size_t i = 0; i < g_Caps.size(); i++)
+		if (g_Caps[i].SerNo == SerNo && g_Caps[i].Firmware == Firmware)
+			return (int)i;
+	return -1;
+}
+
+/* Store E, replacing an entry of the same device. Returns the index or -1, with g_CapsLock held. */
+static int capsStore(const CapsEntry& E)
+{
+	int i = capsFind(E.SerNo, E.Firmware);
+	if (i >= 0)
+	{
+		g_Caps[(size_t)i] = E;
+		return i;
+	}
+	try
+	{
+		g_Caps.push_back(E);
+	}
+	catch (...)
+	{
+		return -1;
+	}
+	return (int)g_Caps.size() - 1;
+}
+
+static void capsSet(CapsEntry* E, int Lo, int Hi)
+{
+	for (int c = Lo; c <= Hi; c++)
+		E->Avail[c >> 5] |= 1UL << (c & 31);
+}
+
+/* GSV86getIsCmdAvailable failed because a command of the range is missing, not for another reason */
+static bool capsCmdMissing(int ComNo)
+{
+	const int err = GSV86getLastProtocollError(ComNo);
+	return err == (ERR_MSK_DEVICE | ERR_CMD_NOTKNOWN) || err == (ERR_MSK_DEVICE | ERR_CMD_NOTIMPL);
+}
+
+/* Check CmdNos Lo..Hi with one request for the whole range; ranges not available as a whole
+   are split in halves, so a run available completely costs one round trip.
+   Returns false if the device could not be asked (error of the DLL left for extSetDllError). */
+static bool capsProbeRange(int ComNo, CapsEntry* E, int Lo, int Hi, int* Queries)
+{
+	int r = GSV86getIsCmdAvailable(ComNo, Hi, Lo);
+	(*Queries)++;
+	if (r != GSV_ERROR)
+	{
+		capsSet(E, Lo, Hi);
+		return true;
+	}
+	if (!capsCmdMissing(ComNo))
+		return false;
+	if (Lo == Hi)
+		return true;
+	if (Hi - Lo + 1 <= CAPS_SPLIT_MIN)
+	{
+		for (int c = Lo; c <= Hi; c++)
+			if (!capsProbeRange(ComNo, E, c, c, Queries))
+				return false;
+		return true;
+	}
+	int mid = Lo + (Hi - Lo) / 2;
+	return capsProbeRange(ComNo, E, Lo, mid, Queries) && capsProbeRange(ComNo, E, mid + 1, Hi, Queries);
+}
+
+int CALLTYP GSV86extCapsProbe(int ComNo, unsigned long flags, int* Queries)
+{
+	if (!capsComNoValid(ComNo))
+		return GSV_ERROR;
+	int q = 2;
+	CapsEntry E;
+	memset(&E, 0, sizeof(E));
+	E.SerNo = GSV86getSerialNo(ComNo);
+	E.Firmware = E.SerNo == GSV_ERROR ? GSV_ERROR : GSV86firmwareVersion(ComNo);
+	if (E.SerNo == GSV_ERROR || E.Firmware == GSV_ERROR)
+	{
+		extSetDllError(ComNo);
+		return GSV_ERROR;
+	}
+	if (!(flags & CAPS_FLAG_REFRESH))
+	{
+		std::lock_guard<std::mutex> lk(g_CapsLock);
+		int i = capsFind(E.SerNo, E.Firmware);
+		if (i >= 0)
+		{
+			g_CapsCom[ComNo] = i + 1;
+			if (Queries)
+				*Queries = q;
+			return GSV_OK;
+		}
+	}
+	E.SwConfig = GSV86getSoftwareConfiguration(ComNo);
+	q++;
+	bool ok = E.SwConfig != GSV_ERROR;
+	for (size_t r = 0; r < sizeof(g_CapsRuns) / sizeof(g_CapsRuns[0]) && ok; r++)
+		ok = capsProbeRange(ComNo, &E, g_CapsRuns[r].Lo, g_CapsRuns[r].Hi, &q);
+	if (!ok)
+	{
+		extSetDllError(ComNo);
+		return GSV_ERROR;
+	}
+	if (Queries)
+		*Queries = q;
+	std::lock_guard<std::mutex> lk(g_CapsLock);
+	int i = capsStore(E);
+	if (i < 0)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	g_CapsCom[ComNo] = i + 1;
+	return GSV_TRUE;
+}
+
+/* Entry of the device at ComNo, with g_CapsLock held */
+static const CapsEntry* capsGet(int ComNo)
+{
+	if (!capsComNoValid(ComNo))
+		return NULL;
+	if (!g_CapsCom[ComNo])
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return NULL;
+	}
+	return &g_Caps[(size_t)g_CapsCom[ComNo] - 1];
+}
+
+int CALLTYP GSV86extCapsIsCmdAvailable(int ComNo, int CmdUp, int CmdLo)
+{
+	std::lock_guard<std::mutex> lk(g_CapsLock);
+	const CapsEntry* E = capsGet(ComNo);
+	if (!E)
+		return GSV_ERROR;
+	if (CmdLo < 0 || CmdUp >= CMD_NUM || CmdLo > CmdUp)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	for (int c = CmdLo; c <= CmdUp; c++)
+		if (!(E->Avail[c >> 5] & (1UL << (c & 31))))
+			return GSV_OK;
+	return GSV_TRUE;
+}
+
+int CALLTYP GSV86extCapsGetSoftwareConfiguration(int ComNo)
+{
+	std::lock_guard<std::mutex> lk(g_CapsLock);
+	const CapsEntry* E = capsGet(ComNo);
+	return E ? E->SwConfig : GSV_ERROR;
+}
+
+int CALLTYP GSV86extCapsGetBitmap(int ComNo, unsigned long* Bitmap)
+{
+	if (!Bitmap)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(g_CapsLock);
+	const CapsEntry* E = capsGet(ComNo);
+	if (!E)
+		return GSV_ERROR;
+	for (int w = 0; w < CAPS_BITMAP_WORDS; w++)
+		Bitmap[w] = E->Avail[w];
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extCapsInvalidate(int ComNo)
+{
+	std::lock_guard<std::mutex> lk(g_CapsLock);
+	if (ComNo == -1)
+	{
+		memset(g_CapsCom, 0, sizeof(g_CapsCom));
+		return GSV_OK;
+	}
+	if (!capsComNoValid(ComNo))
+		return GSV_ERROR;
+	g_CapsCom[ComNo] = 0;
+	return GSV_OK;
+}
+
+/* File format: one line per device, "SerNo Firmware SwConfig" and CAPS_BITMAP_WORDS words, all hexadecimal */
+int CALLTYP GSV86extCapsSave(const char* Path)
+{
+	if (!Path)
+	{
+		extSetError(0, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	FILE* f = fopen(Path, "w");
+	if (!f)
+	{
+		extSetError(0, ERR_EXT_FILE_OPEN);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(g_CapsLock);
+	bool ok = true;
+	for (size_t i = 0; i < g_Caps.size() && ok; i++)
+	{
+		const CapsEntry& E = g_Caps[i];
+		ok = fprintf(f, "%08X %08X %08X", (unsigned)E.SerNo, (unsigned)E.Firmware, (unsigned)E.SwConfig) > 0;
+		for (int w = 0; w < CAPS_BITMAP_WORDS && ok; w++)
+			ok = fprintf(f, " %08lX", (unsigned long)E.Avail[w]) > 0;
+		ok = ok && fputc('\n', f) != EOF;
+	}
+	ok = fclose(f) == 0 && ok;
+	if (!ok)
+	{
+		extSetError(0, ERR_EXT_FILE_OPEN);
+		return GSV_ERROR;
+	}
+	return (int)g_Caps.size();
+}
+
+int CALLTYP GSV86extCapsLoad(const char* Path)
+{
+	if (!Path)
+	{
+		extSetError(0, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	FILE* f = fopen(Path, "r");
+	if (!f)
+	{
+		extSetError(0, ERR_EXT_FILE_OPEN);
+		return GSV_ERROR;
+	}
+	std::vector<CapsEntry> loaded;
+	bool ok = true;
+	for (;;)
+	{
+		CapsEntry E;
+		unsigned ser, fw, sw;
+		int n = fscanf(f, "%x %x %x", &ser, &fw, &sw);
+		if (n == EOF)
+			break;
+		ok = n == 3;
+		for (int w = 0; w < CAPS_BITMAP_WORDS && ok; w++)
+		{
+			unsigned long v;
+			ok = fscanf(f, "%lx", &v) == 1;
+			E.Avail[w] = (uint32_t)v;
+		}
+		if (!ok)
+			break;
+		E.SerNo = (int)ser;
+		E.Firmware = (int)fw;
+		E.SwConfig = (int)sw;
+		try
+		{
+			loaded.push_back(E);
+		}
+		catch (...)
+		{
+			fclose(f);
+			extSetError(0, ERR_MEM_ALLOC);
+			return GSV_ERROR;
+		}
+	}
+	fclose(f);
+	if (!ok)
+	{
+		extSetError(0, ERR_FILE_CONTENT);
+		return GSV_ERROR;
+	}
+	/* entries probed in this process are kept: they are at least as recent */
+	std::lock_guard<std::mutex> lk(g_CapsLock);
+	for (size_t i = 0; i < loaded.size(); i++)
+		if (capsFind(loaded[i].SerNo, loaded[i].Firmware) < 0 && capsStore(loaded[i]) < 0)
+		{
+			extSetError(0, ERR_MEM_ALLOC);
+			return GSV_ERROR;
+		}
+	return (int)loaded.size();
+}
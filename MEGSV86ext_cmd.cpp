@@ -0,0 +1,287 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: device command accounting
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <cstring>
+
+struct CmdEntry
+{
+	std::atomic<uint64_t> Calls;
+	std::atomic<uint64_t> Errors;
+	std::atomic<uint64_t> Timeouts;
+	std::atomic<uint64_t> Retries;
+	std::atomic<uint64_t> TxBytes;
+	std::atomic<uint64_t> RxBytes;
+	std::atomic<ExtHist*> Rtt;	/* created at first use of the CmdNo */
+};
+
+/* Accounting of one ComNo. Counters are atomic, since commands may be issued from several threads. */
+struct CmdTable
+{
+	std::atomic<bool> Active;
+	std::atomic<int> Retries;
+	CmdEntry Cmd[CMD_NUM];
+	uint64_t StartNs;		/* extNowNs() at enabling */
+	uint64_t StartFrames;		/* FrameCount of the attached device at enabling */
+	std::atomic<uint64_t> RxTotal;	/* answer bytes of all CmdNos */
+};
+
+static CmdTable* g_Cmd[EXT_COMNO_MAX];
+static std::mutex g_CmdLock;
+
+static bool cmdComNoValid(int ComNo)
+{
+	return ComNo >= 0 && ComNo < EXT_COMNO_MAX;
+}
+
+/* Table of ComNo, created on first use. Tables live until the library is unloaded,
+   so accounting needs no lock. */
+static CmdTable* cmdTable(int ComNo)
+{
+	CmdTable* T;
+	{
+		std::lock_guard<std::mutex> lk(g_CmdLock);
+		T = g_Cmd[ComNo];
+		if (!T)
+			T = g_Cmd[ComNo] = new (std::nothrow) CmdTable();
+	}
+	if (!T)
+		extSetError(ComNo, ERR_MEM_ALLOC);
+	return T;
+}
+
+static ExtHist* cmdRtt(CmdEntry* E)
+{
+	ExtHist* H = E->Rtt.load(std::memory_order_acquire);
+	if (H)
+		return H;
+	ExtHist* n = new (std::nothrow) ExtHist();
+	if (!n)
+		return NULL;
+	extHistClear(n);
+	if (E->Rtt.compare_exchange_strong(H, n, std::memory_order_acq_rel))
+		return n;
+	delete n;	/* other thread was faster */
+	return H;
+}
+
+/* Account one attempt */
+static void cmdAccount(CmdTable* T, int CmdNo, int TxParBytes, int RxParBytes, uint64_t Ns, bool Timeout)
+{
+	CmdEntry* E = &T->Cmd[CmdNo];
+	const uint64_t tx = (uint64_t)(PLAN_FRAME_OVERHEAD + (TxParBytes > 0 ? TxParBytes : 0));
+	/* no answer frame after a timeout */
+	const uint64_t rx = Timeout ? 0 : (uint64_t)(PLAN_FRAME_OVERHEAD + (RxParBytes > 0 ? RxParBytes : 0));
+	E->TxBytes.fetch_add(tx, std::memory_order_relaxed);
+	E->RxBytes.fetch_add(rx, std::memory_order_relaxed);
+	T->RxTotal.fetch_add(rx, std::memory_order_relaxed);
+	if (Timeout)
+		E->Timeouts.fetch_add(1, std::memory_order_relaxed);
+	ExtHist* H = cmdRtt(E);
+	if (H)
+		extHistAdd(H, Ns);
+}
+
+static bool cmdIsTimeout(int ComNo, int Result)
+{
+	return Result == GSV_ERROR && GSV86getLastProtocollError(ComNo) == ERR_NO_GSV_ANSWER;
+}
+
+int CALLTYP GSV86extCmdStatsEnable(int ComNo, int OnOff, int Retries)
+{
+	if (!cmdComNoValid(ComNo))
+		return GSV_ERROR;
+	if (Retries < 0 || Retries > CMD_RETRY_MAX)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	CmdTable* T = cmdTable(ComNo);
+	if (!T)
+		return GSV_ERROR;
+	T->Retries.store(Retries);
+	if (!OnOff)
+	{
+		T->Active.store(false);
+		return GSV_OK;
+	}
+	T->Active.store(false);
+	for (int c = 0; c < CMD_NUM; c++)
+	{
+		CmdEntry* E = &T->Cmd[c];
+		E->Calls.store(0);
+		E->Errors.store(0);
+		E->Timeouts.store(0);
+		E->Retries.store(0);
+		E->TxBytes.store(0);
+		E->RxBytes.store(0);
+		ExtHist* H = E->Rtt.load();
+		if (H)
+			extHistClear(H);
+	}
+	T->RxTotal.store(0);
+	ExtDeviceRef dev = extFindDevice(ComNo);
+	T->StartFrames = dev ? dev->FrameCount.load(std::memory_order_acquire) : 0;
+	T->StartNs = extNowNs();
+	T->Active.store(true, std::memory_order_release);
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extCmdCall(int ComNo, int CmdNo, int TxParBytes, int RxParBytes, EXT_CMD_FUNC Func, void* Ctx)
+{
+	if (!cmdComNoValid(ComNo))
+		return GSV_ERROR;
+	if (CmdNo < 0 || CmdNo >= CMD_NUM || !Func)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	CmdTable* T;
+	{
+		std::lock_guard<std::mutex> lk(g_CmdLock);
+		T = g_Cmd[ComNo];
+	}
+	const bool acc = T && T->Active.load(std::memory_order_acquire);
+	const int retries = T ? T->Retries.load(std::memory_order_relaxed) : 0;
+	int ret = GSV_ERROR;
+	for (int attempt = 0; attempt <= retries; attempt++)
+	{
+		const uint64_t t0 = extNowNs();
+		ret = Func(ComNo, Ctx);
+		const uint64_t t1 = extNowNs();
+		const bool timeout = cmdIsTimeout(ComNo, ret);
+		if (acc)
+		{
+			cmdAccount(T, CmdNo, TxParBytes, RxParBytes, t1 - t0, timeout);
+			if (attempt)
+				T->Cmd[CmdNo].Retries.fetch_add(1, std::memory_order_relaxed);
+		}
+		if (!timeout)
+			break;
+	}
+	if (acc)
+	{
+		T->Cmd[CmdNo].Calls.fetch_add(1, std::memory_order_relaxed);
+		if (ret == GSV_ERROR)
+			T->Cmd[CmdNo].Errors.fetch_add(1, std::memory_order_relaxed);
+	}
+	return ret;
+}
+
+int CALLTYP GSV86extCmdRecord(int ComNo, int CmdNo, int TxParBytes, int RxParBytes, double Seconds, int Result)
+{
+	if (!cmdComNoValid(ComNo))
+		return GSV_ERROR;
+	if (CmdNo < 0 || CmdNo >= CMD_NUM || Seconds < 0)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	CmdTable* T = cmdTable(ComNo);
+	if (!T)
+		return GSV_ERROR;
+	if (!T->Active.load(std::memory_order_acquire))
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	cmdAccount(T, CmdNo, TxParBytes, RxParBytes, (uint64_t)(Seconds * 1e9), cmdIsTimeout(ComNo, Result));
+	T->Cmd[CmdNo].Calls.fetch_add(1, std::memory_order_relaxed);
+	if (Result == GSV_ERROR)
+		T->Cmd[CmdNo].Errors.fetch_add(1, std::memory_order_relaxed);
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extCmdGet(int ComNo, int CmdNo, CMD_STATS* Stats)
+{
+	if (!cmdComNoValid(ComNo))
+		return GSV_ERROR;
+	if (CmdNo < 0 || CmdNo >= CMD_NUM || !Stats)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	CmdTable* T = cmdTable(ComNo);
+	if (!T)
+		return GSV_ERROR;
+	memset(Stats, 0, sizeof(*Stats));
+	CmdEntry* E = &T->Cmd[CmdNo];
+	Stats->Calls = E->Calls.load(std::memory_order_relaxed);
+	Stats->Errors = E->Errors.load(std::memory_order_relaxed);
+	Stats->Timeouts = E->Timeouts.load(std::memory_order_relaxed);
+	Stats->Retries = E->Retries.load(std::memory_order_relaxed);
+	Stats->TxBytes = E->TxBytes.load(std::memory_order_relaxed);
+	Stats->RxBytes = E->RxBytes.load(std::memory_order_relaxed);
+	const ExtHist* H = E->Rtt.load(std::memory_order_acquire);
+	if (H)
+		extHistSummary(H, &Stats->Rtt);
+	return Stats->Calls || Stats->TxBytes ? GSV_TRUE : GSV_OK;
+}
+
+int CALLTYP GSV86extCmdList(int ComNo, int* CmdNos, int Max)
+{
+	if (!cmdComNoValid(ComNo))
+		return GSV_ERROR;
+	if (!CmdNos || Max < 0)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	CmdTable* T = cmdTable(ComNo);
+	if (!T)
+		return GSV_ERROR;
+	int n = 0;
+	for (int c = 0; c < CMD_NUM && n < Max; c++)
+		if (T->Cmd[c].Calls.load(std::memory_order_relaxed) || T->Cmd[c].TxBytes.load(std::memory_order_relaxed))
+			CmdNos[n++] = c;
+	return n;
+}
+
+int CALLTYP GSV86extCmdGetLoad(int ComNo, unsigned long Bitrate, double* CmdShare, double* ValShare)
+{
+	if (!cmdComNoValid(ComNo))
+		return GSV_ERROR;
+	if (!CmdShare)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	CmdTable* T = cmdTable(ComNo);
+	if (!T)
+		return GSV_ERROR;
+	if (!T->Active.load(std::memory_order_acquire))
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	double bitsPerByte = PLAN_UART_BITS_PER_BYTE;
+	if (Bitrate == 0)
+	{
+		int phys = 0;
+		if (extLinkQuery(ComNo, &Bitrate, &phys) == GSV_ERROR)
+			return GSV_ERROR;
+		if (phys == INTF_PHY_TYP_USB)
+		{
+			/* the bitrate setting has no effect on USB-CDC */
+			Bitrate = PLAN_USB_BITRATE;
+			bitsPerByte = 8;
+		}
+	}
+	const double sec = (double)(extNowNs() - T->StartNs) * 1e-9;
+	const double capacity = sec * (double)Bitrate / bitsPerByte;	/* bytes */
+	/* the serial link is full duplex: only the answers compete with the measuring values */
+	const double cmd = (double)T->RxTotal.load(std::memory_order_relaxed);
+	double val = 0;
+	ExtDeviceRef dev = extFindDevice(ComNo);
+	if (dev)
+	{
+		uint64_t fc = dev->FrameCount.load(std::memory_order_acquire);
+		if (fc > T->StartFrames)
+			val = (double)(fc - T->StartFrames) * (PLAN_FRAME_OVERHEAD + dev->NumObj * extValueBytes(dev->DataType));
+	}
+	*CmdShare = capacity > 0 ? cmd / capacity : 0.0;
+	if (ValShare)
+		*ValShare = capacity > 0 ? val / capacity : 0.0;
+	return GSV_OK;
+}
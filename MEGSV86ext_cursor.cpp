@@ -0,0 +1,368 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: named reader cursors on the host frame ring
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <cstring>
+
+struct ReadCursor
+{
+	char Name[CURSOR_NAME_SIZE];
+	unsigned long Flags;
+	uint64_t Pos;		/* next frame to read */
+	uint64_t LagMax;
+	uint64_t Overruns;
+	uint64_t Stalls;
+	uint64_t FramesRead;
+};
+
+static ReadCursor* cursorGet(ExtDevice* Dev, int Cur)
+{
+	if (Cur < 1 || Cur > CURSOR_NUM_MAX || !Dev->Cursor[Cur - 1])
+	{
+		extSetError(Dev->ComNo, ERR_EXT_WRONG_HANDLE);
+		return NULL;
+	}
+	return Dev->Cursor[Cur - 1];
+}
+
+uint64_t extCursorWritable(ExtDevice* Dev)
+{
+	const uint64_t fc = Dev->FrameCount.load(std::memory_order_relaxed);
+	ReadCursor* slowest = NULL;
+	for (int c = 0; c < CURSOR_NUM_MAX; c++)
+	{
+		ReadCursor* C = Dev->Cursor[c];
+		if (C && !(C->Flags & CURSOR_FLAG_NONBLOCKING) && (!slowest || C->Pos < slowest->Pos))
+			slowest = C;
+	}
+	if (!slowest)
+		return Dev->RingFrames;
+	uint64_t space = Dev->RingFrames - (fc - slowest->Pos);
+	if (space == 0)
+		slowest->Stalls++;
+	return space;
+}
+
+void extCursorUpdate(ExtDevice* Dev)
+{
+	const uint64_t fc = Dev->FrameCount.load(std::memory_order_relaxed);
+	for (int c = 0; c < CURSOR_NUM_MAX; c++)
+	{
+		ReadCursor* C = Dev->Cursor[c];
+		if (!C)
+			continue;
+		uint64_t lag = fc - C->Pos;
+		if (lag > Dev->RingFrames)
+		{
+			/* only non-blocking cursors can fall behind the ring */
+			C->Overruns += lag - Dev->RingFrames;
+			C->Pos = fc - Dev->RingFrames;
+			lag = Dev->RingFrames;
+		}
+		if (lag > C->LagMax)
+			C->LagMax = lag;
+	}
+}
+
+void extCursorFreeAll(ExtDevice* Dev)
+{
+	for (int c = 0; c < CURSOR_NUM_MAX; c++)
+	{
+		delete Dev->Cursor[c];
+		Dev->Cursor[c] = NULL;
+	}
+}
+
+static int cursorFindLocked(ExtDevice* Dev, const char* Name)
+{
+	for (int c = 0; c < CURSOR_NUM_MAX; c++)
+		if (Dev->Cursor[c] && strcmp(Dev->Cursor[c]->Name, Name) == 0)
+			return c + 1;
+	return 0;
+}
+
+int extCursorCreate(ExtDevice* Dev, const char* Name, unsigned long flags)
+{
+	if (!Name || !Name[0] || strlen(Name) >= CURSOR_NAME_SIZE)
+	{
+		extSetError(Dev->ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(Dev->Lock);
+	if (cursorFindLocked(Dev, Name))
+	{
+		extSetError(Dev->ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	int ix = 0;
+	while (ix < CURSOR_NUM_MAX && Dev->Cursor[ix])
+		ix++;
+	if (ix == CURSOR_NUM_MAX)
+	{
+		extSetError(Dev->ComNo, ERR_EXT_NO_RESOURCE);
+		return GSV_ERROR;
+	}
+	ReadCursor* C = new (std::nothrow) ReadCursor();
+	if (!C)
+	{
+		extSetError(Dev->ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	strcpy(C->Name, Name);
+	C->Flags = flags;
+	C->Pos = Dev->FrameCount.load(std::memory_order_relaxed);
+	Dev->Cursor[ix] = C;
+	return ix + 1;
+}
+
+int CALLTYP GSV86extCursorCreate(int ComNo, const char* Name, unsigned long flags)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	return extCursorCreate(dev.get(), Name, flags);
+}
+
+int CALLTYP GSV86extCursorFind(int ComNo, const char* Name)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	if (!Name)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	int c = cursorFindLocked(dev.get(), Name);
+	if (!c)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_HANDLE);
+		return GSV_ERROR;
+	}
+	return c;
+}
+
+static void cursorCopyPiece(const ExtDevice* Dev, double* out, const double* src, size_t n)
+{
+	memcpy(out, src, n * Dev->NumObj * sizeof(double));
+}
+
+static void cursorCopyPiece(const ExtDevice* Dev, float* out, const double* src, size_t n)
+{
+	Dev->Kern->ToFloat(out, src, n);
+}
+
+static void cursorExtractPiece(const ExtDevice* Dev, double* out, const double* src, int obj, size_t n)
+{
+	Dev->Kern->ExtractObj(out, src, obj, n);
+}
+
+static void cursorExtractPiece(const ExtDevice* Dev, float* out, const double* src, int obj, size_t n)
+{
+	Dev->Kern->ExtractObjFloat(out, src, obj, n);
+}
+
+static void cursorPlanarPiece(const ExtDevice* Dev, double* out, size_t stride, const double* src, size_t n)
+{
+	Dev->Kern->Deinterleave(out, stride, src, n);
+}
+
+static void cursorPlanarPiece(const ExtDevice* Dev, float* out, size_t stride, const double* src, size_t n)
+{
+	Dev->Kern->DeinterleaveFloat(out, stride, src, n);
+}
+
+/* Copy n frames (Chan=0) or n values of one object (Chan>0) from the cursor position and advance it */
+template <class T>
+static void cursorCopy(const ExtDevice* Dev, ReadCursor* C, int Chan, T* out, uint64_t n)
+{
+	const int num = Dev->NumObj;
+	/* at most two contiguous pieces */
+	size_t pos = (size_t)(C->Pos & Dev->RingMask);
+	size_t part = (size_t)Dev->RingFrames - pos;
+	if (part > (size_t)n)
+		part = (size_t)n;
+	if (Chan == 0)
+	{
+		cursorCopyPiece(Dev, out, &Dev->Ring[pos * num], part);
+		if (part < (size_t)n)
+			cursorCopyPiece(Dev, out + part * num, &Dev->Ring[0], (size_t)n - part);
+	}
+	else
+	{
+		cursorExtractPiece(Dev, out, &Dev->Ring[pos * num], Chan - 1, part);
+		if (part < (size_t)n)
+			cursorExtractPiece(Dev, out + part, &Dev->Ring[0], Chan - 1, (size_t)n - part);
+	}
+	if (Dev->Stats.load(std::memory_order_relaxed))
+		extStatsRead(Dev, C->Pos, n);
+	C->Pos += n;
+	C->FramesRead += n;
+}
+
+int extCursorReadFrames(ExtDevice* Dev, int Cur, double* out, int MaxFrames, uint64_t* FirstFrame)
+{
+	std::lock_guard<std::mutex> lk(Dev->Lock);
+	ReadCursor* C = cursorGet(Dev, Cur);
+	if (!C)
+		return GSV_ERROR;
+	uint64_t n = Dev->FrameCount.load(std::memory_order_relaxed) - C->Pos;
+	if (n > (uint64_t)MaxFrames)
+		n = (uint64_t)MaxFrames;
+	*FirstFrame = C->Pos;
+	cursorCopy(Dev, C, 0, out, n);
+	return (int)n;
+}
+
+template <class T>
+static int cursorRead(int ComNo, int Cur, int Chan, T* out, int count, int* valsread)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	ReadCursor* C = cursorGet(dev.get(), Cur);
+	if (!C)
+		return GSV_ERROR;
+	const int num = dev->NumObj;
+	if (!out || !valsread || count <= 0 || Chan < 0 || Chan > num || (Chan == 0 && count % num))
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	uint64_t n = dev->FrameCount.load(std::memory_order_relaxed) - C->Pos;
+	uint64_t max = (uint64_t)(Chan == 0 ? count / num : count);
+	if (n > max)
+		n = max;
+	cursorCopy(dev.get(), C, Chan, out, n);
+	*valsread = (int)(Chan == 0 ? n * num : n);
+	return n ? GSV_TRUE : GSV_OK;
+}
+
+int CALLTYP GSV86extCursorRead(int ComNo, int Cur, int Chan, double* out, int count, int* valsread)
+{
+	return cursorRead(ComNo, Cur, Chan, out, count, valsread);
+}
+
+int CALLTYP GSV86extCursorReadFloat(int ComNo, int Cur, int Chan, float* out, int count, int* valsread)
+{
+	return cursorRead(ComNo, Cur, Chan, out, count, valsread);
+}
+
+template <class T>
+static int cursorReadLayout(int ComNo, int Cur, T* out, int MaxFrames, int Layout, int Stride, int* framesread)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	if (Layout == CURSOR_LAYOUT_INTERLEAVED)
+	{
+		if (!framesread || MaxFrames <= 0 || MaxFrames > 0x7FFFFFFF / dev->NumObj)
+		{
+			extSetError(ComNo, ERR_WRONG_PARAMETER);
+			return GSV_ERROR;
+		}
+		int ret = cursorRead(ComNo, Cur, 0, out, MaxFrames * dev->NumObj, framesread);
+		if (ret != GSV_ERROR)
+			*framesread /= dev->NumObj;
+		return ret;
+	}
+	if (Layout != CURSOR_LAYOUT_PLANAR)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	ReadCursor* C = cursorGet(dev.get(), Cur);
+	if (!C)
+		return GSV_ERROR;
+	if (!out || !framesread || MaxFrames <= 0 || Stride < MaxFrames
+		|| (uint64_t)Stride * (dev->NumObj - 1) + MaxFrames > 0x7FFFFFFF)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	uint64_t n = dev->FrameCount.load(std::memory_order_relaxed) - C->Pos;
+	if (n > (uint64_t)MaxFrames)
+		n = (uint64_t)MaxFrames;
+	/* at most two contiguous pieces */
+	const int num = dev->NumObj;
+	size_t pos = (size_t)(C->Pos & dev->RingMask);
+	size_t part = (size_t)dev->RingFrames - pos;
+	if (part > (size_t)n)
+		part = (size_t)n;
+	cursorPlanarPiece(dev.get(), out, (size_t)Stride, &dev->Ring[pos * num], part);
+	if (part < (size_t)n)
+		cursorPlanarPiece(dev.get(), out + part, (size_t)Stride, &dev->Ring[0], (size_t)n - part);
+	if (dev->Stats.load(std::memory_order_relaxed))
+		extStatsRead(dev.get(), C->Pos, n);
+	C->Pos += n;
+	C->FramesRead += n;
+	*framesread = (int)n;
+	return n ? GSV_TRUE : GSV_OK;
+}
+
+int CALLTYP GSV86extCursorReadLayout(int ComNo, int Cur, double* out, int MaxFrames, int Layout, int Stride, int* framesread)
+{
+	return cursorReadLayout(ComNo, Cur, out, MaxFrames, Layout, Stride, framesread);
+}
+
+int CALLTYP GSV86extCursorReadLayoutFloat(int ComNo, int Cur, float* out, int MaxFrames, int Layout, int Stride, int* framesread)
+{
+	return cursorReadLayout(ComNo, Cur, out, MaxFrames, Layout, Stride, framesread);
+}
+
+int CALLTYP GSV86extCursorGetInfo(int ComNo, int Cur, int Index)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	ReadCursor* C = cursorGet(dev.get(), Cur);
+	if (!C)
+		return GSV_ERROR;
+	uint64_t v;
+	switch (Index)
+	{
+	case CURSOR_INFO_LAG:
+		v = dev->FrameCount.load(std::memory_order_relaxed) - C->Pos;
+		break;
+	case CURSOR_INFO_LAG_MAX:
+		v = C->LagMax;
+		break;
+	case CURSOR_INFO_OVERRUNS:
+		v = C->Overruns;
+		break;
+	case CURSOR_INFO_STALLS:
+		v = C->Stalls;
+		break;
+	case CURSOR_INFO_FRAMES_READ:
+		v = C->FramesRead & 0x7FFFFFFF;
+		break;
+	default:
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	return (int)(v > 0x7FFFFFFF ? 0x7FFFFFFF : v);
+}
+
+int extCursorDelete(ExtDevice* Dev, int Cur)
+{
+	std::lock_guard<std::mutex> lk(Dev->Lock);
+	ReadCursor* C = cursorGet(Dev, Cur);
+	if (!C)
+		return GSV_ERROR;
+	delete C;
+	Dev->Cursor[Cur - 1] = NULL;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extCursorDelete(int ComNo, int Cur)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	return extCursorDelete(dev.get(), Cur);
+}
@@ -0,0 +1,236 @@
+/**********************************************************************************************
+Internal declarations of the MEGSV86ext host extension library.
+Not to be included by applications, use MEGSV86ext.h instead.
+************************************************************************************************/
+#ifndef MEGSV86EXT_INTERN_H
+#define MEGSV86EXT_INTERN_H
+
+#include "MEGSV86ext.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+struct TrigEngine;
+struct ResampSub;
+struct ReadCursor;
+struct ShmPublisher;
+struct NetServer;
+struct ReconState;
+struct LowLatThread;
+struct ExtStats;
+struct ExtDevice;
+
+/* Per-frame kernels, instantiated for each NumObj (MEGSV86ext_kernels.cpp) */
+struct ExtKernels
+{
+	int NumObj;
+	/* dst[i*NumObj+o] = src[i*NumObj+o] * sf[o] for n frames; dst may be src */
+	void (*ScaleFrames)(double* dst, const double* src, const double* sf, size_t n);
+	/* dst[i] = src[i*NumObj+obj] for n frames, obj 0-based */
+	void (*ExtractObj)(double* dst, const double* src, int obj, size_t n);
+	/* float versions: dst[i*NumObj+o] = src[i*NumObj+o] and dst[i] = src[i*NumObj+obj] for n frames */
+	void (*ToFloat)(float* dst, const double* src, size_t n);
+	void (*ExtractObjFloat)(float* dst, const double* src, int obj, size_t n);
+	/* planar: dst[o*stride+i] = src[i*NumObj+o] for n frames */
+	void (*Deinterleave)(double* dst, size_t stride, const double* src, size_t n);
+	void (*DeinterleaveFloat)(float* dst, size_t stride, const double* src, size_t n);
+	/* acc[o] = sum(h[k] * frame(Base-k)[o]) over k=0..taps-1, frames before 0 are skipped */
+	void (*FirFrame)(const ExtDevice* Dev, uint64_t Base, const double* h, int taps, double* acc);
+};
+
+/* Kernels for NumObj=1..VALOBJ_NUM_MAX, NULL otherwise */
+const ExtKernels* extGetKernels(int NumObj);
+
+/* Host-side state of one attached ComNo */
+struct ExtDevice
+{
+	int ComNo;
+	int NumObj;				/* NumberOfMappedObjects, 1..VALOBJ_NUM_MAX */
+	int DataType;				/* DATATYP_* */
+	double ScaleFactors[VALOBJ_NUM_MAX];
+	unsigned long ObjMapping[VALOBJ_NUM_MAX];
+	double Frequency;			/* data rate at attach time, frames per second */
+	const ExtKernels* Kern;			/* selected for NumObj by GSV86extAttach */
+
+	/* Host frame ring: RingFrames frames of NumObj values, interleaved like GSV86readMultiple(Chan=0).
+	   Ring points into RingHeap, or into the shared memory segment while published. */
+	double* Ring;
+	std::vector<double> RingHeap;
+	uint64_t RingFrames;			/* power of two */
+	uint64_t RingMask;
+	std::atomic<uint64_t> FrameCount;	/* total frames written, =index of next frame */
+	std::vector<double> PullBuf;		/* EXT_PULL_FRAMES*NumObj values */
+
+	/* Held while frames are processed and while stage tables are modified */
+	std::mutex Lock;
+
+	/* Newest frame, published by GSV86extPoll through a sequence lock (see extSnapPublish):
+	   SnapSeq is odd while SnapVal and SnapFrame are written. Read without Lock. */
+	std::atomic<uint32_t> SnapSeq;
+	std::atomic<double> SnapVal[VALOBJ_NUM_MAX];
+	std::atomic<uint64_t> SnapFrame;	/* frame number of SnapVal + 1, =0: none yet */
+	std::atomic<uint64_t> SnapTime;		/* extNowNs() when the frame was written to the ring */
+
+	TrigEngine* Trig[TRIG_NUM_MAX];
+	ResampSub* Resamp[RESAMP_NUM_MAX];
+	ReadCursor* Cursor[CURSOR_NUM_MAX];
+	ShmPublisher* Shm;
+	NetServer* Net;
+	ReconState* Recon;
+	LowLatThread* LowLat;
+	std::atomic<ExtStats*> Stats;		/* created by GSV86extStatsEnable, freed with the device only */
+};
+
+/* Reference to an attached device. Held for the whole API call: GSV86extDetach only unregisters
+   the device, it is freed when the last reference is dropped. */
+typedef std::shared_ptr<ExtDevice> ExtDeviceRef;
+
+/* Returns attached device or NULL (and sets ERR_EXT_NOT_ATTACHED / ERR_WRONG_COMNO) */
+ExtDeviceRef extGetDevice(int ComNo);
+/* Returns attached device or NULL, without setting an error */
+ExtDeviceRef extFindDevice(int ComNo);
+/* GSV86extPoll on a device already looked up, locks Dev->Lock */
+int extPoll(ExtDevice* Dev);
+/* Set last error of ComNo to an ERR_EXT_* or Errorcodes.h code */
+void extSetError(int ComNo, int Err);
+/* Set last error of ComNo to the error of the last failed MEGSV86xx.DLL call */
+void extSetDllError(int ComNo);
+
+/* Bytes per measuring value of DATATYP_*, 0 if unknown */
+inline int extValueBytes(int DataType)
+{
+	switch (DataType)
+	{
+	case DATATYP_INT16: return 2;
+	case DATATYP_INT24: return 3;
+	case DATATYP_FLOAT: return 4;
+	default: return 0;
+	}
+}
+
+/* Pointer to the first value of frame number Frame in the host ring */
+inline const double* extRingFrame(const ExtDevice* Dev, uint64_t Frame)
+{
+	return &Dev->Ring[(size_t)(Frame & Dev->RingMask) * Dev->NumObj];
+}
+
+/* Monotonic time in nanoseconds, for latency statistics */
+inline uint64_t extNowNs()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* Publish frame number Frame of the ring as newest frame, written at Time (extNowNs).
+   Called by GSV86extPoll with Dev->Lock held. */
+inline void extSnapPublish(ExtDevice* Dev, uint64_t Frame, uint64_t Time)
+{
+	const double* f = extRingFrame(Dev, Frame);
+	uint32_t seq = Dev->SnapSeq.load(std::memory_order_relaxed);
+	Dev->SnapSeq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (int o = 0; o < Dev->NumObj; o++)
+		Dev->SnapVal[o].store(f[o], std::memory_order_relaxed);
+	Dev->SnapFrame.store(Frame + 1, std::memory_order_relaxed);
+	Dev->SnapTime.store(Time, std::memory_order_relaxed);
+	Dev->SnapSeq.store(seq + 2, std::memory_order_release);
+}
+
+/* Trigger stage, called by GSV86extPoll with Dev->Lock held.
+   Frames [First, First+Count) have just been written to the ring. */
+void extTrigProcess(ExtDevice* Dev, uint64_t First, uint64_t Count);
+/* Free all trigger engines of Dev, called by GSV86extDetach */
+void extTrigFreeAll(ExtDevice* Dev);
+/* Free all resampling subscribers of Dev, called by GSV86extDetach */
+void extResampFreeAll(ExtDevice* Dev);
+
+/* Number of frames GSV86extPoll may write without overwriting frames of a blocking cursor.
+   Counts a stall for the slowest cursor, if no space is left. Called with Dev->Lock held. */
+uint64_t extCursorWritable(ExtDevice* Dev);
+/* Update lag statistics and skip overrun non-blocking cursors, called by GSV86extPoll with Dev->Lock held */
+void extCursorUpdate(ExtDevice* Dev);
+/* Free all reader cursors of Dev, called by GSV86extDetach */
+void extCursorFreeAll(ExtDevice* Dev);
+/* GSV86extCursorCreate / GSV86extCursorDelete on a device already looked up, lock Dev->Lock.
+   For threads owned by the device, which must not look it up again by ComNo. */
+int extCursorCreate(ExtDevice* Dev, const char* Name, unsigned long flags);
+int extCursorDelete(ExtDevice* Dev, int Cur);
+/* Read up to MaxFrames frames through cursor Cur, *FirstFrame receives the frame number of the first.
+   Locks Dev->Lock. Returns number of frames or GSV_ERROR. */
+int extCursorReadFrames(ExtDevice* Dev, int Cur, double* out, int MaxFrames, uint64_t* FirstFrame);
+
+/* Publish FrameCount to the shared memory segment, called by GSV86extPoll with Dev->Lock held */
+void extShmUpdate(ExtDevice* Dev);
+/* Rewrite the metadata of the segment (ScaleFactors etc.) after they changed, with Dev->Lock held */
+void extShmUpdateMeta(ExtDevice* Dev);
+/* Stop publishing and move the ring back to the heap, called by GSV86extDetach */
+void extShmFree(ExtDevice* Dev);
+
+/* Stop the streaming server thread, called by GSV86extDetach without Dev->Lock held */
+void extNetFree(ExtDevice* Dev);
+
+/* Log-linear histogram of nanosecond values (MEGSV86ext_stats.cpp). Atomic, samples may be
+   added without lock from several threads. Must be cleared with extHistClear before use. */
+struct ExtHist
+{
+	std::atomic<uint64_t> Bucket[STATS_BUCKETS];
+	std::atomic<uint64_t> Count;
+	std::atomic<uint64_t> Sum;
+	std::atomic<uint64_t> Min;
+	std::atomic<uint64_t> Max;
+};
+/* Add N samples of value v */
+void extHistAdd(ExtHist* H, uint64_t v, uint64_t N = 1);
+void extHistClear(ExtHist* H);
+/* Summary in microseconds */
+void extHistSummary(const ExtHist* H, STATS_LATENCY* Stats);
+/* Non-empty buckets, see GSV86extStatsGetHistogram */
+int extHistBuckets(const ExtHist* H, double* UpperUs, unsigned long long* Counts, int Max);
+
+/* Latency statistics (MEGSV86ext_stats.cpp). Stats is Dev->Stats, only called if enabled.
+   Poll side, called by GSV86extPoll with Dev->Lock held: */
+bool extStatsActive(const ExtStats* Stats);
+void extStatsPollStart(ExtStats* Stats, uint64_t Now);
+void extStatsDll(ExtStats* Stats, uint64_t Call, uint64_t Ret);
+/* Frames [First, First+Count) are about to become visible at Now, read from the DLL at Ret */
+void extStatsInsert(ExtDevice* Dev, ExtStats* Stats, uint64_t First, uint64_t Count, uint64_t Ret, uint64_t Now);
+void extStatsStages(ExtStats* Stats, uint64_t Ins, uint64_t Done);
+/* Consumer side: frames [First, First+Count) read through a cursor, with Dev->Lock held */
+void extStatsRead(const ExtDevice* Dev, uint64_t First, uint64_t Count);
+/* Consumer side: newest frame written at Time read by GSV86extGetLatest, no lock held */
+void extStatsReadLatest(ExtStats* Stats, uint64_t Time);
+/* Free statistics, called when the last reference to the device is dropped */
+void extStatsFree(ExtDevice* Dev);
+
+/* Actual interface of an activated device (MEGSV86ext_link.cpp): bitrate and physical type
+   (INTF_PHY_TYP_*) as read by GSV86readAllInterfSettings. Sets the error of ComNo if failed. */
+int extLinkQuery(int ComNo, unsigned long* Bitrate, int* PhysType);
+
+/* Stop the low-latency poll thread, called by GSV86extDetach without Dev->Lock held */
+void extLowLatFree(ExtDevice* Dev);
+
+/* Definition of property PropID of template TemplID (0: Basic TEDS) for the TEDS decoder
+   (MEGSV86ext_teds.cpp). Returns false if not defined. */
+bool extTedsPropDef(int TemplID, int PropID, TEDS_PROP_DEF* Def);
+/* Parameters of GSV86extTedsDefineTemplate are valid */
+bool extTedsTemplateValid(int TemplID, const TEDS_PROP_DEF* Props, int Num);
+/* Unbind the channels of ComNo without TEDS memory (Bit<7:0> of Present: channel 8..1) from their
+   cached sensors, as GSV86extTedsCheck */
+void extTedsPlugged(int ComNo, int Present);
+
+/* Called by GSV86extPoll without Dev->Lock held before reading: re-activates a lost link, taking
+   Dev->Lock only to check and swap the state. Returns GSV_TRUE if the link is up (or reconnection
+   is not enabled), GSV_OK if still down, GSV_ERROR if another device answered. */
+int extReconService(ExtDevice* Dev);
+/* Called by GSV86extPoll with Dev->Lock held after GSV86readMultiple failed.
+   Returns true if the error is a lost link handled by reconnection. */
+bool extReconLinkLost(ExtDevice* Dev);
+/* Free reconnection state, called by GSV86extDetach */
+void extReconFree(ExtDevice* Dev);
+
+#endif /* MEGSV86EXT_INTERN_H */
@@ -0,0 +1,80 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: per-frame kernels specialized for the number of objects
+The frame layout of the host ring is fixed by NumObj once the device is attached, so each
+kernel is instantiated for NumObj=1..VALOBJ_NUM_MAX and selected by GSV86extAttach.
+With a constant trip count the compiler unrolls and vectorizes the per-object loops.
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+template <int N>
+static void kernScaleFrames(double* dst, const double* src, const double* sf, size_t n)
+{
+	double s[N];
+	for (int o = 0; o < N; o++)
+		s[o] = sf[o];
+	for (size_t i = 0; i < n; i++, dst += N, src += N)
+		for (int o = 0; o < N; o++)
+			dst[o] = src[o] * s[o];
+}
+
+template <int N, class T>
+static void kernExtractObj(T* dst, const double* src, int obj, size_t n)
+{
+	src += obj;
+	for (size_t i = 0; i < n; i++, src += N)
+		dst[i] = (T)*src;
+}
+
+template <int N>
+static void kernToFloat(float* dst, const double* src, size_t n)
+{
+	for (size_t i = 0; i < n; i++, dst += N, src += N)
+		for (int o = 0; o < N; o++)
+			dst[o] = (float)src[o];
+}
+
+template <int N, class T>
+static void kernDeinterleave(T* dst, size_t stride, const double* src, size_t n)
+{
+	T* col[N];
+	for (int o = 0; o < N; o++)
+		col[o] = dst + o * stride;
+	for (size_t i = 0; i < n; i++, src += N)
+		for (int o = 0; o < N; o++)
+			col[o][i] = (T)src[o];
+}
+
+template <int N>
+static void kernFirFrame(const ExtDevice* Dev, uint64_t Base, const double* h, int taps, double* acc)
+{
+	double a[N];
+	for (int o = 0; o < N; o++)
+		a[o] = 0.0;
+	for (int k = 0; k < taps && (uint64_t)k <= Base; k++)
+	{
+		const double* x = extRingFrame(Dev, Base - k);
+		const double c = h[k];
+		for (int o = 0; o < N; o++)
+			a[o] += c * x[o];
+	}
+	for (int o = 0; o < N; o++)
+		acc[o] = a[o];
+}
+
+#define EXT_KERNELS(N) { N, kernScaleFrames<N>, kernExtractObj<N, double>, kernToFloat<N>, \
+	kernExtractObj<N, float>, kernDeinterleave<N, double>, kernDeinterleave<N, float>, kernFirFrame<N> }
+
+static const ExtKernels g_Kernels[VALOBJ_NUM_MAX] =
+{
+	EXT_KERNELS(1), EXT_KERNELS(2), EXT_KERNELS(3), EXT_KERNELS(4),
+	EXT_KERNELS(5), EXT_KERNELS(6), EXT_KERNELS(7), EXT_KERNELS(8),
+	EXT_KERNELS(9), EXT_KERNELS(10), EXT_KERNELS(11), EXT_KERNELS(12),
+	EXT_KERNELS(13), EXT_KERNELS(14), EXT_KERNELS(15), EXT_KERNELS(16)
+};
+
+const ExtKernels* extGetKernels(int NumObj)
+{
+	if (NumObj < 1 || NumObj > VALOBJ_NUM_MAX)
+		return NULL;
+	return &g_Kernels[NumObj - 1];
+}
@@ -0,0 +1,343 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: interface bitrate negotiation and port discovery
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+/* Standard UART bitrates tried if the device doesn't answer at CONST_BAUDRATE, highest first */
+static const unsigned long g_StdBaud[] = { 921600, 460800, 230400, 115200, 57600, 38400, 19200, 9600 };
+/* Bitrate GSV86extActivateFast last opened each ComNo at, 0: none yet */
+static std::atomic<unsigned long> g_LinkBaud[EXT_COMNO_MAX];
+
+int extLinkQuery(int ComNo, unsigned long* Bitrate, int* PhysType)
+{
+	int phys[BAUD_LIST_SIZE], appl[BAUD_LIST_SIZE], iflags[BAUD_LIST_SIZE];
+	int enums[2], dtypes[BAUD_LIST_SIZE], data[BAUD_LIST_SIZE], bd[BAUD_LIST_SIZE], bdnum = 0;
+	int intf = GSV86readBasicInterfSettings(ComNo, 1, phys, appl, iflags);
+	if (intf == GSV_ERROR || GSV86readAllInterfSettings(ComNo, intf, enums, dtypes, data, bd, &bdnum) == GSV_ERROR)
+	{
+		extSetDllError(ComNo);
+		return GSV_ERROR;
+	}
+	*PhysType = enums[0];
+	*Bitrate = bdnum > 0 && bd[0] > 0 ? (unsigned long)bd[0] : CONST_BAUDRATE;
+	return GSV_OK;
+}
+
+/* Verify the link after switching: same device answers and values arrive at the data rate */
+static bool linkProbe(int ComNo, int SerNo, double Frequency)
+{
+	if (GSV86getSerialNo(ComNo) != SerNo)
+		return false;
+	int tx = GSV86getTXmode(ComNo, 0);
+	if (tx == GSV_ERROR)
+		return false;
+	if (tx & 1)
+		return true;	/* value transmission stopped, nothing to measure */
+	if (GSV86clearDLLbuffer(ComNo) == GSV_ERROR)
+		return false;
+	std::this_thread::sleep_for(std::chrono::milliseconds(BAUD_PROBE_MS));
+	int n = GSV86received(ComNo, 0);
+	return n != GSV_ERROR && n >= BAUD_PROBE_RATIO * Frequency * BAUD_PROBE_MS / 1000.0;
+}
+
+/* Re-open the port at Baud */
+static bool linkReopen(int ComNo, int Baud, unsigned long BufSize, unsigned long flags)
+{
+	GSV86release(ComNo);
+	return GSV86activateExtended(ComNo, (unsigned long)Baud, BufSize, flags) != GSV_ERROR;
+}
+
+/* Open the port at the bitrate the device answers at: GSV86writeInterfaceBaud may have stored another
+   one than CONST_BAUDRATE. Tried are CONST_BAUDRATE, the last one that worked, MaxBitrate and the
+   standard rates up to MaxBitrate. Returns the bitrate opened at, 0 if the device didn't answer. */
+static unsigned long linkOpen(int ComNo, unsigned long BufSize, unsigned long flags, unsigned long MaxBitrate)
+{
+	std::vector<unsigned long> rates;
+	rates.push_back(CONST_BAUDRATE);
+	unsigned long last = g_LinkBaud[ComNo].load();
+	if (last && last <= MaxBitrate)
+		rates.push_back(last);
+	rates.push_back(MaxBitrate);
+	for (size_t i = 0; i < sizeof(g_StdBaud) / sizeof(g_StdBaud[0]); i++)
+		if (g_StdBaud[i] <= MaxBitrate)
+			rates.push_back(g_StdBaud[i]);
+	for (size_t i = 0; i < rates.size(); i++)
+	{
+		if (std::find(rates.begin(), rates.begin() + i, rates[i]) != rates.begin() + i)
+			continue;	/* tried already */
+		if (GSV86activateExtended(ComNo, rates[i], BufSize, flags) != GSV_ERROR)
+			return rates[i];
+		if (GSV86getLastProtocollError(ComNo) == ERR_COM_ALREADY_OPEN)
+			break;	/* no answer wasn't the cause */
+	}
+	return 0;
+}
+
+int CALLTYP GSV86extActivateFast(int ComNo, unsigned long BufSize, unsigned long flags, unsigned long MaxBitrate,
+	unsigned long* Bitrate)
+{
+	if (ComNo < 0 || ComNo >= EXT_COMNO_MAX)
+	{
+		extSetError(0, ERR_WRONG_COMNO);
+		return GSV_ERROR;
+	}
+	if (MaxBitrate == 0)
+		MaxBitrate = BAUD_MAX;
+	const unsigned long opened = linkOpen(ComNo, BufSize, flags, MaxBitrate);
+	if (!opened)
+	{
+		extSetDllError(ComNo);
+		return GSV_ERROR;
+	}
+	g_LinkBaud[ComNo] = opened;
+	if (Bitrate)
+		*Bitrate = opened;
+
+	int phys[BAUD_LIST_SIZE], appl[BAUD_LIST_SIZE], iflags[BAUD_LIST_SIZE];
+	int intf = GSV86readBasicInterfSettings(ComNo, 1, phys, appl, iflags);
+	int enums[2], dtypes[BAUD_LIST_SIZE], data[BAUD_LIST_SIZE], bd[BAUD_LIST_SIZE], bdnum = 0;
+	int serno = GSV86getSerialNo(ComNo);
+	double freq = GSV86getFrequency(ComNo);
+	if (intf == GSV_ERROR || serno == GSV_ERROR || freq == (double)GSV_ERROR
+		|| GSV86readAllInterfSettings(ComNo, intf, enums, dtypes, data, bd, &bdnum) == GSV_ERROR)
+	{
+		/* device is open, but can't be upgraded */
+		extSetDllError(ComNo);
+		return GSV_OK;
+	}
+
+	/* bd[0] is the actual bitrate, bd[1..bdnum-1] the available ones */
+	const int cur = bd[0];
+	std::vector<int> cand;
+	for (int i = 1; i < bdnum && i < BAUD_LIST_SIZE; i++)
+		if (bd[i] > cur && (unsigned long)bd[i] <= MaxBitrate)
+			cand.push_back(bd[i]);
+	std::sort(cand.begin(), cand.end(), std::greater<int>());
+
+	for (size_t i = 0; i < cand.size(); i++)
+	{
+		if (GSV86writeInterfaceBaud(ComNo, intf, cand[i]) == GSV_ERROR)
+			continue;	/* refused by device, still at cur */
+		bool open = linkReopen(ComNo, cand[i], BufSize, flags);
+		if (open && linkProbe(ComNo, serno, freq))
+		{
+			g_LinkBaud[ComNo] = (unsigned long)cand[i];
+			if (Bitrate)
+				*Bitrate = (unsigned long)cand[i];
+			return GSV_TRUE;
+		}
+		/* fall back: the port must be open at cand[i] to switch the device back over the new link,
+		   if it answers at all; then re-open at cur */
+		if (!open)
+			open = GSV86activateExtended(ComNo, (unsigned long)cand[i], BufSize, flags) != GSV_ERROR;
+		if (open)
+			GSV86writeInterfaceBaud(ComNo, intf, cur);
+		if (!linkReopen(ComNo, cur, BufSize, flags) || GSV86getSerialNo(ComNo) != serno)
+		{
+			extSetDllError(ComNo);
+			return GSV_ERROR;
+		}
+	}
+	g_LinkBaud[ComNo] = (unsigned long)cur;
+	return GSV_OK;
+}
+
+/* Results of GSV86extDiscover per ComNo */
+static DISC_INFO g_Disc[EXT_COMNO_MAX];
+static unsigned long g_DiscBitrate[EXT_COMNO_MAX];	/* bitrate g_Disc was probed with */
+static bool g_DiscValid[EXT_COMNO_MAX];
+static std::mutex g_DiscLock;
+
+/* Result of a failed probe from the DLL error: only a port where no device answered is a
+   definite "not found", a busy port or a port error may succeed on the next call */
+static void discFailed(int ComNo, DISC_INFO* Info)
+{
+	int err = GSV86getLastProtocollError(ComNo);
+	Info->Error = err;
+	if (err == ERR_NO_GSV_ANSWER || err == ERR_NO_GSV_FOUND)
+		Info->Found = GSV_OK;
+	else if (err == ERR_COM_ALREADY_OPEN)
+		Info->Found = DISC_BUSY;
+	else
+		Info->Found = DISC_FAILED;
+}
+
+/* Probe one port, fills Info completely. Returns true if the result may be cached. */
+static bool discProbe(int ComNo, unsigned long Bitrate, unsigned long flags, DISC_INFO* Info)
+{
+	memset(Info, 0, sizeof(*Info));
+	Info->ComNo = ComNo;
+	unsigned long actflags = flags & ~(unsigned long)(DISC_FLAG_USE_CACHE | DISC_FLAG_KEEP_OPEN);
+	if (GSV86activateExtended(ComNo, Bitrate, CONST_BUFSIZE, actflags) == GSV_ERROR)
+	{
+		discFailed(ComNo, Info);
+		return Info->Found == GSV_OK;
+	}
+	int ser = GSV86getSerialNo(ComNo);
+	int intfnum = 0, thisintf = 0, wprot = 0, dtype = 0, permtx = 0, numobj = 0, model = 0, prot = 0;
+	if (ser == GSV_ERROR || GSV86getInterfaceIdentity(ComNo, 0, &intfnum, &thisintf, &wprot, &dtype, &permtx,
+		&numobj, &model, &prot) == GSV_ERROR)
+	{
+		discFailed(ComNo, Info);
+		GSV86release(ComNo);
+		return Info->Found == GSV_OK;
+	}
+	int fw = GSV86firmwareVersion(ComNo);
+	Info->Found = GSV_TRUE;
+	Info->SerialNo = ser;
+	Info->DeviceModel = model;
+	Info->Firmware = fw == GSV_ERROR ? 0 : fw;
+	Info->NumOfIntfDescr = intfnum;
+	Info->ThisInterfNo = thisintf;
+	Info->Protocol = prot;
+	Info->DataType = dtype;
+	Info->NumObj = numobj;
+	Info->Bitrate = Bitrate;
+	if (!(flags & DISC_FLAG_KEEP_OPEN))
+		GSV86release(ComNo);
+	return true;
+}
+
+int CALLTYP GSV86extDiscover(const int* ComNos, int Count, unsigned long Bitrate, unsigned long flags, DISC_INFO* Info)
+{
+	if (ComNos)
+	{
+		if (Count < 0)
+		{
+			extSetError(0, ERR_WRONG_PARAMETER);
+			return GSV_ERROR;
+		}
+		for (int i = 0; i < Count; i++)
+			if (ComNos[i] < 0 || ComNos[i] >= EXT_COMNO_MAX)
+			{
+				extSetError(0, ERR_WRONG_COMNO);
+				return GSV_ERROR;
+			}
+	}
+	/* each ComNo is probed once, slot maps it to its entry in ports and res */
+	std::vector<int> ports;
+	int slot[EXT_COMNO_MAX];
+	std::fill(slot, slot + EXT_COMNO_MAX, -1);
+	try
+	{
+		if (ComNos)
+		{
+			for (int i = 0; i < Count; i++)
+				if (slot[ComNos[i]] < 0)
+				{
+					slot[ComNos[i]] = (int)ports.size();
+					ports.push_back(ComNos[i]);
+				}
+		}
+		else
+			for (int c = DISC_COMNO_FIRST; c <= DISC_COMNO_LAST; c++)
+			{
+				slot[c] = (int)ports.size();
+				ports.push_back(c);
+			}
+	}
+	catch (...)
+	{
+		extSetError(0, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	if (Bitrate == 0)
+		Bitrate = CONST_BAUDRATE;
+
+	/* probe all ports not taken from the cache; workers take the next index from an atomic counter */
+	std::vector<DISC_INFO> res(ports.size());
+	std::vector<char> todo(ports.size(), 1);
+	if (flags & DISC_FLAG_USE_CACHE)
+	{
+		std::lock_guard<std::mutex> lk(g_DiscLock);
+		for (size_t i = 0; i < ports.size(); i++)
+			if (g_DiscValid[ports[i]] && g_DiscBitrate[ports[i]] == Bitrate)
+			{
+				res[i] = g_Disc[ports[i]];
+				todo[i] = 0;
+			}
+	}
+	std::atomic<size_t> next(0);
+	auto worker = [&]()
+	{
+		for (size_t i; (i = next.fetch_add(1)) < ports.size(); )
+		{
+			if (!todo[i])
+				continue;
+			if (!discProbe(ports[i], Bitrate, flags, &res[i]))
+				continue;
+			std::lock_guard<std::mutex> lk(g_DiscLock);
+			g_Disc[ports[i]] = res[i];
+			g_DiscBitrate[ports[i]] = Bitrate;
+			g_DiscValid[ports[i]] = true;
+		}
+	};
+	size_t n = std::count(todo.begin(), todo.end(), 1);
+	if (n > DISC_THREADS_MAX)
+		n = DISC_THREADS_MAX;
+	std::vector<std::thread> threads;
+	try
+	{
+		for (size_t t = 1; t < n; t++)
+			threads.push_back(std::thread(worker));
+	}
+	catch (...)
+	{
+		/* fewer threads: the remaining ones take over */
+	}
+	worker();
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+
+	int found = 0;
+	for (size_t i = 0; i < res.size(); i++)
+		if (res[i].Found == GSV_TRUE)
+			found++;
+	if (Info)
+	{
+		if (ComNos)
+			for (int i = 0; i < Count; i++)
+				Info[i] = res[slot[ComNos[i]]];
+		else
+			for (size_t i = 0; i < res.size(); i++)
+				Info[i] = res[i];
+	}
+	return found;
+}
+
+int CALLTYP GSV86extDiscoverCached(int ComNo, DISC_INFO* Info)
+{
+	if (ComNo < 0 || ComNo >= EXT_COMNO_MAX)
+		return GSV_ERROR;
+	if (!Info)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(g_DiscLock);
+	if (!g_DiscValid[ComNo])
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	*Info = g_Disc[ComNo];
+	return Info->Found;
+}
+
+int CALLTYP GSV86extDiscoverInvalidate(int ComNo)
+{
+	if (ComNo < -1 || ComNo >= EXT_COMNO_MAX)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(g_DiscLock);
+	for (int c = 0; c < EXT_COMNO_MAX; c++)
+		if (ComNo == -1 || c == ComNo)
+			g_DiscValid[c] = false;
+	return GSV_OK;
+}
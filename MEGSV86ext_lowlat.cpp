@@ -0,0 +1,223 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: low-latency poll thread
+************************************************************************************************/
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "winmm.lib")	/* timeBeginPeriod */
+#endif
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "MEGSV86ext_intern.h"
+
+#include <chrono>
+#include <thread>
+
+typedef std::chrono::steady_clock LowLatClock;
+
+struct LowLatThread
+{
+	std::thread Thread;
+	std::atomic<bool> Stop;
+	unsigned long PeriodUs;
+	int Priority;
+	unsigned long long Affinity;
+	unsigned long Flags;
+	std::atomic<uint64_t> Loops;
+	std::atomic<uint64_t> Errors;
+	std::atomic<uint64_t> Late;
+	std::atomic<uint64_t> PollMaxUs;
+	std::atomic<bool> PrioSet;
+};
+
+/* Set priority and affinity of the calling thread. Returns false if refused by the OS. */
+static bool lowLatSetThread(int Priority, unsigned long long Affinity)
+{
+	bool ok = true;
+#ifdef _WIN32
+	if (Priority != LOWLAT_PRIO_NORMAL)
+		ok = SetThreadPriority(GetCurrentThread(), Priority == LOWLAT_PRIO_REALTIME
+			? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST) != 0;
+	if (Affinity)
+		ok = SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)Affinity) != 0 && ok;
+#else
+	if (Priority != LOWLAT_PRIO_NORMAL)
+	{
+		sched_param sp;
+		sp.sched_priority = Priority == LOWLAT_PRIO_REALTIME
+			? sched_get_priority_max(SCHED_FIFO) : sched_get_priority_min(SCHED_FIFO);
+		ok = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0;
+	}
+#ifdef __linux__
+	if (Affinity)
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (int c = 0; c < 64 && c < CPU_SETSIZE; c++)
+			if (Affinity & (1ULL << c))
+				CPU_SET(c, &set);
+		ok = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 && ok;
+	}
+#endif
+#endif
+	return ok;
+}
+
+static void lowLatThread(ExtDevice* Dev, LowLatThread* L)
+{
+	L->PrioSet.store(lowLatSetThread(L->Priority, L->Affinity));
+#ifdef _WIN32
+	/* 1 ms timer resolution for sleeping periods */
+	timeBeginPeriod(1);
+#endif
+	const bool busy = (L->Flags & LOWLAT_FLAG_BUSY) != 0;
+	const std::chrono::microseconds period(L->PeriodUs);
+	/* busy mode: pause after a failed poll, e.g. while the link is lost */
+	const std::chrono::microseconds backoff(L->PeriodUs > LOWLAT_PERIOD_MIN_US ? L->PeriodUs : LOWLAT_PERIOD_MIN_US);
+	LowLatClock::time_point next = LowLatClock::now();
+	while (!L->Stop.load(std::memory_order_relaxed))
+	{
+		LowLatClock::time_point t0 = LowLatClock::now();
+		if (!busy && t0 > next + period)
+		{
+			L->Late.fetch_add(1, std::memory_order_relaxed);
+			next = t0;	/* don't catch up with a burst of polls */
+		}
+		const int frames = extPoll(Dev);
+		if (frames == GSV_ERROR)
+			L->Errors.fetch_add(1, std::memory_order_relaxed);
+		uint64_t us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(LowLatClock::now() - t0).count();
+		if (us > L->PollMaxUs.load(std::memory_order_relaxed))
+			L->PollMaxUs.store(us, std::memory_order_relaxed);
+		L->Loops.fetch_add(1, std::memory_order_relaxed);
+		if (busy)
+		{
+			if (frames == GSV_ERROR)
+				std::this_thread::sleep_for(backoff);
+			else if (frames == 0)
+				std::this_thread::yield();	/* let other threads of the core run until data arrives */
+			continue;
+		}
+		next += period;
+		std::this_thread::sleep_until(next);
+	}
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+void extLowLatFree(ExtDevice* Dev)
+{
+	LowLatThread* L;
+	{
+		std::lock_guard<std::mutex> lk(Dev->Lock);
+		L = Dev->LowLat;
+		Dev->LowLat = NULL;
+	}
+	if (!L)
+		return;
+	L->Stop.store(true);
+	if (L->Thread.joinable())
+		L->Thread.join();
+	delete L;
+}
+
+int CALLTYP GSV86extLowLatStart(int ComNo, unsigned long PeriodUs, int Priority, unsigned long long Affinity,
+	unsigned long flags)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	if ((!(flags & LOWLAT_FLAG_BUSY) && PeriodUs < LOWLAT_PERIOD_MIN_US)
+		|| Priority < LOWLAT_PRIO_NORMAL || Priority > LOWLAT_PRIO_REALTIME)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	if (dev->LowLat)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	LowLatThread* L = new (std::nothrow) LowLatThread();
+	if (!L)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	L->PeriodUs = PeriodUs;
+	L->Priority = Priority;
+	L->Affinity = Affinity;
+	L->Flags = flags;
+	try
+	{
+		L->Thread = std::thread(lowLatThread, dev.get(), L);
+	}
+	catch (...)
+	{
+		delete L;
+		extSetError(ComNo, ERR_INTERNAL_FUNC);
+		return GSV_ERROR;
+	}
+	dev->LowLat = L;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extLowLatStop(int ComNo)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	{
+		std::lock_guard<std::mutex> lk(dev->Lock);
+		if (!dev->LowLat)
+		{
+			extSetError(ComNo, ERR_EXT_WRONG_STATE);
+			return GSV_ERROR;
+		}
+	}
+	extLowLatFree(dev.get());
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extLowLatGetInfo(int ComNo, int Index)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	LowLatThread* L = dev->LowLat;
+	if (!L)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	uint64_t v = 0;
+	switch (Index)
+	{
+	case LOWLAT_INFO_LOOPS:
+		v = L->Loops.load();
+		break;
+	case LOWLAT_INFO_ERRORS:
+		v = L->Errors.load();
+		break;
+	case LOWLAT_INFO_LATE:
+		v = L->Late.load();
+		break;
+	case LOWLAT_INFO_POLL_MAX_US:
+		v = L->PollMaxUs.load();
+		break;
+	case LOWLAT_INFO_PRIO_SET:
+		v = L->PrioSet.load() ? 1 : 0;
+		break;
+	default:
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	return (int)(v & 0x7FFFFFFF);
+}
@@ -0,0 +1,575 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: network streaming server
+************************************************************************************************/
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+
+#include "MEGSV86ext_intern.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+typedef SOCKET sock_t;
+#define SOCK_INVALID INVALID_SOCKET
+#define sockClose closesocket
+#define NET_SEND_FLAGS 0
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int sock_t;
+#define SOCK_INVALID (-1)
+#define sockClose close
+#ifdef MSG_NOSIGNAL
+#define NET_SEND_FLAGS MSG_NOSIGNAL	/* a client closing its connection must not raise SIGPIPE */
+#else
+#define NET_SEND_FLAGS 0		/* SO_NOSIGPIPE set per socket instead */
+#endif
+#endif
+
+#define NET_READ_FRAMES	256	/* frames read through the cursor per call */
+#define NET_SELECT_US	2000	/* server loop period while idle */
+#define NET_SEND_TIMEOUT_MS	1000	/* TCP clients not accepting data for this time are disconnected */
+#define NET_TX_QUEUE_MAX	(1 << 20)	/* TCP clients with more bytes pending are disconnected */
+
+struct NetClient
+{
+	sock_t Sock;
+	sockaddr_in Peer;
+	bool Subscribed;
+	int Cur;			/* reader cursor handle, 0 if none */
+	NET_SUBSCRIBE Sub;
+	int NumSel;
+	int Sel[VALOBJ_NUM_MAX];	/* 0-based indices of objects sent */
+	unsigned int Seq;
+	uint64_t Next;			/* next frame number to send (decimation) */
+	/* packet being filled */
+	std::vector<char> Pkt;
+	int PktFrames;
+	uint64_t PktFirst;
+	std::chrono::steady_clock::time_point PktStart;
+	/* partially received NET_SUBSCRIBE */
+	char Rx[sizeof(NET_SUBSCRIBE)];
+	size_t RxLen;
+	/* bytes not yet accepted by the TCP connection */
+	std::vector<char> Tx;
+	size_t TxOff;
+	std::chrono::steady_clock::time_point TxProgress;	/* last time any byte was sent */
+};
+
+struct NetServer
+{
+	std::thread Thread;
+	std::atomic<bool> Stop;
+	sock_t Listen;
+	sock_t Udp;
+	int Port;
+	NetClient Client[NET_CLIENT_MAX];
+	std::vector<double> Buf;
+	std::atomic<int> Clients;
+	std::atomic<uint64_t> Packets;
+	std::atomic<uint64_t> Bytes;
+};
+
+static void netDropClient(ExtDevice* Dev, NetServer* N, NetClient* C)
+{
+	N->Clients--;
+	sockClose(C->Sock);
+	C->Sock = SOCK_INVALID;
+	if (C->Cur > 0)
+		extCursorDelete(Dev, C->Cur);
+	C->Cur = 0;
+	C->Subscribed = false;
+	std::vector<char>().swap(C->Tx);
+	C->TxOff = 0;
+}
+
+static bool sockWouldBlock()
+{
+#ifdef _WIN32
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR;
+#endif
+}
+
+static bool sockNonBlocking(sock_t S)
+{
+#ifdef _WIN32
+	u_long on = 1;
+	return ioctlsocket(S, FIONBIO, &on) == 0;
+#else
+	int fl = fcntl(S, F_GETFL, 0);
+	return fl != -1 && fcntl(S, F_SETFL, fl | O_NONBLOCK) == 0;
+#endif
+}
+
+/* Send as much of p as the connection accepts now. Returns the number of bytes sent, -1 on error. */
+static long netSendSome(sock_t S, const char* p, size_t len)
+{
+	size_t sent = 0;
+	while (sent < len)
+	{
+		int n = send(S, p + sent, (int)(len - sent), NET_SEND_FLAGS);
+		if (n < 0 && sockWouldBlock())
+			break;
+		if (n <= 0)
+			return -1;
+		sent += (size_t)n;
+	}
+	return (long)sent;
+}
+
+/* Send pending bytes of a client. Returns false if the client is to be dropped. */
+static bool netTxFlush(NetClient* C)
+{
+	if (C->TxOff == C->Tx.size())
+		return true;
+	long n = netSendSome(C->Sock, C->Tx.data() + C->TxOff, C->Tx.size() - C->TxOff);
+	if (n < 0)
+		return false;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (n > 0)
+		C->TxProgress = now;
+	C->TxOff += (size_t)n;
+	if (C->TxOff == C->Tx.size())
+	{
+		C->Tx.clear();
+		C->TxOff = 0;
+		return true;
+	}
+	return now - C->TxProgress < std::chrono::milliseconds(NET_SEND_TIMEOUT_MS);
+}
+
+/* Send p to a TCP client without blocking, queueing what the connection doesn't accept now.
+   Returns false if the client is to be dropped (connection error or lagging behind). */
+static bool netSendAll(NetClient* C, const char* p, size_t len)
+{
+	if (!netTxFlush(C))
+		return false;
+	if (C->Tx.empty())
+	{
+		long n = netSendSome(C->Sock, p, len);
+		if (n < 0)
+			return false;
+		C->TxProgress = std::chrono::steady_clock::now();	/* the timeout starts with the queue */
+		p += n;
+		len -= (size_t)n;
+		if (len == 0)
+			return true;
+	}
+	if (C->Tx.size() - C->TxOff + len > NET_TX_QUEUE_MAX)
+		return false;
+	try
+	{
+		C->Tx.insert(C->Tx.end(), p, p + len);
+	}
+	catch (...)
+	{
+		return false;
+	}
+	return true;
+}
+
+static bool netFlush(NetServer* N, NetClient* C)
+{
+	if (C->PktFrames == 0)
+		return true;
+	NET_PACKET_HEADER* h = (NET_PACKET_HEADER*)C->Pkt.data();
+	h->Magic = NET_MAGIC_DATA;
+	h->Seq = C->Seq++;
+	h->FirstFrame = C->PktFirst;
+	h->NumFrames = (unsigned short)C->PktFrames;
+	h->NumObj = (unsigned char)C->NumSel;
+	h->Format = C->Sub.Format;
+	size_t len = sizeof(NET_PACKET_HEADER)
+		+ (size_t)C->PktFrames * C->NumSel * (C->Sub.Format == NET_FORMAT_FLOAT ? sizeof(float) : sizeof(double));
+	C->PktFrames = 0;
+	bool ok;
+	if (C->Sub.Transport == NET_TRANSPORT_UDP)
+	{
+		sockaddr_in to = C->Peer;
+		to.sin_port = htons(C->Sub.UdpPort);
+		/* a lost datagram is visible to the client by Seq */
+		sendto(N->Udp, C->Pkt.data(), (int)len, NET_SEND_FLAGS, (const sockaddr*)&to, sizeof(to));
+		ok = true;
+	}
+	else
+		ok = netSendAll(C, C->Pkt.data(), len);
+	N->Packets++;
+	N->Bytes += len;
+	return ok;
+}
+
+static bool netSubscribe(ExtDevice* Dev, NetClient* C, int Slot)
+{
+	NET_SUBSCRIBE sub;
+	memcpy(&sub, C->Rx, sizeof(sub));
+	if (sub.Magic != NET_MAGIC_SUB || sub.Version != NET_PROT_VER
+		|| sub.Format > NET_FORMAT_FLOAT || sub.Transport > NET_TRANSPORT_UDP
+		|| (sub.Transport == NET_TRANSPORT_UDP && sub.UdpPort == 0))
+		return false;
+
+	const int num = Dev->NumObj;
+	if (sub.ObjMask == 0)
+		sub.ObjMask = (1u << num) - 1;
+	C->NumSel = 0;
+	for (int o = 0; o < num; o++)
+		if (sub.ObjMask & (1u << o))
+			C->Sel[C->NumSel++] = o;
+	if (C->NumSel == 0)
+		return false;
+	sub.ObjMask &= (1u << num) - 1;
+	if (sub.Decimation == 0)
+		sub.Decimation = 1;
+	const size_t vsize = sub.Format == NET_FORMAT_FLOAT ? sizeof(float) : sizeof(double);
+	const size_t fsize = vsize * C->NumSel;
+	size_t maxFpp = (NET_UDP_PAYLOAD_MAX - sizeof(NET_PACKET_HEADER)) / fsize;
+	if (sub.Transport == NET_TRANSPORT_TCP && sub.FramesPerPacket != 0)
+		maxFpp = 0xFFFF;
+	if (sub.FramesPerPacket == 0 || sub.FramesPerPacket > maxFpp)
+		sub.FramesPerPacket = (unsigned short)maxFpp;
+	C->Sub = sub;
+	C->Pkt.assign(sizeof(NET_PACKET_HEADER) + sub.FramesPerPacket * fsize, 0);
+	C->PktFrames = 0;
+	C->Next = 0;
+
+	if (C->Cur <= 0)
+	{
+		char name[CURSOR_NAME_SIZE];
+		snprintf(name, sizeof(name), "net%d", Slot);
+		C->Cur = extCursorCreate(Dev, name, CURSOR_FLAG_NONBLOCKING);
+		if (C->Cur == GSV_ERROR)
+		{
+			C->Cur = 0;
+			return false;
+		}
+	}
+
+	NET_STREAM_INFO info;
+	memset(&info, 0, sizeof(info));
+	info.Magic = NET_MAGIC_SUB;
+	info.Version = NET_PROT_VER;
+	info.Format = sub.Format;
+	info.Transport = sub.Transport;
+	info.NumObjDevice = (unsigned char)num;
+	info.NumObj = (unsigned char)C->NumSel;
+	info.DataType = (unsigned char)Dev->DataType;
+	info.ObjMask = sub.ObjMask;
+	info.Decimation = sub.Decimation;
+	info.FramesPerPacket = sub.FramesPerPacket;
+	info.Frequency = Dev->Frequency;
+	for (int i = 0; i < C->NumSel; i++)
+	{
+		info.ScaleFactors[i] = Dev->ScaleFactors[C->Sel[i]];
+		info.ObjMapping[i] = (unsigned int)Dev->ObjMapping[C->Sel[i]];
+	}
+	C->Subscribed = true;
+	return netSendAll(C, (const char*)&info, sizeof(info));
+}
+
+/* Move new frames of one client into packets */
+static bool netPump(ExtDevice* Dev, NetServer* N, NetClient* C)
+{
+	const int num = Dev->NumObj;
+	const bool flt = C->Sub.Format == NET_FORMAT_FLOAT;
+	const size_t fsize = (flt ? sizeof(float) : sizeof(double)) * C->NumSel;
+	for (;;)
+	{
+		uint64_t first;
+		int n = extCursorReadFrames(Dev, C->Cur, N->Buf.data(), NET_READ_FRAMES, &first);
+		if (n <= 0)
+			break;
+		for (int i = 0; i < n; i++)
+		{
+			uint64_t f = first + i;
+			if (f < C->Next)
+				continue;
+			if (C->PktFrames > 0 && f != C->Next)
+			{
+				/* gap by cursor overrun: packet frames must be equidistant */
+				if (!netFlush(N, C))
+					return false;
+			}
+			if (C->PktFrames == 0)
+			{
+				C->PktFirst = f;
+				C->PktStart = std::chrono::steady_clock::now();
+			}
+			const double* src = &N->Buf[(size_t)i * num];
+			char* dst = C->Pkt.data() + sizeof(NET_PACKET_HEADER) + (size_t)C->PktFrames * fsize;
+			for (int k = 0; k < C->NumSel; k++)
+			{
+				if (flt)
+				{
+					float v = (float)src[C->Sel[k]];
+					memcpy(dst + k * sizeof(float), &v, sizeof(float));
+				}
+				else
+					memcpy(dst + k * sizeof(double), &src[C->Sel[k]], sizeof(double));
+			}
+			C->PktFrames++;
+			C->Next = f + C->Sub.Decimation;
+			if (C->PktFrames == C->Sub.FramesPerPacket && !netFlush(N, C))
+				return false;
+		}
+		if (n < NET_READ_FRAMES)
+			break;
+	}
+	if (C->PktFrames > 0 && std::chrono::steady_clock::now() - C->PktStart >= std::chrono::milliseconds(NET_FLUSH_MS))
+		return netFlush(N, C);
+	return true;
+}
+
+static void netAccept(NetServer* N)
+{
+	sockaddr_in peer;
+	socklen_t plen = sizeof(peer);
+	sock_t s = accept(N->Listen, (sockaddr*)&peer, &plen);
+	if (s == SOCK_INVALID)
+		return;
+	for (int i = 0; i < NET_CLIENT_MAX; i++)
+	{
+		NetClient* C = &N->Client[i];
+		if (C->Sock != SOCK_INVALID)
+			continue;
+		/* one server thread serves all clients: a slow one must not block the others */
+		if (!sockNonBlocking(s))
+			break;
+		int one = 1;
+		setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+		setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, (const char*)&one, sizeof(one));
+#endif
+		N->Clients++;
+		C->Sock = s;
+		C->Peer = peer;
+		C->Subscribed = false;
+		C->RxLen = 0;
+		C->Seq = 0;
+		C->Tx.clear();
+		C->TxOff = 0;
+		return;
+	}
+	sockClose(s);	/* all slots in use */
+}
+
+static void netThread(ExtDevice* Dev, NetServer* N)
+{
+	while (!N->Stop.load())
+	{
+		fd_set rd, wr;
+		FD_ZERO(&rd);
+		FD_ZERO(&wr);
+		FD_SET(N->Listen, &rd);
+		sock_t maxs = N->Listen;
+		for (int i = 0; i < NET_CLIENT_MAX; i++)
+			if (N->Client[i].Sock != SOCK_INVALID)
+			{
+				FD_SET(N->Client[i].Sock, &rd);
+				if (!N->Client[i].Tx.empty())
+					FD_SET(N->Client[i].Sock, &wr);
+				if (N->Client[i].Sock > maxs)
+					maxs = N->Client[i].Sock;
+			}
+		timeval tv = { 0, NET_SELECT_US };
+		int ready = select((int)maxs + 1, &rd, &wr, NULL, &tv);
+		if (ready > 0 && FD_ISSET(N->Listen, &rd))
+			netAccept(N);
+		for (int i = 0; i < NET_CLIENT_MAX; i++)
+		{
+			NetClient* C = &N->Client[i];
+			if (C->Sock == SOCK_INVALID)
+				continue;
+			if (ready > 0 && FD_ISSET(C->Sock, &rd))
+			{
+				int n = recv(C->Sock, C->Rx + C->RxLen, (int)(sizeof(C->Rx) - C->RxLen), 0);
+				if (n <= 0)
+				{
+					netDropClient(Dev, N, C);
+					continue;
+				}
+				C->RxLen += (size_t)n;
+				if (C->RxLen == sizeof(C->Rx))
+				{
+					C->RxLen = 0;
+					if (!netSubscribe(Dev, C, i))
+					{
+						netDropClient(Dev, N, C);
+						continue;
+					}
+				}
+			}
+			if (!netTxFlush(C) || (C->Subscribed && !netPump(Dev, N, C)))
+				netDropClient(Dev, N, C);
+		}
+	}
+}
+
+static void netClose(ExtDevice* Dev, NetServer* N)
+{
+	N->Stop.store(true);
+	if (N->Thread.joinable())
+		N->Thread.join();
+	for (int i = 0; i < NET_CLIENT_MAX; i++)
+		if (N->Client[i].Sock != SOCK_INVALID)
+			netDropClient(Dev, N, &N->Client[i]);
+	if (N->Listen != SOCK_INVALID)
+		sockClose(N->Listen);
+	if (N->Udp != SOCK_INVALID)
+		sockClose(N->Udp);
+#ifdef _WIN32
+	WSACleanup();
+#endif
+	delete N;
+}
+
+void extNetFree(ExtDevice* Dev)
+{
+	NetServer* N;
+	{
+		std::lock_guard<std::mutex> lk(Dev->Lock);
+		N = Dev->Net;
+		Dev->Net = NULL;
+	}
+	if (N)
+		netClose(Dev, N);
+}
+
+int CALLTYP GSV86extNetStart(int ComNo, int Port, unsigned long flags)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	if (Port == 0)
+		Port = NET_PORT_DEF;
+	if (Port < 1 || Port > 0xFFFF)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	/* check and install dev->Net in one critical section: concurrent starts can't both succeed */
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	if (dev->Net)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+#ifdef _WIN32
+	WSADATA wsa;
+	if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+	{
+		extSetError(ComNo, ERR_INTERNAL_FUNC);
+		return GSV_ERROR;
+	}
+#endif
+	NetServer* N = new (std::nothrow) NetServer();
+	if (!N)
+	{
+#ifdef _WIN32
+		WSACleanup();
+#endif
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	N->Port = Port;
+	N->Udp = SOCK_INVALID;
+	for (int i = 0; i < NET_CLIENT_MAX; i++)
+		N->Client[i].Sock = SOCK_INVALID;
+	N->Buf.assign((size_t)NET_READ_FRAMES * dev->NumObj, 0.0);
+
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((unsigned short)Port);
+	/* the stream is not authenticated: exposed to the network only on request */
+	const bool any = (flags & NET_FLAG_ALL_INTERFACES) && !(flags & NET_FLAG_LOCALHOST);
+	addr.sin_addr.s_addr = htonl(any ? INADDR_ANY : INADDR_LOOPBACK);
+	int one = 1;
+	N->Listen = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (N->Listen == SOCK_INVALID
+		|| setsockopt(N->Listen, SOL_SOCKET, SO_REUSEADDR, (const char*)&one, sizeof(one)) != 0
+		|| bind(N->Listen, (const sockaddr*)&addr, sizeof(addr)) != 0
+		|| listen(N->Listen, NET_CLIENT_MAX) != 0
+		|| !sockNonBlocking(N->Listen)
+		|| (N->Udp = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == SOCK_INVALID
+		|| !sockNonBlocking(N->Udp))
+	{
+		netClose(dev.get(), N);
+		extSetError(ComNo, ERR_INTERNAL_FUNC);
+		return GSV_ERROR;
+	}
+	try
+	{
+		N->Thread = std::thread(netThread, dev.get(), N);
+	}
+	catch (...)
+	{
+		netClose(dev.get(), N);
+		extSetError(ComNo, ERR_INTERNAL_FUNC);
+		return GSV_ERROR;
+	}
+	dev->Net = N;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extNetStop(int ComNo)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	{
+		std::lock_guard<std::mutex> lk(dev->Lock);
+		if (!dev->Net)
+		{
+			extSetError(ComNo, ERR_EXT_WRONG_STATE);
+			return GSV_ERROR;
+		}
+	}
+	extNetFree(dev.get());
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extNetGetInfo(int ComNo, int Index)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	NetServer* N = dev->Net;
+	if (!N)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	uint64_t v = 0;
+	switch (Index)
+	{
+	case NET_INFO_CLIENTS:
+		v = (uint64_t)N->Clients.load();
+		break;
+	case NET_INFO_PACKETS:
+		v = N->Packets.load();
+		break;
+	case NET_INFO_KBYTES:
+		v = N->Bytes.load() / 1024;
+		break;
+	case NET_INFO_PORT:
+		v = (uint64_t)N->Port;
+		break;
+	default:
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	return (int)(v & 0x7FFFFFFF);
+}
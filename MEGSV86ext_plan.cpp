@@ -0,0 +1,142 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: link bandwidth planner and data rate admission check
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <cfloat>
+
+/* Bitrate of the link checked against, =0: no UART limit (USB) */
+static double planMax(unsigned long Bitrate, int DataType, int NumObj)
+{
+	if (Bitrate == 0)
+		return DBL_MAX;
+	const int bytes = PLAN_FRAME_OVERHEAD + NumObj * extValueBytes(DataType);
+	return (double)Bitrate * PLAN_LOAD_MAX / ((double)bytes * PLAN_UART_BITS_PER_BYTE);
+}
+
+double CALLTYP GSV86extPlanMaxFrequency(unsigned long Bitrate, int DataType, int NumObj)
+{
+	if (!extValueBytes(DataType) || NumObj < 1 || NumObj > VALOBJ_NUM_MAX)
+	{
+		extSetError(0, ERR_WRONG_PARAMETER);
+		return (double)GSV_ERROR;
+	}
+	return planMax(Bitrate ? Bitrate : CONST_BAUDRATE, DataType, NumObj);
+}
+
+/* Bitrate to check against: the given one, or that of the actual interface if 0, where USB-CDC
+   has no UART limit (0 returned) */
+static int planBitrate(int ComNo, unsigned long* Bitrate)
+{
+	if (*Bitrate)
+		return GSV_OK;
+	int phys = 0;
+	if (extLinkQuery(ComNo, Bitrate, &phys) == GSV_ERROR)
+		return GSV_ERROR;
+	if (phys == INTF_PHY_TYP_USB)
+		*Bitrate = 0;
+	return GSV_OK;
+}
+
+/* Actual data type, number of objects and device data rate limit */
+static int planQuery(int ComNo, int* DataType, int* NumObj, double* DrateMax)
+{
+	int num = GSV86getValObjectInfo(ComNo, NULL, NULL, DataType);
+	if (num == GSV_ERROR)
+	{
+		extSetDllError(ComNo);
+		return GSV_ERROR;
+	}
+	if (num < 1 || num > VALOBJ_NUM_MAX || !extValueBytes(*DataType))
+	{
+		extSetError(ComNo, ERR_UNKNOWN_VALUE);
+		return GSV_ERROR;
+	}
+	*NumObj = num;
+	double dmin;
+	if (GSV86getDataRateRange(ComNo, DrateMax, &dmin) == GSV_ERROR)
+	{
+		extSetDllError(ComNo);
+		return GSV_ERROR;
+	}
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extPlanCheck(int ComNo, unsigned long Bitrate, double Frequency, double* MaxFrequency)
+{
+	int dt, num;
+	double drmax;
+	if (planQuery(ComNo, &dt, &num, &drmax) == GSV_ERROR || planBitrate(ComNo, &Bitrate) == GSV_ERROR)
+		return GSV_ERROR;
+	double fmax = planMax(Bitrate, dt, num);
+	if (fmax > drmax)
+		fmax = drmax;
+	if (MaxFrequency)
+		*MaxFrequency = fmax;
+	return Frequency <= fmax ? GSV_TRUE : GSV_OK;
+}
+
+int CALLTYP GSV86extPlanRecommend(int ComNo, unsigned long Bitrate, double Frequency, int* DataType, int* NumObj)
+{
+	if (!DataType || !NumObj)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	int dt, num;
+	double drmax;
+	if (planQuery(ComNo, &dt, &num, &drmax) == GSV_ERROR || planBitrate(ComNo, &Bitrate) == GSV_ERROR)
+		return GSV_ERROR;
+	if (Frequency > drmax)
+	{
+		extSetError(ComNo, ERR_EXT_BANDWIDTH);
+		return GSV_ERROR;
+	}
+	*DataType = dt;
+	*NumObj = num;
+	if (Frequency <= planMax(Bitrate, dt, num))
+		return GSV_TRUE;
+
+	/* narrower data types with all objects, widest first */
+	static const int types[] = { DATATYP_FLOAT, DATATYP_INT24, DATATYP_INT16 };
+	for (int i = 0; i < 3; i++)
+	{
+		if (extValueBytes(types[i]) >= extValueBytes(dt))
+			continue;
+		if (Frequency <= planMax(Bitrate, types[i], num))
+		{
+			*DataType = types[i];
+			return GSV_OK;
+		}
+	}
+	/* fewer objects with the narrowest type */
+	for (int n = num - 1; n >= 1; n--)
+	{
+		if (Frequency <= planMax(Bitrate, DATATYP_INT16, n))
+		{
+			*DataType = DATATYP_INT16;
+			*NumObj = n;
+			return GSV_OK;
+		}
+	}
+	extSetError(ComNo, ERR_EXT_BANDWIDTH);
+	return GSV_ERROR;
+}
+
+int CALLTYP GSV86extSetFrequencyChecked(int ComNo, unsigned long Bitrate, double Frequency)
+{
+	int ret = GSV86extPlanCheck(ComNo, Bitrate, Frequency, NULL);
+	if (ret == GSV_ERROR)
+		return GSV_ERROR;
+	if (ret == GSV_OK)
+	{
+		extSetError(ComNo, ERR_EXT_BANDWIDTH);
+		return GSV_ERROR;
+	}
+	if (GSV86setFrequency(ComNo, Frequency) == GSV_ERROR)
+	{
+		extSetDllError(ComNo);
+		return GSV_ERROR;
+	}
+	return GSV_OK;
+}
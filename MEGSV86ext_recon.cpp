@@ -0,0 +1,297 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: automatic reconnection after link loss
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#define ERROR_ACCESS_DENIED	5L
+#define ERROR_INVALID_HANDLE	6L
+#define ERROR_BAD_COMMAND	22L
+#define ERROR_GEN_FAILURE	31L
+#define ERROR_OPERATION_ABORTED	995L
+#define ERROR_DEVICE_NOT_CONNECTED	1167L
+#endif
+
+/* System errors of the port, as reported by the DLL ORed with OWN_ERR_MASK (see GSV86getLastProtocollError).
+   ERR_COM_GEN_FAILURE is the DLL's own code for ERROR_GEN_FAILURE and checked besides these. */
+#define RECON_ERR_ACCESS_DENIED	(OWN_ERR_MASK | ERROR_ACCESS_DENIED)	/* port vanished and was re-enumerated */
+#define RECON_ERR_INVALID_HANDLE	(OWN_ERR_MASK | ERROR_INVALID_HANDLE)
+#define RECON_ERR_BAD_COMMAND	(OWN_ERR_MASK | ERROR_BAD_COMMAND)	/* device no longer recognizes the request */
+#define RECON_ERR_GEN_FAILURE	(OWN_ERR_MASK | ERROR_GEN_FAILURE)
+#define RECON_ERR_OPERATION_ABORTED	(OWN_ERR_MASK | ERROR_OPERATION_ABORTED)
+#define RECON_ERR_NOT_CONNECTED	(OWN_ERR_MASK | ERROR_DEVICE_NOT_CONNECTED)
+
+typedef std::chrono::steady_clock ReconClock;
+
+struct ReconState
+{
+	unsigned long Bitrate;
+	unsigned long BufSize;
+	unsigned long Flags;
+	int SerNo;			/* serial number at enabling */
+	bool TxOn;			/* value transmission was on at enabling */
+	bool Down;			/* link lost, port released */
+	bool Changed;			/* other device answered, reconnection stopped */
+	bool Busy;			/* re-activation in progress without Dev->Lock held */
+	ReconClock::time_point LostAt;
+	ReconClock::time_point NextTry;
+	uint64_t Reconnects;
+	uint64_t Attempts;
+	/* ring of recorded gaps */
+	uint64_t GapFrame[RECON_GAP_MAX];
+	double GapSec[RECON_GAP_MAX];
+	uint64_t Gaps;			/* total gaps recorded */
+};
+
+static bool reconIsLinkError(int Err)
+{
+	switch (Err)
+	{
+	case ERR_COM_GEN_FAILURE:
+	case RECON_ERR_ACCESS_DENIED:
+	case RECON_ERR_INVALID_HANDLE:
+	case RECON_ERR_BAD_COMMAND:
+	case RECON_ERR_GEN_FAILURE:
+	case RECON_ERR_OPERATION_ABORTED:
+	case RECON_ERR_NOT_CONNECTED:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Device answering after re-activation has the same serial number, value object layout and data type.
+   Called without Dev->Lock held: NumObj, ObjMapping and DataType don't change after GSV86extAttach.
+   Sf receives the current scale factors. */
+static bool reconSameDevice(const ExtDevice* Dev, int SerNo, double* Sf)
+{
+	if (GSV86getSerialNo(Dev->ComNo) != SerNo)
+		return false;
+	unsigned long map[VALOBJ_NUM_MAX];
+	int dtype = 0;
+	int num = GSV86getValObjectInfo(Dev->ComNo, Sf, map, &dtype);
+	if (num != Dev->NumObj || dtype != Dev->DataType)
+		return false;
+	return memcmp(map, Dev->ObjMapping, sizeof(unsigned long) * num) == 0;
+}
+
+/* Record a gap before frame FrameCount, optionally as a NaN frame */
+static void reconRecordGap(ExtDevice* Dev)
+{
+	ReconState* R = Dev->Recon;
+	uint64_t first = Dev->FrameCount.load(std::memory_order_relaxed);
+	size_t g = (size_t)(R->Gaps % RECON_GAP_MAX);
+	R->GapFrame[g] = first;
+	R->GapSec[g] = std::chrono::duration<double>(ReconClock::now() - R->LostAt).count();
+	R->Gaps++;
+	if ((R->Flags & RECON_FLAG_GAP_NAN) && extCursorWritable(Dev) > 0)
+	{
+		double* f = &Dev->Ring[(size_t)(first & Dev->RingMask) * Dev->NumObj];
+		for (int o = 0; o < Dev->NumObj; o++)
+			f[o] = std::numeric_limits<double>::quiet_NaN();
+		Dev->FrameCount.store(first + 1, std::memory_order_release);
+		extSnapPublish(Dev, first, extNowNs());
+		if (Dev->Shm)
+			extShmUpdate(Dev);
+		extTrigProcess(Dev, first, 1);
+	}
+}
+
+int extReconService(ExtDevice* Dev)
+{
+	unsigned long bitrate, bufsize, actflags;
+	int ser;
+	bool txon;
+	{
+		std::lock_guard<std::mutex> lk(Dev->Lock);
+		ReconState* R = Dev->Recon;
+		if (!R)
+			return GSV_TRUE;
+		if (R->Changed)
+		{
+			extSetError(Dev->ComNo, ERR_EXT_DEVICE_CHANGED);
+			return GSV_ERROR;
+		}
+		if (!R->Down)
+			return GSV_TRUE;
+		ReconClock::time_point now = ReconClock::now();
+		if (R->Busy || now < R->NextTry)
+			return GSV_OK;
+		R->NextTry = now + std::chrono::milliseconds(RECON_RETRY_MS);
+		R->Busy = true;
+		bitrate = R->Bitrate;
+		bufsize = R->BufSize;
+		actflags = R->Flags & ~(unsigned long)RECON_FLAG_GAP_NAN;
+		ser = R->SerNo;
+		txon = R->TxOn;
+	}
+
+	/* activation may last the whole answer timeout: without Dev->Lock, so that cursor readers,
+	   triggers and GetLatest consumers are not blocked meanwhile */
+	double sf[VALOBJ_NUM_MAX];
+	int res = GSV_TRUE;
+	if (GSV86activateExtended(Dev->ComNo, bitrate, bufsize, actflags) == GSV_ERROR)
+		res = GSV_OK;
+	else if (!reconSameDevice(Dev, ser, sf))
+	{
+		GSV86release(Dev->ComNo);
+		res = GSV_ERROR;
+	}
+	else if (txon && GSV86startTX(Dev->ComNo) == GSV_ERROR)
+	{
+		GSV86release(Dev->ComNo);
+		res = GSV_OK;
+	}
+
+	std::lock_guard<std::mutex> lk(Dev->Lock);
+	ReconState* R = Dev->Recon;
+	if (!R || !R->Busy)
+		return res == GSV_TRUE ? GSV_TRUE : GSV_OK;	/* disabled meanwhile */
+	R->Busy = false;
+	if (res == GSV_OK)
+	{
+		R->Attempts++;
+		return GSV_OK;
+	}
+	if (res == GSV_ERROR)
+	{
+		R->Changed = true;
+		extSetError(Dev->ComNo, ERR_EXT_DEVICE_CHANGED);
+		return GSV_ERROR;
+	}
+	/* scale factors may follow a changed configuration; keep them current for the stages and readers */
+	memcpy(Dev->ScaleFactors, sf, sizeof(double) * Dev->NumObj);
+	extShmUpdateMeta(Dev);
+	reconRecordGap(Dev);
+	R->Down = false;
+	R->Reconnects++;
+	return GSV_TRUE;
+}
+
+bool extReconLinkLost(ExtDevice* Dev)
+{
+	ReconState* R = Dev->Recon;
+	if (!reconIsLinkError(GSV86getLastProtocollError(Dev->ComNo)))
+		return false;
+	GSV86release(Dev->ComNo);
+	R->Down = true;
+	R->LostAt = ReconClock::now();
+	R->NextTry = R->LostAt;
+	return true;
+}
+
+void extReconFree(ExtDevice* Dev)
+{
+	delete Dev->Recon;
+	Dev->Recon = NULL;
+}
+
+int CALLTYP GSV86extReconnectEnable(int ComNo, unsigned long Bitrate, unsigned long BufSize, unsigned long flags)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	int ser = GSV86getSerialNo(ComNo);
+	int tx = GSV86getTXmode(ComNo, 0);
+	if (ser == GSV_ERROR || tx == GSV_ERROR)
+	{
+		extSetDllError(ComNo);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	if (!dev->Recon)
+	{
+		dev->Recon = new (std::nothrow) ReconState();
+		if (!dev->Recon)
+		{
+			extSetError(ComNo, ERR_MEM_ALLOC);
+			return GSV_ERROR;
+		}
+	}
+	ReconState* R = dev->Recon;
+	R->Bitrate = Bitrate ? Bitrate : CONST_BAUDRATE;
+	R->BufSize = BufSize ? BufSize : CONST_BUFSIZE;
+	R->Flags = flags;
+	R->SerNo = ser;
+	R->TxOn = !(tx & 1);
+	R->Changed = false;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extReconnectDisable(int ComNo)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	extReconFree(dev.get());
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extReconnectGetInfo(int ComNo, int Index)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	ReconState* R = dev->Recon;
+	if (!R)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	uint64_t v = 0;
+	switch (Index)
+	{
+	case RECON_INFO_STATE:
+		v = R->Down ? 1 : 0;
+		break;
+	case RECON_INFO_RECONNECTS:
+		v = R->Reconnects;
+		break;
+	case RECON_INFO_ATTEMPTS:
+		v = R->Attempts;
+		break;
+	case RECON_INFO_GAPS:
+		v = R->Gaps;
+		break;
+	default:
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	return (int)(v & 0x7FFFFFFF);
+}
+
+int CALLTYP GSV86extReconnectGetGaps(int ComNo, unsigned long long* Frame, double* Seconds, int Max)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	if (!Frame || Max < 0)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	ReconState* R = dev->Recon;
+	if (!R)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	uint64_t first = R->Gaps > RECON_GAP_MAX ? R->Gaps - RECON_GAP_MAX : 0;
+	int n = 0;
+	for (uint64_t g = first; g < R->Gaps && n < Max; g++, n++)
+	{
+		Frame[n] = R->GapFrame[g % RECON_GAP_MAX];
+		if (Seconds)
+			Seconds[n] = R->GapSec[g % RECON_GAP_MAX];
+	}
+	return n;
+}
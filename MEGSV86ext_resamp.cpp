@@ -0,0 +1,279 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: polyphase resampling subscribers
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <cmath>
+
+#define RESAMP_KAISER_BETA 8.0	/* approx. 80dB stop band attenuation */
+#define RESAMP_STOPBAND_EDGE 1.5	/* stop band checked from this multiple of the cut-off: alias-free up to half of it */
+#define RESAMP_STOPBAND_DB 60.0	/* minimum stop band attenuation accepted by GSV86extResampCreate */
+#define RESAMP_CHECK_FINE 128	/* frequencies checked at the stop band edge, spaced half a side lobe */
+#define RESAMP_CHECK_COARSE 64	/* frequencies checked up to Nyquist */
+#define RESAMP_COEFF_MAX (1 << 20)	/* prototype length Up*Taps per branch */
+
+static const double PI = 3.14159265358979323846;
+
+struct ResampSub
+{
+	int Up;
+	int Down;
+	int Taps;			/* per branch: Taps parameter * max(Up,Down) / Up, rounded up */
+	unsigned long Flags;
+	std::vector<double> Coeff;	/* Up branches of Taps coefficients: Coeff[Phase*Taps+k] */
+	uint64_t Base;			/* newest input frame used for the next output frame */
+	int Phase;			/* polyphase branch for the next output frame, 0..Up-1 */
+	uint64_t Overruns;
+};
+
+static ResampSub* resampGet(ExtDevice* Dev, int Sub)
+{
+	if (Sub < 1 || Sub > RESAMP_NUM_MAX || !Dev->Resamp[Sub - 1])
+	{
+		extSetError(Dev->ComNo, ERR_EXT_WRONG_HANDLE);
+		return NULL;
+	}
+	return Dev->Resamp[Sub - 1];
+}
+
+/* Modified Bessel function of first kind, order 0 (power series) */
+static double besselI0(double x)
+{
+	double sum = 1.0, term = 1.0, q = x * x / 4.0;
+	for (int k = 1; k < 50 && term > 1e-12 * sum; k++)
+	{
+		term *= q / ((double)k * k);
+		sum += term;
+	}
+	return sum;
+}
+
+/* Attenuation in dB of the low pass h at normalized frequency f, relative to DC gain Dc */
+static double resampAtten(const std::vector<double>& h, double Dc, double f)
+{
+	/* H(f) = sum h[i]*exp(-j*2*pi*f*i), the phasor rotated by multiplication */
+	const double cr = cos(2.0 * PI * f), ci = -sin(2.0 * PI * f);
+	double pr = 1.0, pq = 0.0, re = 0.0, im = 0.0;
+	for (size_t i = 0; i < h.size(); i++)
+	{
+		re += h[i] * pr;
+		im += h[i] * pq;
+		const double t = pr * cr - pq * ci;
+		pq = pr * ci + pq * cr;
+		pr = t;
+	}
+	const double mag = sqrt(re * re + im * im) / Dc;
+	return mag > 0.0 ? -20.0 * log10(mag) : 1000.0;
+}
+
+/* Kaiser-windowed sinc low pass of Up*R->Taps coefficients, sorted into Up polyphase branches.
+   DC gain of each branch is 1 (overall gain Up compensates the zero-stuffing).
+   Returns the lowest attenuation in dB from RESAMP_STOPBAND_EDGE times the cut-off upwards. */
+static double resampDesign(ResampSub* R)
+{
+	const int L = R->Up > R->Down ? R->Up : R->Down;
+	const int n = R->Up * R->Taps;
+	const double fc = 0.5 / L;
+	const double c = (n - 1) / 2.0;
+	const double i0b = besselI0(RESAMP_KAISER_BETA);
+	std::vector<double> h(n);
+	double sum = 0.0;
+	for (int i = 0; i < n; i++)
+	{
+		double t = i - c;
+		double x = 2.0 * fc * t;
+		double sinc = (t == 0.0) ? 1.0 : sin(PI * x) / (PI * x);
+		double r = (n > 1) ? t / c : 0.0;
+		double w = besselI0(RESAMP_KAISER_BETA * sqrt(fmax(0.0, 1.0 - r * r))) / i0b;
+		h[i] = 2.0 * fc * sinc * w;
+		sum += h[i];
+	}
+	R->Coeff.resize(n);
+	for (int p = 0; p < R->Up; p++)
+		for (int k = 0; k < R->Taps; k++)
+			R->Coeff[p * R->Taps + k] = h[p + k * R->Up] * R->Up / sum;
+
+	/* stop band: main lobe side of the transition band closely, the rest up to Nyquist coarsely */
+	const double edge = RESAMP_STOPBAND_EDGE * fc;
+	double worst = 1000.0;
+	for (int j = 0; j < RESAMP_CHECK_FINE && edge + j * 0.5 / n < 0.5; j++)
+		worst = fmin(worst, resampAtten(h, sum, edge + j * 0.5 / n));
+	for (int j = 0; j <= RESAMP_CHECK_COARSE; j++)
+		worst = fmin(worst, resampAtten(h, sum, edge + (0.5 - edge) * j / RESAMP_CHECK_COARSE));
+	return worst;
+}
+
+/* Number of output frames computable with frames up to FrameCount-1 */
+static uint64_t resampAvailable(const ResampSub* R, uint64_t FrameCount)
+{
+	if (R->Base >= FrameCount)
+		return 0;
+	uint64_t span = (FrameCount - R->Base) * (uint64_t)R->Up - (uint64_t)R->Phase;
+	return (span + R->Down - 1) / R->Down;
+}
+
+/* Move cursor forward, if frames it needs were already overwritten in the ring */
+static void resampCheckOverrun(const ExtDevice* Dev, ResampSub* R, uint64_t FrameCount)
+{
+	if (FrameCount <= Dev->RingFrames)
+		return;
+	uint64_t oldest = FrameCount - Dev->RingFrames;
+	if (R->Base < oldest + R->Taps - 1)
+	{
+		R->Base = oldest + R->Taps - 1;
+		R->Phase = 0;
+		R->Overruns++;
+	}
+}
+
+void extResampFreeAll(ExtDevice* Dev)
+{
+	for (int s = 0; s < RESAMP_NUM_MAX; s++)
+	{
+		delete Dev->Resamp[s];
+		Dev->Resamp[s] = NULL;
+	}
+}
+
+int CALLTYP GSV86extResampCreate(int ComNo, int Up, int Down, int Taps, unsigned long flags)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	if (Taps == 0)
+		Taps = RESAMP_TAPS_DEF;
+	if (Up < 1 || Up > RESAMP_UP_MAX || Down < 1 || Down > RESAMP_DOWN_MAX || Taps < 1 || Taps > RESAMP_TAPS_MAX)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	/* the filter must span Taps periods of the lower cut-off: when decimating, it grows with Down */
+	const uint64_t L = (uint64_t)(Up > Down ? Up : Down);
+	const uint64_t branch = ((uint64_t)Taps * L + Up - 1) / Up;
+	if (branch * Up > RESAMP_COEFF_MAX || branch + EXT_PULL_FRAMES > dev->RingFrames)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	int ix = 0;
+	while (ix < RESAMP_NUM_MAX && dev->Resamp[ix])
+		ix++;
+	if (ix == RESAMP_NUM_MAX)
+	{
+		extSetError(ComNo, ERR_EXT_NO_RESOURCE);
+		return GSV_ERROR;
+	}
+	ResampSub* R = new (std::nothrow) ResampSub();
+	if (!R)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	R->Up = Up;
+	R->Down = Down;
+	R->Taps = (int)branch;
+	R->Flags = flags;
+	double atten;
+	try
+	{
+		atten = resampDesign(R);
+	}
+	catch (...)
+	{
+		delete R;
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	if (atten < RESAMP_STOPBAND_DB)
+	{
+		delete R;	/* Taps too low: transition band reaches into the checked stop band */
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	R->Base = dev->FrameCount.load(std::memory_order_relaxed);
+	R->Phase = 0;
+	dev->Resamp[ix] = R;
+	return ix + 1;
+}
+
+int CALLTYP GSV86extResampRead(int ComNo, int Sub, double* out, int count, int* valsread)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	ResampSub* R = resampGet(dev.get(), Sub);
+	if (!R)
+		return GSV_ERROR;
+	const int num = dev->NumObj;
+	if (!out || !valsread || count <= 0 || count % num)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	const uint64_t fc = dev->FrameCount.load(std::memory_order_relaxed);
+	resampCheckOverrun(dev.get(), R, fc);
+	uint64_t n = resampAvailable(R, fc);
+	if (n > (uint64_t)(count / num))
+		n = (uint64_t)(count / num);
+
+	const double* scale = (R->Flags & RESAMP_FLAG_SCALED) ? dev->ScaleFactors : NULL;
+	const int taps = R->Taps;
+	double acc[VALOBJ_NUM_MAX];
+	for (uint64_t i = 0; i < n; i++, out += num)
+	{
+		dev->Kern->FirFrame(dev.get(), R->Base, &R->Coeff[(size_t)R->Phase * taps], taps, scale ? acc : out);
+		if (scale)
+			dev->Kern->ScaleFrames(out, acc, scale, 1);
+
+		R->Phase += R->Down;
+		R->Base += (uint64_t)(R->Phase / R->Up);
+		R->Phase %= R->Up;
+	}
+	*valsread = (int)n * num;
+	return n ? GSV_TRUE : GSV_OK;
+}
+
+int CALLTYP GSV86extResampGetInfo(int ComNo, int Sub, int Index)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	ResampSub* R = resampGet(dev.get(), Sub);
+	if (!R)
+		return GSV_ERROR;
+	const uint64_t fc = dev->FrameCount.load(std::memory_order_relaxed);
+	uint64_t v;
+	switch (Index)
+	{
+	case RESAMP_INFO_AVAILABLE:
+		v = resampAvailable(R, fc);
+		break;
+	case RESAMP_INFO_LAG:
+		v = fc > R->Base ? fc - R->Base : 0;
+		break;
+	case RESAMP_INFO_OVERRUNS:
+		v = R->Overruns;
+		break;
+	default:
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	return (int)(v > 0x7FFFFFFF ? 0x7FFFFFFF : v);
+}
+
+int CALLTYP GSV86extResampDelete(int ComNo, int Sub)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	ResampSub* R = resampGet(dev.get(), Sub);
+	if (!R)
+		return GSV_ERROR;
+	delete R;
+	dev->Resamp[Sub - 1] = NULL;
+	return GSV_OK;
+}
@@ -0,0 +1,330 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: parallel sensor and TEDS scan
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <thread>
+
+/* Background scan, see GSV86extScanStart */
+struct ScanThread
+{
+	std::thread Thread;
+	std::mutex Lock;
+	std::condition_variable Wake;
+	bool Stop;
+	std::vector<int> Ports;		/* empty: attached ComNos */
+	unsigned long PeriodMs;
+	unsigned long Flags;
+	EXT_SCAN_CHANGED Callback;
+	void* User;
+};
+
+static SCAN_INFO g_Scan[EXT_COMNO_MAX];	/* last result per ComNo, ScanNo=0: not scanned yet */
+static std::mutex g_ScanLock;
+static std::mutex g_ScanRunLock;	/* held for a whole scan: one command sequence per device at a time */
+static ScanThread* g_ScanThread;
+static std::mutex g_ScanThreadLock;
+
+/* ComNos to scan: ComNos[0..Count-1] without duplicates (first occurrence kept, so one device
+   is never scanned by two workers at once), or the attached ones if ComNos is NULL */
+static bool scanPorts(const int* ComNos, int Count, std::vector<int>& Ports)
+{
+	try
+	{
+		if (ComNos)
+		{
+			bool seen[EXT_COMNO_MAX] = { false };
+			for (int i = 0; i < Count; i++)
+			{
+				const int c = ComNos[i];
+				if (c >= 0 && c < EXT_COMNO_MAX)
+				{
+					if (seen[c])
+						continue;
+					seen[c] = true;
+				}
+				Ports.push_back(c);
+			}
+		}
+		else
+			for (int c = 0; c < EXT_COMNO_MAX; c++)
+				if (extFindDevice(c))
+					Ports.push_back(c);
+	}
+	catch (...)
+	{
+		extSetError(0, ERR_MEM_ALLOC);
+		return false;
+	}
+	return true;
+}
+
+static void scanDevice(int ComNo, unsigned long flags, SCAN_INFO* Info)
+{
+	memset(Info, 0, sizeof(*Info));
+	Info->ComNo = ComNo;
+	Info->Result = GSV_ERROR;
+	int bridge = 0, teds = 0;
+	if (GSV86getSensorPlugged(ComNo, 0, &bridge, &teds) == GSV_ERROR)
+	{
+		extSetDllError(ComNo);
+		Info->ErrCode = GSV86extGetLastError(ComNo);
+		return;
+	}
+	int active = 0;
+	if (!(flags & SCAN_FLAG_NO_ACTIVE))
+	{
+		active = GSV86getTEDSactive(ComNo, 0);
+		if (active == GSV_ERROR)
+		{
+			extSetDllError(ComNo);
+			Info->ErrCode = GSV86extGetLastError(ComNo);
+			return;
+		}
+	}
+	Info->Bridge = bridge & 0xFF;
+	Info->TedsPresent = teds & 0xFF;
+	Info->TedsWritable = (teds >> 8) & 0xFF;
+	Info->TedsActive = active & 0xFF;
+	extTedsPlugged(ComNo, Info->TedsPresent);
+	const unsigned long tflags = (flags & SCAN_FLAG_VERIFY_ID) ? TEDS_FLAG_VERIFY_ID : 0;
+	for (int c = 1; c <= TEDS_CHAN_MAX; c++)
+	{
+		const int bit = 1 << (c - 1);
+		if (!(Info->TedsPresent & bit))
+			continue;
+		unsigned long long id = 0;
+		if (GSV86extTedsRead(ComNo, c, tflags) == GSV_ERROR || GSV86extTedsGetId(ComNo, c, &id, NULL) == GSV_ERROR)
+			Info->TedsError |= bit;	/* e.g. blank EEPROM: the other channels are still reported */
+		else
+			Info->SensorId[c - 1] = id;
+	}
+	Info->Result = GSV_OK;
+}
+
+/* Store the result of a scan and set Changed and ScanNo */
+static void scanStore(SCAN_INFO* Info)
+{
+	std::lock_guard<std::mutex> lk(g_ScanLock);
+	const SCAN_INFO& last = g_Scan[Info->ComNo];
+	if (Info->Result == GSV_OK)
+	{
+		if (!last.ScanNo || last.Result != GSV_OK)
+			Info->Changed = Info->Bridge | Info->TedsPresent;
+		else
+		{
+			Info->Changed = (Info->Bridge ^ last.Bridge) | (Info->TedsPresent ^ last.TedsPresent);
+			for (int c = 0; c < TEDS_CHAN_MAX; c++)
+				if (Info->SensorId[c] != last.SensorId[c])
+					Info->Changed |= 1 << c;
+		}
+	}
+	else if (last.ScanNo && last.Result == GSV_OK)
+		Info->Changed = last.Bridge | last.TedsPresent;	/* sensors of the vanished device are gone */
+	if (last.ScanNo && Info->Result != last.Result)
+		Info->Changed |= SCAN_CHANGED_RESULT;
+	Info->ScanNo = last.ScanNo + 1;
+	g_Scan[Info->ComNo] = *Info;
+}
+
+/* Scan Ports in parallel. Returns the number of devices scanned successfully. */
+static int scanRun(const std::vector<int>& Ports, unsigned long flags, std::vector<SCAN_INFO>& Res)
+{
+	std::lock_guard<std::mutex> run(g_ScanRunLock);
+	std::atomic<size_t> next(0);
+	auto worker = [&]()
+	{
+		for (size_t i; (i = next.fetch_add(1)) < Ports.size(); )
+		{
+			scanDevice(Ports[i], flags, &Res[i]);
+			scanStore(&Res[i]);
+		}
+	};
+	size_t n = Ports.size() < SCAN_THREADS_MAX ? Ports.size() : SCAN_THREADS_MAX;
+	std::vector<std::thread> threads;
+	try
+	{
+		for (size_t t = 1; t < n; t++)
+			threads.push_back(std::thread(worker));
+	}
+	catch (...)
+	{
+		/* fewer threads: the remaining ones take over */
+	}
+	worker();
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+	int ok = 0;
+	for (size_t i = 0; i < Res.size(); i++)
+		if (Res[i].Result == GSV_OK)
+			ok++;
+	return ok;
+}
+
+int CALLTYP GSV86extScan(const int* ComNos, int Count, unsigned long flags, SCAN_INFO* Info)
+{
+	if (ComNos && Count < 0)
+	{
+		extSetError(0, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::vector<int> ports;
+	if (!scanPorts(ComNos, Count, ports))
+		return GSV_ERROR;
+	for (size_t i = 0; i < ports.size(); i++)
+		if (ports[i] < 0 || ports[i] >= EXT_COMNO_MAX)
+		{
+			extSetError(0, ERR_WRONG_COMNO);
+			return GSV_ERROR;
+		}
+	std::vector<SCAN_INFO> res;
+	try
+	{
+		res.resize(ports.size());
+	}
+	catch (...)
+	{
+		extSetError(0, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	int ok = scanRun(ports, flags, res);
+	if (Info && ComNos)
+	{
+		/* one entry per element of ComNos, also for duplicates */
+		int slot[EXT_COMNO_MAX];
+		for (size_t i = 0; i < ports.size(); i++)
+			slot[ports[i]] = (int)i;
+		for (int i = 0; i < Count; i++)
+			Info[i] = res[slot[ComNos[i]]];
+	}
+	else if (Info && !res.empty())
+		memcpy(Info, res.data(), res.size() * sizeof(SCAN_INFO));
+	return ok;
+}
+
+int CALLTYP GSV86extScanGet(int ComNo, SCAN_INFO* Info)
+{
+	if (ComNo < 0 || ComNo >= EXT_COMNO_MAX)
+		return GSV_ERROR;
+	if (!Info)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(g_ScanLock);
+	if (!g_Scan[ComNo].ScanNo)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	*Info = g_Scan[ComNo];
+	return GSV_OK;
+}
+
+static void scanThread(ScanThread* S)
+{
+	std::vector<int> ports;
+	std::vector<SCAN_INFO> res;
+	std::unique_lock<std::mutex> lk(S->Lock);
+	while (!S->Stop)
+	{
+		const std::chrono::steady_clock::time_point due =
+			std::chrono::steady_clock::now() + std::chrono::milliseconds(S->PeriodMs);
+		lk.unlock();
+		ports.clear();
+		bool ok = S->Ports.empty() ? scanPorts(NULL, 0, ports) : scanPorts(S->Ports.data(), (int)S->Ports.size(), ports);
+		if (ok)
+		{
+			try
+			{
+				res.resize(ports.size());
+			}
+			catch (...)
+			{
+				ok = false;
+			}
+		}
+		if (ok)
+		{
+			scanRun(ports, S->Flags, res);
+			if (S->Callback)
+				for (size_t i = 0; i < res.size(); i++)
+					if (res[i].Changed)
+						S->Callback(&res[i], S->User);
+		}
+		lk.lock();
+		S->Wake.wait_until(lk, due, [S]() { return S->Stop; });
+	}
+}
+
+int CALLTYP GSV86extScanStart(const int* ComNos, int Count, unsigned long PeriodMs, unsigned long flags,
+	EXT_SCAN_CHANGED Callback, void* User)
+{
+	if ((ComNos && Count <= 0) || PeriodMs < SCAN_PERIOD_MIN_MS)
+	{
+		extSetError(0, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	for (int i = 0; ComNos && i < Count; i++)
+		if (ComNos[i] < 0 || ComNos[i] >= EXT_COMNO_MAX)
+		{
+			extSetError(0, ERR_WRONG_COMNO);
+			return GSV_ERROR;
+		}
+	std::lock_guard<std::mutex> lk(g_ScanThreadLock);
+	if (g_ScanThread)
+	{
+		extSetError(0, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	ScanThread* S = new (std::nothrow) ScanThread();
+	if (!S)
+	{
+		extSetError(0, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	S->Stop = false;
+	S->PeriodMs = PeriodMs;
+	S->Flags = flags;
+	S->Callback = Callback;
+	S->User = User;
+	try
+	{
+		if (ComNos)
+			S->Ports.assign(ComNos, ComNos + Count);
+		S->Thread = std::thread(scanThread, S);
+	}
+	catch (...)
+	{
+		delete S;
+		extSetError(0, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	g_ScanThread = S;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extScanStop(void)
+{
+	ScanThread* S;
+	{
+		std::lock_guard<std::mutex> lk(g_ScanThreadLock);
+		S = g_ScanThread;
+		g_ScanThread = NULL;
+	}
+	if (!S)
+	{
+		extSetError(0, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	{
+		std::lock_guard<std::mutex> lk(S->Lock);
+		S->Stop = true;
+	}
+	S->Wake.notify_all();
+	S->Thread.join();
+	delete S;
+	return GSV_OK;
+}
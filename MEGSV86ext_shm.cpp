@@ -0,0 +1,479 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: shared memory publication of the host frame ring
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define SHM_DATA_ALIGN 64
+#define SHM_SEQ_SPIN 64	/* busy reads of an odd Seq before the reader yields */
+#define SHM_SEQ_WAIT_MS 100	/* Seq odd longer than this: publisher died within shmWriteMeta */
+
+/* Mapping of one named segment */
+struct ShmMap
+{
+	void* Base;
+	size_t Size;
+	char Name[SHM_NAME_SIZE];
+#ifdef _WIN32
+	HANDLE hMap;
+#else
+	int fd;
+#endif
+};
+
+struct ShmPublisher
+{
+	ShmMap Map;
+	SHM_HEADER* Hdr;
+};
+
+struct ShmReader
+{
+	bool Used;
+	ShmMap Map;
+	const SHM_HEADER* Hdr;
+};
+
+static ShmReader g_Reader[SHM_READER_MAX];
+static std::mutex g_ReaderLock;
+
+template <class T> static std::atomic<T>* shmAtomic(volatile T* p)
+{
+	static_assert(sizeof(std::atomic<T>) == sizeof(T), "atomic not layout compatible");
+	return reinterpret_cast<std::atomic<T>*>(const_cast<T*>(p));
+}
+
+template <class T> static const std::atomic<T>* shmAtomic(const volatile T* p)
+{
+	return reinterpret_cast<const std::atomic<T>*>(const_cast<const T*>(p));
+}
+
+#ifndef _WIN32
+/* Segment Name (with '/') was left behind by a publisher that ended without unlinking it.
+   A live publisher holds an flock on its segment, which the OS releases if the process dies.
+   Windows needs no such check: a mapping disappears with the last handle. */
+static bool shmStale(const char* Name)
+{
+	int fd = shm_open(Name, O_RDWR, 0);
+	if (fd < 0)
+		return errno == ENOENT;		/* removed meanwhile */
+	bool stale;
+	if (flock(fd, LOCK_EX | LOCK_NB) == 0)
+		stale = true;
+	else if (errno == EWOULDBLOCK)
+		stale = false;
+	else
+	{
+		/* flock not supported for shared memory: trust the header */
+		struct stat st;
+		void* p;
+		if (fstat(fd, &st) != 0)
+			stale = false;
+		else if ((size_t)st.st_size < sizeof(SHM_HEADER))
+			stale = true;
+		else if ((p = mmap(NULL, sizeof(SHM_HEADER), PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED)
+			stale = false;
+		else
+		{
+			const SHM_HEADER* H = (const SHM_HEADER*)p;
+			stale = H->Magic != SHM_MAGIC || H->State != SHM_STATE_LIVE;
+			munmap(p, sizeof(SHM_HEADER));
+		}
+	}
+	close(fd);
+	return stale;
+}
+#endif
+
+static bool shmCreate(ShmMap* M, const char* Name, size_t Size)
+{
+	memset(M, 0, sizeof(*M));
+	M->Size = Size;
+#ifdef _WIN32
+	snprintf(M->Name, sizeof(M->Name), "Local\\%s", Name);
+	M->hMap = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+		(DWORD)((unsigned long long)Size >> 32), (DWORD)(Size & 0xFFFFFFFF), M->Name);
+	if (!M->hMap)
+		return false;
+	if (GetLastError() == ERROR_ALREADY_EXISTS)
+	{
+		CloseHandle(M->hMap);
+		return false;
+	}
+	M->Base = MapViewOfFile(M->hMap, FILE_MAP_ALL_ACCESS, 0, 0, Size);
+	if (!M->Base)
+	{
+		CloseHandle(M->hMap);
+		return false;
+	}
+#else
+	snprintf(M->Name, sizeof(M->Name), "/%s", Name);
+	M->fd = shm_open(M->Name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (M->fd < 0 && errno == EEXIST && shmStale(M->Name))
+	{
+		shm_unlink(M->Name);
+		M->fd = shm_open(M->Name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	}
+	if (M->fd < 0)
+		return false;
+	flock(M->fd, LOCK_EX | LOCK_NB);	/* marks the segment live, see shmStale */
+	if (ftruncate(M->fd, (off_t)Size) != 0)
+	{
+		close(M->fd);
+		shm_unlink(M->Name);
+		return false;
+	}
+	M->Base = mmap(NULL, Size, PROT_READ | PROT_WRITE, MAP_SHARED, M->fd, 0);
+	if (M->Base == MAP_FAILED)
+	{
+		close(M->fd);
+		shm_unlink(M->Name);
+		return false;
+	}
+#endif
+	return true;
+}
+
+static bool shmOpenReadOnly(ShmMap* M, const char* Name)
+{
+	memset(M, 0, sizeof(*M));
+#ifdef _WIN32
+	snprintf(M->Name, sizeof(M->Name), "Local\\%s", Name);
+	M->hMap = OpenFileMappingA(FILE_MAP_READ, FALSE, M->Name);
+	if (!M->hMap)
+		return false;
+	M->Base = MapViewOfFile(M->hMap, FILE_MAP_READ, 0, 0, 0);
+	if (!M->Base)
+	{
+		CloseHandle(M->hMap);
+		return false;
+	}
+	MEMORY_BASIC_INFORMATION mbi;
+	M->Size = VirtualQuery(M->Base, &mbi, sizeof(mbi)) ? mbi.RegionSize : 0;
+#else
+	snprintf(M->Name, sizeof(M->Name), "/%s", Name);
+	M->fd = shm_open(M->Name, O_RDONLY, 0);
+	if (M->fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(M->fd, &st) != 0)
+	{
+		close(M->fd);
+		return false;
+	}
+	M->Size = (size_t)st.st_size;
+	M->Base = mmap(NULL, M->Size, PROT_READ, MAP_SHARED, M->fd, 0);
+	if (M->Base == MAP_FAILED)
+	{
+		close(M->fd);
+		return false;
+	}
+#endif
+	return true;
+}
+
+static void shmClose(ShmMap* M, bool Owner)
+{
+#ifdef _WIN32
+	(void)Owner;
+	UnmapViewOfFile(M->Base);
+	CloseHandle(M->hMap);
+#else
+	munmap(M->Base, M->Size);
+	close(M->fd);
+	if (Owner)
+		shm_unlink(M->Name);
+#endif
+	M->Base = NULL;
+}
+
+/* Write NumObj..RingFrames under the sequence lock */
+static void shmWriteMeta(const ExtDevice* Dev, SHM_HEADER* H)
+{
+	std::atomic<unsigned long>* seq = shmAtomic(&H->Seq);
+	unsigned long s = seq->load(std::memory_order_relaxed);
+	seq->store(s + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	H->NumObj = Dev->NumObj;
+	H->DataType = Dev->DataType;
+	H->Frequency = Dev->Frequency;
+	memcpy(H->ScaleFactors, Dev->ScaleFactors, sizeof(H->ScaleFactors));
+	memcpy(H->ObjMapping, Dev->ObjMapping, sizeof(H->ObjMapping));
+	H->RingFrames = Dev->RingFrames;
+	seq->store(s + 2, std::memory_order_release);
+}
+
+void extShmUpdate(ExtDevice* Dev)
+{
+	shmAtomic(&Dev->Shm->Hdr->FrameCount)->store(Dev->FrameCount.load(std::memory_order_relaxed),
+		std::memory_order_release);
+}
+
+void extShmUpdateMeta(ExtDevice* Dev)
+{
+	if (Dev->Shm)
+		shmWriteMeta(Dev, Dev->Shm->Hdr);
+}
+
+void extShmFree(ExtDevice* Dev)
+{
+	ShmPublisher* P = Dev->Shm;
+	if (!P)
+		return;
+	memcpy(Dev->RingHeap.data(), Dev->Ring, Dev->RingHeap.size() * sizeof(double));
+	Dev->Ring = Dev->RingHeap.data();
+	shmAtomic(&P->Hdr->State)->store(SHM_STATE_CLOSED, std::memory_order_release);
+	shmClose(&P->Map, true);
+	delete P;
+	Dev->Shm = NULL;
+}
+
+int CALLTYP GSV86extShmPublish(int ComNo, const char* Name)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	char name[SHM_NAME_SIZE];
+	if (Name)
+	{
+		if (!Name[0] || strlen(Name) >= SHM_NAME_SIZE || strpbrk(Name, "/\\"))
+		{
+			extSetError(ComNo, ERR_WRONG_PARAMETER);
+			return GSV_ERROR;
+		}
+		strcpy(name, Name);
+	}
+	else
+		snprintf(name, sizeof(name), SHM_NAME_DEF, ComNo);
+
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	if (dev->Shm)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	ShmPublisher* P = new (std::nothrow) ShmPublisher();
+	if (!P)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	const size_t offs = (sizeof(SHM_HEADER) + SHM_DATA_ALIGN - 1) / SHM_DATA_ALIGN * SHM_DATA_ALIGN;
+	const size_t ringBytes = dev->RingHeap.size() * sizeof(double);
+	if (!shmCreate(&P->Map, name, offs + ringBytes))
+	{
+		delete P;
+		extSetError(ComNo, ERR_INTERNAL_FUNC);
+		return GSV_ERROR;
+	}
+	SHM_HEADER* H = (SHM_HEADER*)P->Map.Base;
+	H->Magic = SHM_MAGIC;
+	H->LayoutVer = SHM_LAYOUT_VER;
+	H->DataOffset = offs;
+	shmWriteMeta(dev.get(), H);
+	double* ring = (double*)((char*)P->Map.Base + offs);
+	memcpy(ring, dev->Ring, ringBytes);
+	P->Hdr = H;
+	dev->Ring = ring;
+	dev->Shm = P;
+	extShmUpdate(dev.get());
+	shmAtomic(&H->State)->store(SHM_STATE_LIVE, std::memory_order_release);
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extShmUnpublish(int ComNo)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	if (!dev->Shm)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	extShmFree(dev.get());
+	return GSV_OK;
+}
+
+/* Reader side. Errors are stored for ComNo 0. */
+static ShmReader* shmReaderGet(int Handle)
+{
+	if (Handle < 1 || Handle > SHM_READER_MAX || !g_Reader[Handle - 1].Used)
+	{
+		extSetError(0, ERR_EXT_WRONG_HANDLE);
+		return NULL;
+	}
+	return &g_Reader[Handle - 1];
+}
+
+/* Header of a segment of Size bytes is valid, and the ring it describes lies within the segment */
+static bool shmGeometryValid(const SHM_HEADER* H, size_t Size)
+{
+	if (Size < sizeof(SHM_HEADER) || H->Magic != SHM_MAGIC || H->LayoutVer != SHM_LAYOUT_VER)
+		return false;
+	const uint64_t rf = H->RingFrames, offs = H->DataOffset;
+	if (H->NumObj < 1 || H->NumObj > VALOBJ_NUM_MAX || rf == 0 || (rf & (rf - 1)) || offs < sizeof(SHM_HEADER) || offs > Size)
+		return false;
+	return (Size - offs) / sizeof(double) / (uint64_t)H->NumObj >= rf;
+}
+
+int CALLTYP GSV86extShmOpen(const char* Name)
+{
+	if (!Name || !Name[0] || strlen(Name) >= SHM_NAME_SIZE)
+	{
+		extSetError(0, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(g_ReaderLock);
+	int ix = 0;
+	while (ix < SHM_READER_MAX && g_Reader[ix].Used)
+		ix++;
+	if (ix == SHM_READER_MAX)
+	{
+		extSetError(0, ERR_EXT_NO_RESOURCE);
+		return GSV_ERROR;
+	}
+	ShmReader* R = &g_Reader[ix];
+	if (!shmOpenReadOnly(&R->Map, Name))
+	{
+		extSetError(0, ERR_EXT_NOT_ATTACHED);
+		return GSV_ERROR;
+	}
+	R->Hdr = (const SHM_HEADER*)R->Map.Base;
+	if (!shmGeometryValid(R->Hdr, R->Map.Size))
+	{
+		shmClose(&R->Map, false);
+		extSetError(0, ERR_FILE_CONTENT);
+		return GSV_ERROR;
+	}
+	R->Used = true;
+	return ix + 1;
+}
+
+int CALLTYP GSV86extShmGetInfo(int Handle, double* ScaleFactors, unsigned long* ObjMapping, int* DataType, double* Frequency)
+{
+	std::lock_guard<std::mutex> lk(g_ReaderLock);
+	ShmReader* R = shmReaderGet(Handle);
+	if (!R)
+		return GSV_ERROR;
+	const SHM_HEADER* H = R->Hdr;
+	const std::atomic<unsigned long>* seq = shmAtomic(&H->Seq);
+	SHM_HEADER copy;
+	const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+	int spins = 0;
+	for (;;)
+	{
+		unsigned long s1 = seq->load(std::memory_order_acquire);
+		if (s1 & 1)
+		{
+			if (++spins < SHM_SEQ_SPIN)
+				continue;
+			if (std::chrono::steady_clock::now() - t0 > std::chrono::milliseconds(SHM_SEQ_WAIT_MS))
+			{
+				extSetError(0, ERR_EXT_WRONG_STATE);
+				return GSV_ERROR;
+			}
+			std::this_thread::yield();
+			continue;
+		}
+		copy.NumObj = H->NumObj;
+		copy.DataType = H->DataType;
+		copy.Frequency = H->Frequency;
+		memcpy(copy.ScaleFactors, H->ScaleFactors, sizeof(copy.ScaleFactors));
+		memcpy(copy.ObjMapping, H->ObjMapping, sizeof(copy.ObjMapping));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (seq->load(std::memory_order_relaxed) == s1)
+			break;
+	}
+	if (ScaleFactors)
+		memcpy(ScaleFactors, copy.ScaleFactors, sizeof(copy.ScaleFactors));
+	if (ObjMapping)
+		memcpy(ObjMapping, copy.ObjMapping, sizeof(copy.ObjMapping));
+	if (DataType)
+		*DataType = copy.DataType;
+	if (Frequency)
+		*Frequency = copy.Frequency;
+	return copy.NumObj;
+}
+
+int CALLTYP GSV86extShmRead(int Handle, unsigned long long* Pos, double* out, int count, int* valsread)
+{
+	std::lock_guard<std::mutex> lk(g_ReaderLock);
+	ShmReader* R = shmReaderGet(Handle);
+	if (!R)
+		return GSV_ERROR;
+	const SHM_HEADER* H = R->Hdr;
+	/* ring geometry does not change while the segment exists */
+	const int num = H->NumObj;
+	const uint64_t rf = H->RingFrames;
+	if (!Pos || !out || !valsread || num < 1 || count <= 0 || count % num)
+	{
+		extSetError(0, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	const double* ring = (const double*)((const char*)H + H->DataOffset);
+	const std::atomic<unsigned long long>* fcp = shmAtomic(&H->FrameCount);
+
+	uint64_t fc = fcp->load(std::memory_order_acquire);
+	if (*Pos == SHM_POS_NEWEST || *Pos > fc)
+		*Pos = fc;
+	uint64_t oldest = fc + EXT_PULL_FRAMES > rf ? fc + EXT_PULL_FRAMES - rf : 0;
+	if (*Pos < oldest)
+		*Pos = oldest;
+	uint64_t n = fc - *Pos;
+	if (n > (uint64_t)(count / num))
+		n = (uint64_t)(count / num);
+	for (uint64_t i = 0; i < n; i++)
+		memcpy(out + i * num, ring + (size_t)((*Pos + i) & (rf - 1)) * num, num * sizeof(double));
+
+	/* drop frames overwritten by the publisher while copying */
+	std::atomic_thread_fence(std::memory_order_acquire);
+	fc = fcp->load(std::memory_order_relaxed);
+	oldest = fc + EXT_PULL_FRAMES > rf ? fc + EXT_PULL_FRAMES - rf : 0;
+	if (*Pos < oldest)
+	{
+		uint64_t bad = oldest - *Pos;
+		if (bad > n)
+			bad = n;
+		memmove(out, out + bad * num, (size_t)(n - bad) * num * sizeof(double));
+		n -= bad;
+		*Pos += bad;
+	}
+	*Pos += n;
+	*valsread = (int)n * num;
+	return n ? GSV_TRUE : GSV_OK;
+}
+
+const SHM_HEADER* CALLTYP GSV86extShmGetHeader(int Handle)
+{
+	std::lock_guard<std::mutex> lk(g_ReaderLock);
+	ShmReader* R = shmReaderGet(Handle);
+	return R ? R->Hdr : NULL;
+}
+
+int CALLTYP GSV86extShmClose(int Handle)
+{
+	std::lock_guard<std::mutex> lk(g_ReaderLock);
+	ShmReader* R = shmReaderGet(Handle);
+	if (!R)
+		return GSV_ERROR;
+	shmClose(&R->Map, false);
+	R->Used = false;
+	R->Hdr = NULL;
+	return GSV_OK;
+}
@@ -0,0 +1,273 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: latency statistics
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <cstring>
+
+#define STATS_SUB	(1 << STATS_SUB_BITS)
+#define STATS_MAX_SHIFT	(STATS_BUCKETS / STATS_SUB - 2)
+
+struct ExtStats
+{
+	std::atomic<bool> Active;
+	ExtHist Hist[STATS_HIST_NUM];
+	uint64_t LastPoll;		/* start of the last GSV86extPoll, =0: none */
+	std::vector<uint64_t> InsTime;	/* per ring slot: extNowNs() when the frame became visible */
+};
+
+static int statsIndex(uint64_t v)
+{
+	if (v < 2 * STATS_SUB)
+		return (int)v;
+	int msb = 0;
+	for (uint64_t t = v; t > 1; t >>= 1)
+		msb++;
+	int shift = msb - STATS_SUB_BITS;
+	if (shift > STATS_MAX_SHIFT)
+		return STATS_BUCKETS - 1;
+	return 2 * STATS_SUB + (shift - 1) * STATS_SUB + (int)(v >> shift) - STATS_SUB;
+}
+
+/* Highest value falling into bucket Ix */
+static uint64_t statsUpper(int Ix)
+{
+	if (Ix < 2 * STATS_SUB)
+		return (uint64_t)Ix;
+	int k = Ix - 2 * STATS_SUB;
+	int shift = k / STATS_SUB + 1;
+	uint64_t top = (uint64_t)(k % STATS_SUB + STATS_SUB);
+	return ((top + 1) << shift) - 1;
+}
+
+void extHistAdd(ExtHist* H, uint64_t v, uint64_t N)
+{
+	H->Bucket[statsIndex(v)].fetch_add(N, std::memory_order_relaxed);
+	H->Count.fetch_add(N, std::memory_order_relaxed);
+	H->Sum.fetch_add(v * N, std::memory_order_relaxed);
+	uint64_t m = H->Min.load(std::memory_order_relaxed);
+	while (v < m && !H->Min.compare_exchange_weak(m, v, std::memory_order_relaxed))
+		;
+	m = H->Max.load(std::memory_order_relaxed);
+	while (v > m && !H->Max.compare_exchange_weak(m, v, std::memory_order_relaxed))
+		;
+}
+
+void extHistClear(ExtHist* H)
+{
+	for (int i = 0; i < STATS_BUCKETS; i++)
+		H->Bucket[i].store(0, std::memory_order_relaxed);
+	H->Count.store(0, std::memory_order_relaxed);
+	H->Sum.store(0, std::memory_order_relaxed);
+	H->Min.store(UINT64_MAX, std::memory_order_relaxed);
+	H->Max.store(0, std::memory_order_relaxed);
+}
+
+void extHistSummary(const ExtHist* H, STATS_LATENCY* Stats)
+{
+	/* copy the buckets first; the total is taken from them, so percentiles stay consistent
+	   while samples are added concurrently */
+	static const double us = 1e-3;
+	uint64_t cnt[STATS_BUCKETS];
+	uint64_t n = 0;
+	for (int i = 0; i < STATS_BUCKETS; i++)
+		n += cnt[i] = H->Bucket[i].load(std::memory_order_relaxed);
+	memset(Stats, 0, sizeof(*Stats));
+	Stats->Count = n;
+	if (n == 0)
+		return;
+	uint64_t hc = H->Count.load(std::memory_order_relaxed);
+	Stats->Min = H->Min.load(std::memory_order_relaxed) * us;
+	Stats->Max = H->Max.load(std::memory_order_relaxed) * us;
+	Stats->Mean = hc ? (double)H->Sum.load(std::memory_order_relaxed) / hc * us : 0.0;
+	const double pct[4] = { 0.5, 0.9, 0.99, 0.999 };
+	double* dst[4] = { &Stats->P50, &Stats->P90, &Stats->P99, &Stats->P999 };
+	uint64_t acc = 0;
+	int p = 0;
+	for (int i = 0; i < STATS_BUCKETS && p < 4; i++)
+	{
+		acc += cnt[i];
+		while (p < 4 && acc >= (uint64_t)(pct[p] * n + 0.5) && acc > 0)
+		{
+			*dst[p] = (double)statsUpper(i) * us;
+			p++;
+		}
+	}
+	for (; p < 4; p++)
+		*dst[p] = Stats->Max;
+}
+
+int extHistBuckets(const ExtHist* H, double* UpperUs, unsigned long long* Counts, int Max)
+{
+	int n = 0;
+	for (int i = 0; i < STATS_BUCKETS && n < Max; i++)
+	{
+		uint64_t c = H->Bucket[i].load(std::memory_order_relaxed);
+		if (!c)
+			continue;
+		UpperUs[n] = (double)statsUpper(i) * 1e-3;
+		Counts[n] = c;
+		n++;
+	}
+	return n;
+}
+
+bool extStatsActive(const ExtStats* Stats)
+{
+	return Stats->Active.load(std::memory_order_relaxed);
+}
+
+void extStatsPollStart(ExtStats* Stats, uint64_t Now)
+{
+	if (Stats->LastPoll)
+		extHistAdd(&Stats->Hist[STATS_HIST_POLL_GAP], Now - Stats->LastPoll);
+	Stats->LastPoll = Now;
+}
+
+void extStatsDll(ExtStats* Stats, uint64_t Call, uint64_t Ret)
+{
+	extHistAdd(&Stats->Hist[STATS_HIST_DLL], Ret - Call);
+}
+
+void extStatsInsert(ExtDevice* Dev, ExtStats* Stats, uint64_t First, uint64_t Count, uint64_t Ret, uint64_t Now)
+{
+	extHistAdd(&Stats->Hist[STATS_HIST_INSERT], Now - Ret);
+	for (uint64_t f = First; f < First + Count; f++)
+		Stats->InsTime[(size_t)(f & Dev->RingMask)] = Now;
+}
+
+void extStatsStages(ExtStats* Stats, uint64_t Ins, uint64_t Done)
+{
+	extHistAdd(&Stats->Hist[STATS_HIST_STAGES], Done - Ins);
+}
+
+void extStatsRead(const ExtDevice* Dev, uint64_t First, uint64_t Count)
+{
+	ExtStats* Stats = Dev->Stats.load(std::memory_order_relaxed);
+	if (!Stats->Active.load(std::memory_order_relaxed) || Count == 0)
+		return;
+	const uint64_t now = extNowNs();
+	/* frames of one batch share their timestamp: add runs of equal values at once */
+	ExtHist* H = &Stats->Hist[STATS_HIST_READ];
+	uint64_t f = First;
+	while (f < First + Count)
+	{
+		const uint64_t t = Stats->InsTime[(size_t)(f & Dev->RingMask)];
+		uint64_t run = 1;
+		while (f + run < First + Count && Stats->InsTime[(size_t)((f + run) & Dev->RingMask)] == t)
+			run++;
+		/* frames written before enabling have no timestamp */
+		if (t && t <= now)
+			extHistAdd(H, now - t, run);
+		f += run;
+	}
+}
+
+void extStatsReadLatest(ExtStats* Stats, uint64_t Time)
+{
+	uint64_t now = extNowNs();
+	if (Time && Time <= now)
+		extHistAdd(&Stats->Hist[STATS_HIST_READ], now - Time);
+}
+
+void extStatsFree(ExtDevice* Dev)
+{
+	delete Dev->Stats.load();
+	Dev->Stats.store(NULL);
+}
+
+int CALLTYP GSV86extStatsEnable(int ComNo, int OnOff)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	ExtStats* S = dev->Stats.load(std::memory_order_relaxed);
+	if (!OnOff)
+	{
+		if (S)
+			S->Active.store(false);
+		return GSV_OK;
+	}
+	if (!S)
+	{
+		S = new (std::nothrow) ExtStats();
+		if (!S)
+		{
+			extSetError(ComNo, ERR_MEM_ALLOC);
+			return GSV_ERROR;
+		}
+		try
+		{
+			S->InsTime.assign((size_t)dev->RingFrames, 0);
+		}
+		catch (...)
+		{
+			delete S;
+			extSetError(ComNo, ERR_MEM_ALLOC);
+			return GSV_ERROR;
+		}
+		for (int h = 0; h < STATS_HIST_NUM; h++)
+			extHistClear(&S->Hist[h]);
+		dev->Stats.store(S, std::memory_order_release);
+	}
+	/* a gap while disabled is no scheduling latency */
+	S->LastPoll = 0;
+	S->Active.store(true);
+	return GSV_OK;
+}
+
+static ExtStats* statsGet(ExtDevice* Dev)
+{
+	ExtStats* S = Dev->Stats.load(std::memory_order_acquire);
+	if (!S)
+		extSetError(Dev->ComNo, ERR_EXT_WRONG_STATE);
+	return S;
+}
+
+int CALLTYP GSV86extStatsReset(int ComNo)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	ExtStats* S = statsGet(dev.get());
+	if (!S)
+		return GSV_ERROR;
+	for (int h = 0; h < STATS_HIST_NUM; h++)
+		extHistClear(&S->Hist[h]);
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extStatsGet(int ComNo, int Hist, STATS_LATENCY* Stats)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	if (Hist < 0 || Hist >= STATS_HIST_NUM || !Stats)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	ExtStats* S = statsGet(dev.get());
+	if (!S)
+		return GSV_ERROR;
+	extHistSummary(&S->Hist[Hist], Stats);
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extStatsGetHistogram(int ComNo, int Hist, double* UpperUs, unsigned long long* Counts, int Max)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	if (Hist < 0 || Hist >= STATS_HIST_NUM || !UpperUs || !Counts || Max < 0)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	ExtStats* S = statsGet(dev.get());
+	if (!S)
+		return GSV_ERROR;
+	return extHistBuckets(&S->Hist[Hist], UpperUs, Counts, Max);
+}
@@ -0,0 +1,552 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: IEEE1451.4 TEDS decoder and sensor cache
+
+Assumed layout of the TEDS memory as returned by GSV86readTEDSrawData (checksums removed),
+LSB first: Basic TEDS (64 bits), then per template a selector of 2 bits (0: standard template
+with TemplID of 8 bits following, 3: end), the properties of the template and 1 bit
+(1: another template follows, 0: end).
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <cmath>
+#include <cstring>
+
+#define TEDS_BASIC_BITS	64
+#define TEDS_SEL_STANDARD	0
+#define TEDS_SEL_END	3
+#define TEDS_TEMPL_NUM	256
+
+enum TedsDecodeResult
+{
+	TEDS_DEC_DONE,		/* all templates decoded */
+	TEDS_DEC_TRUNC,		/* more TEDS memory needed */
+	TEDS_DEC_UNKNOWN	/* template not defined or not standard, following properties not decoded */
+};
+
+struct TedsSensor
+{
+	uint64_t Id;			/* Basic TEDS, unique per sensor */
+	std::vector<unsigned char> Raw;
+	std::vector<TEDS_ENTRY> Entries;
+	TedsDecodeResult Result;
+	unsigned Gen;			/* g_TedsGen at decoding */
+	uint64_t Used;			/* g_TedsClock at last use */
+};
+
+static const TEDS_PROP_DEF g_TedsBasic[] = {
+	{ TEDS_PROP_MANUFACTURER, 14, TEDS_TYPE_UNINT, 0, 0, 0, 0, "Manufacturer ID", "" },
+	{ TEDS_PROP_MODEL, 15, TEDS_TYPE_UNINT, 0, 0, 0, 0, "Model number", "" },
+	{ TEDS_PROP_VERSION_LETTER, 5, TEDS_TYPE_CHR5, 0, 0, 0, 0, "Version letter", "" },
+	{ TEDS_PROP_VERSION_NUMBER, 6, TEDS_TYPE_UNINT, 0, 0, 0, 0, "Version number", "" },
+	{ TEDS_PROP_SERIAL, 24, TEDS_TYPE_UNINT, 0, 0, 0, 0, "Serial number", "" }
+};
+
+/* IEEE1451.4 template 33, bridge sensors. The electrical signal type and the mapping method
+   (linear) are constants of the template and not stored. */
+static const TEDS_PROP_DEF g_TedsBridge[] = {
+	{ TEDS_BRIDGE_MEASURAND, 6, TEDS_TYPE_ENUM, 0, 0, 0, 0, "Physical measurand", "" },
+	{ TEDS_BRIDGE_MIN_PHYS, 32, TEDS_TYPE_SINGLE, 0, 0, 0, 0, "Minimum physical value", "" },
+	{ TEDS_BRIDGE_MAX_PHYS, 32, TEDS_TYPE_SINGLE, 0, 0, 0, 0, "Maximum physical value", "" },
+	{ TEDS_BRIDGE_MIN_ELEC, 32, TEDS_TYPE_SINGLE, 0, 0, 0, 0, "Minimum electrical value", "V/V" },
+	{ TEDS_BRIDGE_MAX_ELEC, 32, TEDS_TYPE_SINGLE, 0, 0, 0, 0, "Maximum electrical value", "V/V" },
+	{ TEDS_BRIDGE_TYPE, 2, TEDS_TYPE_ENUM, 0, 0, 0, 0, "Bridge type", "" },
+	{ TEDS_BRIDGE_IMPEDANCE, 18, TEDS_TYPE_CONRELRES, 1.0, 0.0001, 0, 0, "Bridge element impedance", "Ohm" },
+	{ TEDS_BRIDGE_RESP_TIME, 6, TEDS_TYPE_CONRELRES, 1e-6, 0.15, 0, 0, "Response time", "s" },
+	{ TEDS_BRIDGE_EXC_NOM, 9, TEDS_TYPE_CONRES, 0.1, 0.1, 0, 0, "Excitation level, nominal", "V" },
+	{ TEDS_BRIDGE_EXC_MIN, 6, TEDS_TYPE_CONRES, 0.1, 0.1, 0, 0, "Excitation level, minimum", "V" },
+	{ TEDS_BRIDGE_EXC_MAX, 9, TEDS_TYPE_CONRES, 0.1, 0.1, 0, 0, "Excitation level, maximum", "V" },
+	{ TEDS_BRIDGE_CAL_DATE, 16, TEDS_TYPE_DATE, 0, 0, 0, 0, "Calibration date", "" },
+	{ TEDS_BRIDGE_CAL_INITIALS, 15, TEDS_TYPE_CHR5, 0, 0, 0, 0, "Calibration initials", "" },
+	{ TEDS_BRIDGE_CAL_PERIOD, 12, TEDS_TYPE_UNINT, 0, 0, 0, 0, "Calibration period", "days" },
+	{ TEDS_BRIDGE_LOCATION, 11, TEDS_TYPE_UNINT, 0, 0, 0, 0, "Measurement location ID", "" }
+};
+
+static std::vector<TEDS_PROP_DEF> g_TedsTempl[TEDS_TEMPL_NUM];	/* by TemplID, empty: not defined */
+static unsigned g_TedsGen;		/* incremented at each change of template definitions */
+static std::vector<TedsSensor> g_TedsCache;
+static uint64_t g_TedsClock;
+static uint64_t g_TedsChanId[EXT_COMNO_MAX][TEDS_CHAN_MAX + 1];	/* sensor read last at ComNo/Chan ... */
+static bool g_TedsChanValid[EXT_COMNO_MAX][TEDS_CHAN_MAX + 1];	/* ... and not unplugged since */
+static std::mutex g_TedsLock;
+
+struct TedsBits
+{
+	const unsigned char* Data;
+	size_t Bits;
+	size_t Pos;
+	bool Truncated;
+
+	uint32_t Get(int n)
+	{
+		if (Pos + n > Bits)
+		{
+			Truncated = true;
+			Pos = Bits;
+			return 0;
+		}
+		uint32_t v = 0;
+		for (int i = 0; i < n; i++, Pos++)
+			v |= (uint32_t)((Data[Pos >> 3] >> (Pos & 7)) & 1) << i;
+		return v;
+	}
+};
+
+static void tedsChr5(uint32_t v, int chars, char* Text)
+{
+	int n = chars < TEDS_TEXT_SIZE - 1 ? chars : TEDS_TEXT_SIZE - 1;
+	for (int i = 0; i < n; i++, v >>= 5)
+	{
+		unsigned c = v & 0x1F;
+		Text[i] = c == 0 ? ' ' : (char)('@' + c);
+	}
+	Text[n] = 0;
+}
+
+/* Returns false if the TEDS memory ends before the property */
+static bool tedsDecodeProp(TedsBits* B, int TemplID, const TEDS_PROP_DEF* D, TEDS_ENTRY* E)
+{
+	memset(E, 0, sizeof(*E));
+	E->TemplID = TemplID;
+	E->PropID = D->PropID;
+	uint32_t raw = D->Bits ? B->Get(D->Bits) : 0;
+	if (B->Truncated)
+		return false;
+	E->Udata = raw;
+	const uint32_t ones = D->Bits >= 32 ? 0xFFFFFFFFUL : (1UL << D->Bits) - 1;
+	if (D->Bits && raw == ones && D->Type != TEDS_TYPE_SINGLE)
+	{
+		E->Flags = TEDS_ENTRY_NOT_SET;	/* all bits set: "don't care" */
+		return true;
+	}
+	switch (D->Type)
+	{
+	case TEDS_TYPE_CONRES:
+		E->DblData = D->Start + raw * D->Step;
+		E->Flags = TEDS_ANSW_IS_FLT;
+		break;
+	case TEDS_TYPE_CONRELRES:
+		E->DblData = D->Start * pow(1.0 + 2.0 * D->Step, (double)raw);
+		E->Flags = TEDS_ANSW_IS_FLT;
+		break;
+	case TEDS_TYPE_SINGLE:
+	{
+		float f;
+		memcpy(&f, &raw, sizeof(f));
+		E->DblData = f;
+		E->Flags = f != f ? TEDS_ENTRY_INVALID : TEDS_ANSW_IS_FLT;
+		break;
+	}
+	case TEDS_TYPE_CHR5:
+		tedsChr5(raw, D->Bits / 5, E->Text);
+		E->Flags = TEDS_IS_PACKED_CHR5;
+		break;
+	case TEDS_TYPE_DATE:
+		E->Flags = TEDS_IS_DATE_DAYS;
+		break;
+	case TEDS_TYPE_CONST:
+		E->DblData = D->Start;
+		E->Flags = TEDS_ANSW_IS_FLT;
+		break;
+	default:	/* TEDS_TYPE_UNINT, TEDS_TYPE_ENUM */
+		break;
+	}
+	return true;
+}
+
+/* Property D of the template starting at Out[First] is present, see TEDS_PROP_DEF.CondPropID */
+static bool tedsCondMet(const std::vector<TEDS_ENTRY>& Out, size_t First, const TEDS_PROP_DEF* D)
+{
+	if (!D->CondPropID)
+		return true;
+	for (size_t i = First; i < Out.size(); i++)
+		if (Out[i].PropID == D->CondPropID)
+			return Out[i].Udata == D->CondValue;
+	return false;
+}
+
+/* Properties of template TemplID 1..255: defined with GSV86extTedsDefineTemplate or built in.
+   Returns NULL if not defined. With g_TedsLock held. */
+static const TEDS_PROP_DEF* tedsTemplate(int TemplID, size_t* Num)
+{
+	const std::vector<TEDS_PROP_DEF>& T = g_TedsTempl[TemplID];
+	if (!T.empty())
+	{
+		*Num = T.size();
+		return T.data();
+	}
+	if (TemplID == TEDS_TEMPL_BRIDGE)
+	{
+		*Num = sizeof(g_TedsBridge) / sizeof(g_TedsBridge[0]);
+		return g_TedsBridge;
+	}
+	return NULL;
+}
+
+static TedsDecodeResult tedsDecodeAll(const unsigned char* Raw, size_t Bytes, std::vector<TEDS_ENTRY>& Out)
+{
+	TedsBits B = { Raw, Bytes * 8, 0, false };
+	TEDS_ENTRY e;
+	Out.clear();
+	for (size_t p = 0; p < sizeof(g_TedsBasic) / sizeof(g_TedsBasic[0]); p++)
+	{
+		if (!tedsDecodeProp(&B, 0, &g_TedsBasic[p], &e))
+			return TEDS_DEC_TRUNC;
+		Out.push_back(e);
+	}
+	for (;;)
+	{
+		uint32_t sel = B.Get(2);
+		if (B.Truncated)
+			return TEDS_DEC_TRUNC;
+		if (sel == TEDS_SEL_END)
+			return TEDS_DEC_DONE;
+		if (sel != TEDS_SEL_STANDARD)
+			return TEDS_DEC_UNKNOWN;
+		uint32_t id = B.Get(8);
+		if (B.Truncated)
+			return TEDS_DEC_TRUNC;
+		if (id == 0)
+			return TEDS_DEC_DONE;	/* unused memory */
+		size_t num = 0;
+		const TEDS_PROP_DEF* T = tedsTemplate((int)id, &num);
+		if (!T)
+			return TEDS_DEC_UNKNOWN;
+		const size_t first = Out.size();
+		for (size_t p = 0; p < num; p++)
+		{
+			if (!tedsCondMet(Out, first, &T[p]))
+				continue;
+			if (!tedsDecodeProp(&B, (int)id, &T[p], &e))
+				return TEDS_DEC_TRUNC;
+			Out.push_back(e);
+		}
+		if (!B.Get(1))
+			return B.Truncated ? TEDS_DEC_TRUNC : TEDS_DEC_DONE;
+	}
+}
+
+/* Decode Bytes of TEDS memory with the current template definitions, with g_TedsLock held */
+static TedsDecodeResult tedsDecode(const unsigned char* Raw, size_t Bytes, std::vector<TEDS_ENTRY>& Out)
+{
+	try
+	{
+		return tedsDecodeAll(Raw, Bytes, Out);
+	}
+	catch (...)
+	{
+		return TEDS_DEC_UNKNOWN;	/* entries decoded so far are kept */
+	}
+}
+
+static bool tedsChanValid(int ComNo, int Chan)
+{
+	if (ComNo < 0 || ComNo >= EXT_COMNO_MAX)
+		return false;
+	if (Chan < 1 || Chan > TEDS_CHAN_MAX)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return false;
+	}
+	return true;
+}
+
+static TedsSensor* tedsFind(uint64_t Id)
+{
+	for (size_t i = 0; i < g_TedsCache.size(); i++)
+		if (g_TedsCache[i].Id == Id)
+			return &g_TedsCache[i];
+	return NULL;
+}
+
+/* Cached sensor, decoded with the current definitions, with g_TedsLock held */
+static TedsSensor* tedsUse(TedsSensor* S)
+{
+	S->Used = ++g_TedsClock;
+	if (S->Gen != g_TedsGen)
+	{
+		S->Result = tedsDecode(S->Raw.data(), S->Raw.size(), S->Entries);
+		S->Gen = g_TedsGen;
+	}
+	return S;
+}
+
+/* Sensor bound to ComNo/Chan, with g_TedsLock held */
+static TedsSensor* tedsSensorOf(int ComNo, int Chan)
+{
+	TedsSensor* S = g_TedsChanValid[ComNo][Chan] ? tedsFind(g_TedsChanId[ComNo][Chan]) : NULL;
+	if (!S)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return NULL;
+	}
+	return tedsUse(S);
+}
+
+static void tedsBind(int ComNo, int Chan, uint64_t Id)
+{
+	g_TedsChanId[ComNo][Chan] = Id;
+	g_TedsChanValid[ComNo][Chan] = true;
+}
+
+bool extTedsPropDef(int TemplID, int PropID, TEDS_PROP_DEF* Def)
+{
+	if (TemplID == 0)
+	{
+		for (size_t p = 0; p < sizeof(g_TedsBasic) / sizeof(g_TedsBasic[0]); p++)
+			if (g_TedsBasic[p].PropID == PropID)
+			{
+				*Def = g_TedsBasic[p];
+				return true;
+			}
+		return false;
+	}
+	if (TemplID < 0 || TemplID >= TEDS_TEMPL_NUM)
+		return false;
+	std::lock_guard<std::mutex> lk(g_TedsLock);
+	size_t num = 0;
+	const TEDS_PROP_DEF* T = tedsTemplate(TemplID, &num);
+	for (size_t p = 0; p < num; p++)
+		if (T[p].PropID == PropID)
+		{
+			*Def = T[p];
+			return true;
+		}
+	return false;
+}
+
+bool extTedsTemplateValid(int TemplID, const TEDS_PROP_DEF* Props, int Num)
+{
+	if (TemplID < 1 || TemplID >= TEDS_TEMPL_NUM || Num < 0 || Num > TEDS_PROPS_MAX || (Num && !Props))
+		return false;
+	for (int p = 0; p < Num; p++)
+		if (Props[p].Bits < 0 || Props[p].Bits > 32 || Props[p].Type < TEDS_TYPE_UNINT || Props[p].Type > TEDS_TYPE_CONST
+			|| (Props[p].Type == TEDS_TYPE_SINGLE && Props[p].Bits != 32)
+			|| (Props[p].Type == TEDS_TYPE_CONST && Props[p].Bits != 0))
+			return false;
+	return true;
+}
+
+int CALLTYP GSV86extTedsDefineTemplate(int TemplID, const TEDS_PROP_DEF* Props, int Num)
+{
+	if (!extTedsTemplateValid(TemplID, Props, Num))
+	{
+		extSetError(0, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(g_TedsLock);
+	try
+	{
+		g_TedsTempl[TemplID].assign(Props, Props + Num);
+	}
+	catch (...)
+	{
+		extSetError(0, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	g_TedsGen++;
+	return GSV_OK;
+}
+
+void extTedsPlugged(int ComNo, int Present)
+{
+	std::lock_guard<std::mutex> lk(g_TedsLock);
+	for (int c = 1; c <= TEDS_CHAN_MAX; c++)
+		if (!(Present & (1 << (c - 1))))
+			g_TedsChanValid[ComNo][c] = false;
+}
+
+int CALLTYP GSV86extTedsCheck(int ComNo, int* Present)
+{
+	if (ComNo < 0 || ComNo >= EXT_COMNO_MAX)
+		return GSV_ERROR;
+	int bridge = 0, teds = 0;
+	if (GSV86getSensorPlugged(ComNo, 0, &bridge, &teds) == GSV_ERROR)
+	{
+		extSetDllError(ComNo);
+		return GSV_ERROR;
+	}
+	extTedsPlugged(ComNo, teds);
+	if (Present)
+		*Present = teds & 0xFF;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extTedsRead(int ComNo, int Chan, unsigned long flags)
+{
+	if (!tedsChanValid(ComNo, Chan))
+		return GSV_ERROR;
+	if (!(flags & (TEDS_FLAG_VERIFY_ID | TEDS_FLAG_REFRESH)))
+	{
+		std::lock_guard<std::mutex> lk(g_TedsLock);
+		TedsSensor* S = g_TedsChanValid[ComNo][Chan] ? tedsFind(g_TedsChanId[ComNo][Chan]) : NULL;
+		if (S)
+		{
+			tedsUse(S);
+			return GSV_OK;
+		}
+	}
+	/* the first request contains the Basic TEDS, which identifies the sensor */
+	std::vector<unsigned char> raw;
+	try
+	{
+		raw.resize(TEDS_RAW_CHUNK);
+	}
+	catch (...)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	if (GSV86readTEDSrawData(ComNo, Chan, raw.data(), TEDS_RAW_CHUNK, 0) == GSV_ERROR)
+	{
+		extSetDllError(ComNo);
+		return GSV_ERROR;
+	}
+	uint64_t id = 0;
+	for (int b = TEDS_BASIC_BITS / 8 - 1; b >= 0; b--)
+		id = (id << 8) | raw[(size_t)b];
+	if (!(flags & TEDS_FLAG_REFRESH))
+	{
+		std::lock_guard<std::mutex> lk(g_TedsLock);
+		TedsSensor* S = tedsFind(id);
+		if (S)
+		{
+			tedsUse(S);
+			tedsBind(ComNo, Chan, id);
+			return GSV_OK;
+		}
+	}
+	/* read on only as far as the templates reach */
+	TedsSensor n;
+	n.Id = id;
+	for (;;)
+	{
+		{
+			std::lock_guard<std::mutex> lk(g_TedsLock);
+			n.Result = tedsDecode(raw.data(), raw.size(), n.Entries);
+			n.Gen = g_TedsGen;
+		}
+		if (n.Result != TEDS_DEC_TRUNC || raw.size() >= TEDS_RAW_MAX)
+			break;
+		size_t have = raw.size();
+		try
+		{
+			raw.resize(have + TEDS_RAW_CHUNK);
+		}
+		catch (...)
+		{
+			break;
+		}
+		if (GSV86readTEDSrawData(ComNo, Chan, &raw[have], TEDS_RAW_CHUNK, (int)have) == GSV_ERROR)
+		{
+			raw.resize(have);	/* end of the TEDS memory */
+			break;
+		}
+	}
+	n.Raw.swap(raw);
+	std::lock_guard<std::mutex> lk(g_TedsLock);
+	n.Used = ++g_TedsClock;
+	if (n.Gen != g_TedsGen)
+	{
+		n.Result = tedsDecode(n.Raw.data(), n.Raw.size(), n.Entries);
+		n.Gen = g_TedsGen;
+	}
+	TedsSensor* S = tedsFind(id);
+	if (!S && g_TedsCache.size() >= TEDS_CACHE_MAX)
+	{
+		S = &g_TedsCache[0];
+		for (size_t i = 1; i < g_TedsCache.size(); i++)
+			if (g_TedsCache[i].Used < S->Used)
+				S = &g_TedsCache[i];
+	}
+	try
+	{
+		if (S)
+			*S = n;
+		else
+			g_TedsCache.push_back(n);
+	}
+	catch (...)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	tedsBind(ComNo, Chan, id);
+	return GSV_TRUE;
+}
+
+int CALLTYP GSV86extTedsGetId(int ComNo, int Chan, unsigned long long* Id, int* Complete)
+{
+	if (!tedsChanValid(ComNo, Chan))
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(g_TedsLock);
+	TedsSensor* S = tedsSensorOf(ComNo, Chan);
+	if (!S)
+		return GSV_ERROR;
+	if (Id)
+		*Id = S->Id;
+	if (Complete)
+		*Complete = S->Result == TEDS_DEC_DONE ? 1 : 0;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extTedsGetEntries(int ComNo, int Chan, TEDS_ENTRY* Entries, int Max)
+{
+	if (!tedsChanValid(ComNo, Chan))
+		return GSV_ERROR;
+	if ((!Entries && Max) || Max < 0)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(g_TedsLock);
+	TedsSensor* S = tedsSensorOf(ComNo, Chan);
+	if (!S)
+		return GSV_ERROR;
+	if (!Entries)
+		return (int)S->Entries.size();
+	int n = (int)S->Entries.size() < Max ? (int)S->Entries.size() : Max;
+	if (n)
+		memcpy(Entries, S->Entries.data(), sizeof(TEDS_ENTRY) * n);
+	return n;
+}
+
+int CALLTYP GSV86extTedsGetEntry(int ComNo, int Chan, int TemplID, int PropID, TEDS_ENTRY* Entry)
+{
+	if (!tedsChanValid(ComNo, Chan))
+		return GSV_ERROR;
+	if (!Entry)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(g_TedsLock);
+	TedsSensor* S = tedsSensorOf(ComNo, Chan);
+	if (!S)
+		return GSV_ERROR;
+	for (size_t i = 0; i < S->Entries.size(); i++)
+		if (S->Entries[i].TemplID == TemplID && S->Entries[i].PropID == PropID)
+		{
+			*Entry = S->Entries[i];
+			return GSV_TRUE;
+		}
+	memset(Entry, 0, sizeof(*Entry));
+	Entry->TemplID = TemplID;
+	Entry->PropID = PropID;
+	Entry->Flags = TEDS_ENTRY_NOT_EXIST;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extTedsInvalidate(int ComNo)
+{
+	std::lock_guard<std::mutex> lk(g_TedsLock);
+	if (ComNo == -1)
+	{
+		memset(g_TedsChanValid, 0, sizeof(g_TedsChanValid));
+		g_TedsCache.clear();
+		return GSV_OK;
+	}
+	if (ComNo < 0 || ComNo >= EXT_COMNO_MAX)
+		return GSV_ERROR;
+	memset(g_TedsChanValid[ComNo], 0, sizeof(g_TedsChanValid[ComNo]));
+	return GSV_OK;
+}
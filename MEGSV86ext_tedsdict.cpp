@@ -0,0 +1,801 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: compiled, memory-mapped TEDS dictionary and TEDS list formatting
+
+Layout of the compiled file (native byte order, written and read on the same platform):
+TedsDictHeader, TedsDictTempl[NumTempl] sorted by TemplID, TedsDictProp[NumProps] in the order
+of the templates, TedsDictEnum[NumEnum] sorted by TemplID, PropID and Value.
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define TEDS_DICT_MAGIC	"GSVTDIC"	/* 8 bytes including the terminating 0 */
+#define TEDS_DICT_VERSION	1
+#define TEDS_DICT_LINE	256
+#define TEDS_DICT_TEMPL_NUM	256	/* TemplIDs 1..255 */
+#define TEDS_DAYS_1998	10227	/* days from 1.1.1970 to 1.1.1998 */
+
+struct TedsDictHeader
+{
+	char Magic[8];
+	uint32_t Version;
+	uint32_t NumTempl;
+	uint32_t NumProps;
+	uint32_t NumEnum;
+	uint32_t OffTempl;		/* byte offsets from the start of the file */
+	uint32_t OffProps;
+	uint32_t OffEnum;
+	uint32_t Size;			/* of the whole file */
+};
+
+struct TedsDictTempl
+{
+	uint32_t TemplID;
+	uint32_t First;			/* index of the first property */
+	uint32_t Num;
+};
+
+struct TedsDictProp
+{
+	int32_t PropID;
+	int32_t Bits;
+	int32_t Type;
+	int32_t CondPropID;
+	uint32_t CondValue;
+	uint32_t Reserved;
+	double Start;
+	double Step;
+	char Name[TEDS_NAME_SIZE];
+	char Unit[TEDS_NAME_SIZE];
+};
+
+struct TedsDictEnum
+{
+	uint32_t TemplID;
+	uint32_t PropID;
+	uint32_t Value;
+	char Text[TEDS_NAME_SIZE];
+};
+
+/* Mapping of the loaded dictionary file */
+struct TedsDictMap
+{
+	const unsigned char* Base;
+	size_t Size;
+#ifdef _WIN32
+	HANDLE hFile;
+	HANDLE hMap;
+#else
+	int fd;
+#endif
+};
+
+static TedsDictMap g_Dict;
+static bool g_DictTempl[TEDS_DICT_TEMPL_NUM];	/* templates defined by the last GSV86extTedsDictLoad */
+static const TedsDictEnum* g_DictEnum;	/* into g_Dict, NULL: no dictionary loaded */
+static uint32_t g_DictNumEnum;
+static std::mutex g_DictLock;
+
+/* Enumeration texts of the built-in templates, used if the loaded dictionary has none; sorted */
+static const TedsDictEnum g_DictBuiltinEnum[] = {
+	{ TEDS_TEMPL_BRIDGE, TEDS_BRIDGE_TYPE, 0, "Quarter bridge" },
+	{ TEDS_TEMPL_BRIDGE, TEDS_BRIDGE_TYPE, 1, "Half bridge" },
+	{ TEDS_TEMPL_BRIDGE, TEDS_BRIDGE_TYPE, 2, "Full bridge" }
+};
+
+static const char* const g_TedsTypeNames[] = { "UnInt", "Enum", "ConRes", "ConRelRes", "Single", "Chr5", "Date", "Const" };
+
+static bool dictMapFile(TedsDictMap* M, const char* Path)
+{
+	memset(M, 0, sizeof(*M));
+#ifdef _WIN32
+	M->hFile = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (M->hFile == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(M->hFile, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(M->hFile);
+		return false;
+	}
+	M->Size = (size_t)size.QuadPart;
+	M->hMap = CreateFileMappingA(M->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!M->hMap)
+	{
+		CloseHandle(M->hFile);
+		return false;
+	}
+	M->Base = (const unsigned char*)MapViewOfFile(M->hMap, FILE_MAP_READ, 0, 0, 0);
+	if (!M->Base)
+	{
+		CloseHandle(M->hMap);
+		CloseHandle(M->hFile);
+		return false;
+	}
+#else
+	M->fd = open(Path, O_RDONLY);
+	if (M->fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(M->fd, &st) != 0 || st.st_size == 0)
+	{
+		close(M->fd);
+		return false;
+	}
+	M->Size = (size_t)st.st_size;
+	void* p = mmap(NULL, M->Size, PROT_READ, MAP_SHARED, M->fd, 0);
+	if (p == MAP_FAILED)
+	{
+		close(M->fd);
+		return false;
+	}
+	M->Base = (const unsigned char*)p;
+#endif
+	return true;
+}
+
+static void dictUnmap(TedsDictMap* M)
+{
+	if (!M->Base)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(M->Base);
+	CloseHandle(M->hMap);
+	CloseHandle(M->hFile);
+#else
+	munmap((void*)M->Base, M->Size);
+	close(M->fd);
+#endif
+	M->Base = NULL;
+}
+
+/* Array of Num records of Size bytes at Off lies within the file and is aligned */
+static bool dictArrayValid(size_t FileSize, uint32_t Off, uint32_t Num, size_t Size, size_t Align)
+{
+	return Off % Align == 0 && Off <= FileSize && (FileSize - Off) / Size >= Num;
+}
+
+static bool dictTextValid(const char* Text)
+{
+	return memchr(Text, 0, TEDS_NAME_SIZE) != NULL;
+}
+
+/* Header of a mapped file, or NULL if the content is not a valid dictionary */
+static const TedsDictHeader* dictValidate(const unsigned char* Base, size_t Size)
+{
+	if (Size < sizeof(TedsDictHeader))
+		return NULL;
+	const TedsDictHeader* H = (const TedsDictHeader*)Base;
+	if (memcmp(H->Magic, TEDS_DICT_MAGIC, sizeof(H->Magic)) != 0 || H->Version != TEDS_DICT_VERSION || H->Size != Size
+		|| !dictArrayValid(Size, H->OffTempl, H->NumTempl, sizeof(TedsDictTempl), alignof(TedsDictTempl))
+		|| !dictArrayValid(Size, H->OffProps, H->NumProps, sizeof(TedsDictProp), alignof(TedsDictProp))
+		|| !dictArrayValid(Size, H->OffEnum, H->NumEnum, sizeof(TedsDictEnum), alignof(TedsDictEnum)))
+		return NULL;
+	const TedsDictTempl* T = (const TedsDictTempl*)(Base + H->OffTempl);
+	for (uint32_t t = 0; t < H->NumTempl; t++)
+		if (T[t].TemplID < 1 || T[t].TemplID > 255 || (t && T[t].TemplID <= T[t - 1].TemplID)
+			|| T[t].Num > TEDS_PROPS_MAX || T[t].First > H->NumProps || H->NumProps - T[t].First < T[t].Num)
+			return NULL;
+	const TedsDictProp* P = (const TedsDictProp*)(Base + H->OffProps);
+	for (uint32_t p = 0; p < H->NumProps; p++)
+		if (!dictTextValid(P[p].Name) || !dictTextValid(P[p].Unit))
+			return NULL;
+	const TedsDictEnum* E = (const TedsDictEnum*)(Base + H->OffEnum);
+	for (uint32_t e = 0; e < H->NumEnum; e++)
+		if (!dictTextValid(E[e].Text))
+			return NULL;
+	return H;
+}
+
+static bool dictEnumLess(const TedsDictEnum& a, const TedsDictEnum& b)
+{
+	if (a.TemplID != b.TemplID)
+		return a.TemplID < b.TemplID;
+	if (a.PropID != b.PropID)
+		return a.PropID < b.PropID;
+	return a.Value < b.Value;
+}
+
+static const TedsDictEnum* dictSearchEnum(const TedsDictEnum* First, size_t Num, const TedsDictEnum& Key)
+{
+	const TedsDictEnum* end = First + Num;
+	const TedsDictEnum* e = std::lower_bound(First, end, Key, dictEnumLess);
+	return e != end && !dictEnumLess(Key, *e) ? e : NULL;
+}
+
+/* Enumeration text of the loaded dictionary or of a built-in template, with g_DictLock held */
+static const TedsDictEnum* dictFindEnum(int TemplID, int PropID, unsigned long Value)
+{
+	TedsDictEnum key;
+	memset(&key, 0, sizeof(key));
+	key.TemplID = (uint32_t)TemplID;
+	key.PropID = (uint32_t)PropID;
+	key.Value = (uint32_t)Value;
+	const TedsDictEnum* e = g_DictEnum ? dictSearchEnum(g_DictEnum, g_DictNumEnum, key) : NULL;
+	if (!e)
+		e = dictSearchEnum(g_DictBuiltinEnum, sizeof(g_DictBuiltinEnum) / sizeof(g_DictBuiltinEnum[0]), key);
+	return e;
+}
+
+static char* dictTrim(char* s)
+{
+	while (*s == ' ' || *s == '\t')
+		s++;
+	size_t n = strlen(s);
+	while (n && (s[n - 1] == ' ' || s[n - 1] == '\t' || s[n - 1] == '\r' || s[n - 1] == '\n'))
+		s[--n] = 0;
+	return s;
+}
+
+/* Case-insensitive comparison of the first N characters (N=0: whole strings) */
+static bool dictEqualNoCase(const char* a, const char* b, size_t N)
+{
+	for (size_t i = 0; !N || i < N; i++)
+	{
+		if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i]))
+			return false;
+		if (!a[i])
+			break;
+	}
+	return true;
+}
+
+static bool dictParseInt(const char* s, long* v)
+{
+	char* end;
+	*v = strtol(s, &end, 0);
+	return end != s && *dictTrim(end) == 0;
+}
+
+static bool dictParseDouble(const char* s, double* v)
+{
+	char* end;
+	*v = strtod(s, &end);
+	return end != s && *dictTrim(end) == 0;
+}
+
+static bool dictParseType(const char* s, int32_t* Type)
+{
+	long v;
+	if (dictParseInt(s, &v))
+	{
+		*Type = (int32_t)v;
+		return v >= TEDS_TYPE_UNINT && v <= TEDS_TYPE_CONST;
+	}
+	for (int t = 0; t <= TEDS_TYPE_CONST; t++)
+		if (dictEqualNoCase(s, g_TedsTypeNames[t], 0))
+		{
+			*Type = t;
+			return true;
+		}
+	return false;
+}
+
+static bool dictCopyText(char* Dst, const char* Src)
+{
+	if (strlen(Src) >= TEDS_NAME_SIZE)
+		return false;
+	memset(Dst, 0, TEDS_NAME_SIZE);
+	strcpy(Dst, Src);
+	return true;
+}
+
+/* "PropID,Bits,Type[,Start,Step[,CondPropID,CondValue]]", the value of a Prop<n> key */
+static bool dictParseProp(char* Val, TedsDictProp* P)
+{
+	char* f[7];
+	int n = 0;
+	for (char* s = Val; s && n < 7; n++)
+	{
+		f[n] = s;
+		s = strchr(s, ',');
+		if (s)
+			*s++ = 0;
+	}
+	if (n != 3 && n != 5 && n != 7)
+		return false;
+	for (int i = 0; i < n; i++)
+		f[i] = dictTrim(f[i]);
+	long prop, bits, cond = 0, condval = 0;
+	memset(P, 0, sizeof(*P));
+	if (!dictParseInt(f[0], &prop) || !dictParseInt(f[1], &bits) || !dictParseType(f[2], &P->Type)
+		|| (n >= 5 && (!dictParseDouble(f[3], &P->Start) || !dictParseDouble(f[4], &P->Step)))
+		|| (n == 7 && (!dictParseInt(f[5], &cond) || !dictParseInt(f[6], &condval))))
+		return false;
+	P->PropID = (int32_t)prop;
+	P->Bits = (int32_t)bits;
+	P->CondPropID = (int32_t)cond;
+	P->CondValue = (uint32_t)condval;
+	return prop > 0 && bits >= 0 && bits <= 32 && (P->Type != TEDS_TYPE_SINGLE || bits == 32)
+		&& (P->Type != TEDS_TYPE_CONST || bits == 0);
+}
+
+/* Texts of a [Property<PropID>] section, shared by all templates using the property */
+struct DictPropText
+{
+	char Name[TEDS_NAME_SIZE];
+	char Unit[TEDS_NAME_SIZE];
+	std::vector<TedsDictEnum> Enum;		/* TemplID set per template using the property */
+};
+
+enum DictSection
+{
+	DICT_SECT_OTHER,	/* keys are ignored */
+	DICT_SECT_TEMPLATE,
+	DICT_SECT_PROPERTY
+};
+
+/* Section "[<Name><Id>]" or "[<Name> <Id>]", Name case-insensitive */
+static bool dictSectionId(char* Sect, const char* Name, long* Id)
+{
+	const size_t n = strlen(Name);
+	return dictEqualNoCase(Sect, Name, n) && dictParseInt(dictTrim(Sect + n), Id);
+}
+
+/* "<Name><n>" key, e.g. Prop3 or Enum0 */
+static bool dictKeyIndex(const char* Key, const char* Name, long* Ix)
+{
+	const size_t n = strlen(Name);
+	return dictEqualNoCase(Key, Name, n) && dictParseInt(Key + n, Ix);
+}
+
+/* Parse the text file. Returns GSV_OK or the error code. */
+static int dictParse(FILE* f, std::map<uint32_t, std::vector<TedsDictProp> >& Templ, std::vector<TedsDictEnum>& Enum)
+{
+	std::map<uint32_t, std::map<long, TedsDictProp> > templ;	/* by TemplID, properties by n of Prop<n> */
+	std::map<long, DictPropText> text;				/* by PropID */
+	DictSection sect = DICT_SECT_OTHER;
+	long sectId = 0;
+	char line[TEDS_DICT_LINE];
+	while (fgets(line, sizeof(line), f))
+	{
+		if (!strchr(line, '\n') && !feof(f))
+			return ERR_FILE_CONTENT;	/* line too long */
+		char* s = dictTrim(line);
+		if (!*s || *s == ';')
+			continue;
+		if (*s == '[')
+		{
+			char* e = strchr(s, ']');
+			if (!e || *dictTrim(e + 1))
+				return ERR_FILE_CONTENT;
+			*e = 0;
+			char* name = dictTrim(s + 1);
+			sect = DICT_SECT_OTHER;
+			if (dictSectionId(name, "Template", &sectId))
+			{
+				if (sectId < 1 || sectId > 255)
+					return ERR_FILE_CONTENT;
+				sect = DICT_SECT_TEMPLATE;
+				templ[(uint32_t)sectId];
+			}
+			else if (dictSectionId(name, "Property", &sectId))
+			{
+				if (sectId < 1)
+					return ERR_FILE_CONTENT;
+				sect = DICT_SECT_PROPERTY;
+				text[sectId];	/* value-initialized: no name, unit and texts */
+			}
+			continue;
+		}
+		char* eq = strchr(s, '=');
+		if (sect == DICT_SECT_OTHER)
+			continue;
+		if (!eq)
+			return ERR_FILE_CONTENT;
+		*eq = 0;
+		char* key = dictTrim(s);
+		char* val = dictTrim(eq + 1);
+		long ix;
+		if (sect == DICT_SECT_TEMPLATE)
+		{
+			if (!dictKeyIndex(key, "Prop", &ix))
+				continue;	/* e.g. Name */
+			std::map<long, TedsDictProp>& T = templ[(uint32_t)sectId];
+			TedsDictProp P;
+			if (ix < 1 || ix > TEDS_PROPS_MAX || T.count(ix) || !dictParseProp(val, &P))
+				return ERR_FILE_CONTENT;
+			T[ix] = P;
+			continue;
+		}
+		DictPropText& X = text[sectId];
+		if (dictEqualNoCase(key, "Name", 0))
+		{
+			if (!dictCopyText(X.Name, val))
+				return ERR_FILE_CONTENT;
+		}
+		else if (dictEqualNoCase(key, "Unit", 0))
+		{
+			if (!dictCopyText(X.Unit, val))
+				return ERR_FILE_CONTENT;
+		}
+		else if (dictKeyIndex(key, "Enum", &ix))
+		{
+			TedsDictEnum E;
+			memset(&E, 0, sizeof(E));
+			if (ix < 0 || !dictCopyText(E.Text, val))
+				return ERR_FILE_CONTENT;
+			E.PropID = (uint32_t)sectId;
+			E.Value = (uint32_t)ix;
+			X.Enum.push_back(E);
+		}
+	}
+	if (ferror(f))
+		return ERR_EXT_FILE_OPEN;
+
+	/* properties in the order of n, with the texts of their PropID */
+	for (std::map<uint32_t, std::map<long, TedsDictProp> >::iterator t = templ.begin(); t != templ.end(); ++t)
+	{
+		if (t->second.empty())
+			continue;	/* no definition: Num=0 would remove one */
+		std::vector<TedsDictProp>& props = Templ[t->first];
+		std::vector<int32_t> done;	/* PropIDs with enumeration texts added */
+		for (std::map<long, TedsDictProp>::iterator p = t->second.begin(); p != t->second.end(); ++p)
+		{
+			TedsDictProp& P = p->second;
+			std::map<long, DictPropText>::const_iterator x = text.find(P.PropID);
+			if (x != text.end())
+			{
+				memcpy(P.Name, x->second.Name, TEDS_NAME_SIZE);
+				memcpy(P.Unit, x->second.Unit, TEDS_NAME_SIZE);
+				if (std::find(done.begin(), done.end(), P.PropID) == done.end())
+				{
+					done.push_back(P.PropID);
+					for (size_t e = 0; e < x->second.Enum.size(); e++)
+					{
+						Enum.push_back(x->second.Enum[e]);
+						Enum.back().TemplID = t->first;
+					}
+				}
+			}
+			props.push_back(P);
+		}
+	}
+	return GSV_OK;
+}
+
+static size_t dictAlign(size_t Off, size_t Align)
+{
+	return (Off + Align - 1) / Align * Align;
+}
+
+int CALLTYP GSV86extTedsDictCompile(const char* IniPath, const char* DictPath)
+{
+	if (!IniPath || !DictPath)
+	{
+		extSetError(0, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	FILE* f = fopen(IniPath, "r");
+	if (!f)
+	{
+		extSetError(0, ERR_EXT_FILE_OPEN);
+		return GSV_ERROR;
+	}
+	std::map<uint32_t, std::vector<TedsDictProp> > templ;
+	std::vector<TedsDictEnum> enums;
+	std::vector<unsigned char> img;
+	int err;
+	try
+	{
+		err = dictParse(f, templ, enums);
+		if (err == GSV_OK)
+		{
+			std::sort(enums.begin(), enums.end(), dictEnumLess);
+			for (size_t e = 1; e < enums.size(); e++)
+				if (!dictEnumLess(enums[e - 1], enums[e]))
+					err = ERR_FILE_CONTENT;	/* value defined twice */
+		}
+		if (err == GSV_OK)
+		{
+			size_t numProps = 0;
+			for (std::map<uint32_t, std::vector<TedsDictProp> >::const_iterator t = templ.begin(); t != templ.end(); ++t)
+				numProps += t->second.size();
+			TedsDictHeader H;
+			memset(&H, 0, sizeof(H));
+			memcpy(H.Magic, TEDS_DICT_MAGIC, sizeof(H.Magic));
+			H.Version = TEDS_DICT_VERSION;
+			H.NumTempl = (uint32_t)templ.size();
+			H.NumProps = (uint32_t)numProps;
+			H.NumEnum = (uint32_t)enums.size();
+			H.OffTempl = (uint32_t)dictAlign(sizeof(H), alignof(TedsDictTempl));
+			H.OffProps = (uint32_t)dictAlign(H.OffTempl + H.NumTempl * sizeof(TedsDictTempl), alignof(TedsDictProp));
+			H.OffEnum = (uint32_t)dictAlign(H.OffProps + H.NumProps * sizeof(TedsDictProp), alignof(TedsDictEnum));
+			H.Size = (uint32_t)(H.OffEnum + H.NumEnum * sizeof(TedsDictEnum));
+			img.assign(H.Size, 0);
+			memcpy(&img[0], &H, sizeof(H));
+			TedsDictTempl* T = (TedsDictTempl*)&img[H.OffTempl];
+			TedsDictProp* P = (TedsDictProp*)&img[H.OffProps];
+			uint32_t first = 0;
+			for (std::map<uint32_t, std::vector<TedsDictProp> >::const_iterator t = templ.begin(); t != templ.end(); ++t, ++T)
+			{
+				T->TemplID = t->first;
+				T->First = first;
+				T->Num = (uint32_t)t->second.size();
+				if (T->Num)
+					memcpy(&P[first], t->second.data(), T->Num * sizeof(TedsDictProp));
+				first += T->Num;
+			}
+			if (H.NumEnum)
+				memcpy(&img[H.OffEnum], enums.data(), H.NumEnum * sizeof(TedsDictEnum));
+		}
+	}
+	catch (...)
+	{
+		err = ERR_MEM_ALLOC;
+	}
+	fclose(f);
+	if (err != GSV_OK)
+	{
+		extSetError(0, err);
+		return GSV_ERROR;
+	}
+	FILE* o = fopen(DictPath, "wb");
+	bool ok = o && fwrite(img.data(), 1, img.size(), o) == img.size();
+	if (o)
+		ok = fclose(o) == 0 && ok;
+	if (!ok)
+	{
+		extSetError(0, ERR_EXT_FILE_OPEN);
+		return GSV_ERROR;
+	}
+	return (int)templ.size();
+}
+
+int CALLTYP GSV86extTedsDictLoad(const char* DictPath)
+{
+	if (!DictPath)
+	{
+		extSetError(0, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	TedsDictMap M;
+	if (!dictMapFile(&M, DictPath))
+	{
+		extSetError(0, ERR_EXT_FILE_OPEN);
+		return GSV_ERROR;
+	}
+	const TedsDictHeader* H = dictValidate(M.Base, M.Size);
+	if (!H)
+	{
+		dictUnmap(&M);
+		extSetError(0, ERR_FILE_CONTENT);
+		return GSV_ERROR;
+	}
+	/* the decoder keeps copies of the definitions, only enumeration texts are used from the mapping */
+	const TedsDictTempl* T = (const TedsDictTempl*)(M.Base + H->OffTempl);
+	const TedsDictProp* P = (const TedsDictProp*)(M.Base + H->OffProps);
+	std::vector<TEDS_PROP_DEF> defs;
+	try
+	{
+		defs.resize(H->NumProps);
+	}
+	catch (...)
+	{
+		dictUnmap(&M);
+		extSetError(0, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	for (uint32_t p = 0; p < H->NumProps; p++)
+	{
+		const TedsDictProp& S = P[p];
+		TEDS_PROP_DEF& D = defs[p];
+		D.PropID = S.PropID;
+		D.Bits = S.Bits;
+		D.Type = S.Type;
+		D.Start = S.Start;
+		D.Step = S.Step;
+		D.CondPropID = S.CondPropID;
+		D.CondValue = S.CondValue;
+		memcpy(D.Name, S.Name, TEDS_NAME_SIZE);
+		memcpy(D.Unit, S.Unit, TEDS_NAME_SIZE);
+	}
+	/* check all templates before any is defined, so that a bad file leaves the loaded dictionary intact */
+	for (uint32_t t = 0; t < H->NumTempl; t++)
+		if (!extTedsTemplateValid((int)T[t].TemplID, T[t].Num ? &defs[T[t].First] : NULL, (int)T[t].Num))
+		{
+			dictUnmap(&M);
+			extSetError(0, ERR_FILE_CONTENT);
+			return GSV_ERROR;
+		}
+	std::lock_guard<std::mutex> lk(g_DictLock);
+	bool defined[TEDS_DICT_TEMPL_NUM] = { false };
+	for (uint32_t t = 0; t < H->NumTempl; t++)
+	{
+		const int id = (int)T[t].TemplID;
+		if (GSV86extTedsDefineTemplate(id, T[t].Num ? &defs[T[t].First] : NULL, (int)T[t].Num) == GSV_ERROR)
+		{
+			/* out of memory: no dictionary is left loaded, rather than a mix of both */
+			const int err = GSV86extGetLastError(0);
+			for (int i = 1; i < TEDS_DICT_TEMPL_NUM; i++)
+				if (defined[i] || g_DictTempl[i])
+					GSV86extTedsDefineTemplate(i, NULL, 0);
+			memset(g_DictTempl, 0, sizeof(g_DictTempl));
+			dictUnmap(&M);
+			dictUnmap(&g_Dict);
+			g_DictEnum = NULL;
+			g_DictNumEnum = 0;
+			extSetError(0, err);
+			return GSV_ERROR;
+		}
+		defined[id] = true;
+	}
+	/* templates of the dictionary loaded before, which this one doesn't define */
+	for (int i = 1; i < TEDS_DICT_TEMPL_NUM; i++)
+		if (g_DictTempl[i] && !defined[i])
+			GSV86extTedsDefineTemplate(i, NULL, 0);
+	memcpy(g_DictTempl, defined, sizeof(g_DictTempl));
+	dictUnmap(&g_Dict);
+	g_Dict = M;
+	g_DictEnum = (const TedsDictEnum*)(M.Base + H->OffEnum);
+	g_DictNumEnum = H->NumEnum;
+	return (int)H->NumTempl;
+}
+
+int CALLTYP GSV86extTedsDictUnload(void)
+{
+	std::lock_guard<std::mutex> lk(g_DictLock);
+	dictUnmap(&g_Dict);
+	g_DictEnum = NULL;
+	g_DictNumEnum = 0;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extTedsDictGetEnumText(int TemplID, int PropID, unsigned long Value, char* Text)
+{
+	if (!Text)
+	{
+		extSetError(0, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(g_DictLock);
+	const TedsDictEnum* e = dictFindEnum(TemplID, PropID, Value);
+	if (!e)
+	{
+		Text[0] = 0;
+		return GSV_OK;
+	}
+	strcpy(Text, e->Text);
+	return GSV_TRUE;
+}
+
+/* Days since 1.1.1998 as YYYY-MM-DD */
+static void tedsFormatDate(unsigned long Days, char* Text, size_t Size)
+{
+	long z = (long)Days + TEDS_DAYS_1998 + 719468;
+	const long era = z / 146097;
+	const long doe = z - era * 146097;
+	const long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	const long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	const long mp = (5 * doy + 2) / 153;
+	const long d = doy - (153 * mp + 2) / 5 + 1;
+	const long m = mp < 10 ? mp + 3 : mp - 9;
+	const long y = yoe + era * 400 + (m <= 2);
+	snprintf(Text, Size, "%04ld-%02ld-%02ld", y, m, d);
+}
+
+/* Value field of entry E, with g_DictLock held */
+static void tedsFormatValue(const TEDS_ENTRY* E, const TEDS_PROP_DEF* D, char* Text, size_t Size)
+{
+	Text[0] = 0;
+	if (E->Flags == TEDS_ENTRY_NOT_SET)
+		return;
+	if (E->Flags == TEDS_ENTRY_INVALID)
+	{
+		snprintf(Text, Size, "invalid");
+		return;
+	}
+	switch (E->Flags)
+	{
+	case TEDS_ANSW_IS_FLT:
+		snprintf(Text, Size, "%g", E->DblData);
+		return;
+	case TEDS_IS_PACKED_CHR5:
+	{
+		size_t n = strlen(E->Text);
+		while (n && E->Text[n - 1] == ' ')
+			n--;
+		snprintf(Text, Size, "%.*s", (int)n, E->Text);
+		return;
+	}
+	case TEDS_IS_DATE_DAYS:
+		tedsFormatDate(E->Udata, Text, Size);
+		return;
+	default:
+		break;
+	}
+	const TedsDictEnum* e = D && D->Type == TEDS_TYPE_ENUM ? dictFindEnum(E->TemplID, E->PropID, E->Udata) : NULL;
+	if (e)
+		snprintf(Text, Size, "%s", e->Text);
+	else
+		snprintf(Text, Size, "%lu", E->Udata);
+}
+
+int CALLTYP GSV86extTedsFormatList(int ComNo, int Chan, char* ListOut, int ListSize, int Code)
+{
+	if (ComNo < 0 || ComNo >= EXT_COMNO_MAX)
+		return GSV_ERROR;
+	if (!ListOut || ListSize < 1)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	int num = GSV86extTedsGetEntries(ComNo, Chan, NULL, 0);
+	if (num == GSV_ERROR)
+		return GSV_ERROR;
+	std::vector<TEDS_ENTRY> ent;
+	try
+	{
+		ent.resize((size_t)num);
+	}
+	catch (...)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	/* entries decoded again in between are cut to the number queried */
+	if (num)
+		num = GSV86extTedsGetEntries(ComNo, Chan, ent.data(), num);
+	if (num == GSV_ERROR)
+		return GSV_ERROR;
+	const char* sep = (Code & TEDSLISTFLG_PIPE_SEPARA) ? "|" : "\t";
+	const char* empty = (Code & TEDSLISTFLG_FILL_EMPTY_SPACE) ? " " : "";
+	int mainID = 0;		/* first template after the Basic TEDS */
+	for (int i = 0; i < num && !mainID; i++)
+		mainID = ent[(size_t)i].TemplID;
+	size_t pos = 0;
+	int lines = 0;
+	ListOut[0] = 0;
+	std::lock_guard<std::mutex> lk(g_DictLock);
+	for (int i = 0; i < num; i++)
+	{
+		const TEDS_ENTRY* E = &ent[(size_t)i];
+		if ((Code & TEDSLISTFLG_BASICONLY) && E->TemplID != 0)
+			continue;
+		if ((Code & TEDSLISTFLG_MAINONLY) && E->TemplID != mainID)
+			continue;
+		TEDS_PROP_DEF D;
+		const bool def = extTedsPropDef(E->TemplID, E->PropID, &D);
+		char value[2 * TEDS_NAME_SIZE];
+		tedsFormatValue(E, def ? &D : NULL, value, sizeof(value));
+		char name[TEDS_NAME_SIZE + 16];
+		if (def && D.Name[0])
+			snprintf(name, sizeof(name), "%s", D.Name);
+		else
+			snprintf(name, sizeof(name), "Property %d", E->PropID);
+		const char* fields[3] = { name, value, def ? D.Unit : "" };
+		char line[sizeof(name) + sizeof(value) + TEDS_NAME_SIZE + 8];
+		size_t n = 0;
+		for (int c = 0; c < 3; c++)
+		{
+			const char* s = fields[c][0] ? fields[c] : empty;
+			if (!*s && (Code & TEDSLISTFLG_COLUMN_NUM_VAR))
+				continue;
+			n += (size_t)snprintf(&line[n], sizeof(line) - n, "%s%s", n ? sep : "", s);
+		}
+		n += (size_t)snprintf(&line[n], sizeof(line) - n, "\r\n");
+		if (pos + n >= (size_t)ListSize)
+		{
+			extSetError(ComNo, ERR_WRONG_PARAMETER);	/* list cut after the last complete line */
+			return GSV_ERROR;
+		}
+		memcpy(&ListOut[pos], line, n + 1);
+		pos += n;
+		lines++;
+	}
+	return lines;
+}
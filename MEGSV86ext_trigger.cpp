@@ -0,0 +1,415 @@
+/**********************************************************************************************
+MEGSV86ext host extension library: trigger engine with pre-/post-trigger capture
+************************************************************************************************/
+#include "MEGSV86ext_intern.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#define SLOT_FREE	0
+#define SLOT_PENDING	1	/* trigger seen, post-trigger frames not yet complete */
+#define SLOT_READY	2	/* capture complete, waiting for GSV86extTrigGetCapture */
+
+struct TrigCond
+{
+	int Type;
+	int Obj;		/* 0-based object index */
+	int Group;
+	double Thres1;
+	double Thres2;
+	bool EdgeArmed;		/* RISING/FALLING: value was on the other side of the hysteresis */
+	bool HasPrev;		/* SLOPE_*: Prev is valid */
+	double Prev;
+};
+
+struct TrigSlot
+{
+	int State;
+	uint64_t TrigFrame;
+	uint64_t Seq;		/* order of trigger events, for fetch and overwrite */
+	std::vector<double> Data;
+};
+
+struct TrigEngine
+{
+	int PreFrames;
+	int PostFrames;
+	unsigned long Flags;
+	bool Armed;
+	bool LastResult;
+	int NumCond;
+	TrigCond Cond[TRIG_COND_MAX];
+	std::vector<TrigSlot> Slots;
+	uint64_t BusyUntil;	/* without TRIG_FLAG_RETRIGGER: no new event before this frame */
+	uint64_t SeqNext;
+	uint64_t Events;
+	uint64_t Dropped;
+};
+
+static TrigEngine* trigGet(ExtDevice* Dev, int Trig)
+{
+	if (Trig < 1 || Trig > TRIG_NUM_MAX || !Dev->Trig[Trig - 1])
+	{
+		extSetError(Dev->ComNo, ERR_EXT_WRONG_HANDLE);
+		return NULL;
+	}
+	return Dev->Trig[Trig - 1];
+}
+
+static void trigReset(TrigEngine* T)
+{
+	T->LastResult = false;
+	T->BusyUntil = 0;
+	for (int i = 0; i < T->NumCond; i++)
+	{
+		T->Cond[i].EdgeArmed = false;
+		T->Cond[i].HasPrev = false;
+	}
+	for (size_t i = 0; i < T->Slots.size(); i++)
+		if (T->Slots[i].State == SLOT_PENDING)
+			T->Slots[i].State = SLOT_FREE;
+}
+
+static bool condEval(TrigCond* C, double v, double Frequency)
+{
+	switch (C->Type)
+	{
+	case TRIG_COND_ABOVE:
+		return v > C->Thres1;
+	case TRIG_COND_BELOW:
+		return v < C->Thres1;
+	case TRIG_COND_RISING:
+		if (!C->EdgeArmed)
+		{
+			C->EdgeArmed = v < C->Thres1 - C->Thres2;
+			return false;
+		}
+		if (v > C->Thres1)
+		{
+			C->EdgeArmed = false;
+			return true;
+		}
+		return false;
+	case TRIG_COND_FALLING:
+		if (!C->EdgeArmed)
+		{
+			C->EdgeArmed = v > C->Thres1 + C->Thres2;
+			return false;
+		}
+		if (v < C->Thres1)
+		{
+			C->EdgeArmed = false;
+			return true;
+		}
+		return false;
+	case TRIG_COND_WIN_IN:
+		return v >= C->Thres1 && v <= C->Thres2;
+	case TRIG_COND_WIN_OUT:
+		return v < C->Thres1 || v > C->Thres2;
+	case TRIG_COND_SLOPE_UP:
+	case TRIG_COND_SLOPE_DOWN:
+	{
+		bool res = false;
+		if (C->HasPrev)
+		{
+			double slope = (v - C->Prev) * Frequency;
+			res = (C->Type == TRIG_COND_SLOPE_UP) ? (slope > C->Thres1) : (slope < -C->Thres1);
+		}
+		C->Prev = v;
+		C->HasPrev = true;
+		return res;
+	}
+	default:
+		return false;
+	}
+}
+
+/* Sum of products: OR over used groups of AND of the group's conditions.
+   All conditions are evaluated on every frame to keep edge and slope states current. */
+static bool trigEval(TrigEngine* T, const double* Frame, const double* Scale, double Frequency)
+{
+	unsigned used = 0, failed = 0;
+	for (int i = 0; i < T->NumCond; i++)
+	{
+		TrigCond* c = &T->Cond[i];
+		double v = Frame[c->Obj];
+		if (Scale)
+			v *= Scale[c->Obj];
+		used |= 1u << c->Group;
+		if (!condEval(c, v, Frequency))
+			failed |= 1u << c->Group;
+	}
+	return (used & ~failed) != 0;
+}
+
+static void trigStartCapture(TrigEngine* T, uint64_t Frame)
+{
+	T->Events++;
+	TrigSlot* slot = NULL;
+	TrigSlot* oldest = NULL;
+	for (size_t i = 0; i < T->Slots.size(); i++)
+	{
+		TrigSlot* s = &T->Slots[i];
+		if (s->State == SLOT_FREE)
+		{
+			slot = s;
+			break;
+		}
+		if (s->State == SLOT_READY && (!oldest || s->Seq < oldest->Seq))
+			oldest = s;
+	}
+	if (!slot)
+	{
+		T->Dropped++;
+		if (!(T->Flags & TRIG_FLAG_OVERWRITE_OLDEST) || !oldest)
+			return;
+		slot = oldest;
+	}
+	slot->State = SLOT_PENDING;
+	slot->TrigFrame = Frame;
+	slot->Seq = T->SeqNext++;
+	T->BusyUntil = Frame + (uint64_t)T->PostFrames;
+}
+
+static void trigCopyCapture(const ExtDevice* Dev, const TrigEngine* T, TrigSlot* S)
+{
+	const int num = Dev->NumObj;
+	const double* scale = (T->Flags & TRIG_FLAG_SCALED) ? Dev->ScaleFactors : NULL;
+	double* out = S->Data.data();
+	size_t n = (size_t)(T->PreFrames + T->PostFrames);
+	uint64_t f = S->TrigFrame - (uint64_t)T->PreFrames;
+	if (S->TrigFrame < (uint64_t)T->PreFrames)
+	{
+		/* trigger closer to stream start than PreFrames */
+		size_t pad = (size_t)(T->PreFrames - S->TrigFrame);
+		for (size_t i = 0; i < pad * num; i++)
+			out[i] = std::numeric_limits<double>::quiet_NaN();
+		out += pad * num;
+		n -= pad;
+		f = 0;
+	}
+	/* at most two contiguous pieces */
+	while (n > 0)
+	{
+		size_t pos = (size_t)(f & Dev->RingMask);
+		size_t part = (size_t)Dev->RingFrames - pos;
+		if (part > n)
+			part = n;
+		const double* src = &Dev->Ring[pos * num];
+		if (scale)
+			Dev->Kern->ScaleFrames(out, src, scale, part);
+		else
+			memcpy(out, src, part * num * sizeof(double));
+		out += part * num;
+		n -= part;
+		f += part;
+	}
+	S->State = SLOT_READY;
+}
+
+void extTrigProcess(ExtDevice* Dev, uint64_t First, uint64_t Count)
+{
+	const uint64_t end = First + Count;
+	for (int t = 0; t < TRIG_NUM_MAX; t++)
+	{
+		TrigEngine* T = Dev->Trig[t];
+		if (!T || !T->Armed)
+			continue;
+		const double* scale = (T->Flags & TRIG_FLAG_SCALED) ? Dev->ScaleFactors : NULL;
+		double freq = Dev->Frequency > 0 ? Dev->Frequency : 1.0;
+		if (T->NumCond > 0)
+		{
+			for (uint64_t f = First; f < end; f++)
+			{
+				bool res = trigEval(T, extRingFrame(Dev, f), scale, freq);
+				if (res && !T->LastResult && ((T->Flags & TRIG_FLAG_RETRIGGER) || f >= T->BusyUntil))
+					trigStartCapture(T, f);
+				T->LastResult = res;
+			}
+		}
+		for (size_t i = 0; i < T->Slots.size(); i++)
+		{
+			TrigSlot* s = &T->Slots[i];
+			if (s->State == SLOT_PENDING && s->TrigFrame + (uint64_t)T->PostFrames <= end)
+				trigCopyCapture(Dev, T, s);
+		}
+	}
+}
+
+void extTrigFreeAll(ExtDevice* Dev)
+{
+	for (int t = 0; t < TRIG_NUM_MAX; t++)
+	{
+		delete Dev->Trig[t];
+		Dev->Trig[t] = NULL;
+	}
+}
+
+int CALLTYP GSV86extTrigCreate(int ComNo, int PreFrames, int PostFrames, int NumSlots, unsigned long flags)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	if (PreFrames < 0 || PostFrames < 1 || NumSlots < 1
+		|| (uint64_t)PreFrames + PostFrames + EXT_PULL_FRAMES > dev->RingFrames)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	int ix = 0;
+	while (ix < TRIG_NUM_MAX && dev->Trig[ix])
+		ix++;
+	if (ix == TRIG_NUM_MAX)
+	{
+		extSetError(ComNo, ERR_EXT_NO_RESOURCE);
+		return GSV_ERROR;
+	}
+	TrigEngine* T = new (std::nothrow) TrigEngine();
+	if (!T)
+	{
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	T->PreFrames = PreFrames;
+	T->PostFrames = PostFrames;
+	T->Flags = flags;
+	try
+	{
+		T->Slots.resize(NumSlots);
+		for (int i = 0; i < NumSlots; i++)
+			T->Slots[i].Data.assign((size_t)(PreFrames + PostFrames) * dev->NumObj, 0.0);
+	}
+	catch (...)
+	{
+		delete T;
+		extSetError(ComNo, ERR_MEM_ALLOC);
+		return GSV_ERROR;
+	}
+	dev->Trig[ix] = T;
+	return ix + 1;
+}
+
+int CALLTYP GSV86extTrigAddCondition(int ComNo, int Trig, int Type, int Obj, int Group, double Thres1, double Thres2)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	TrigEngine* T = trigGet(dev.get(), Trig);
+	if (!T)
+		return GSV_ERROR;
+	if (Type < TRIG_COND_ABOVE || Type > TRIG_COND_SLOPE_DOWN || Obj < 1 || Obj > dev->NumObj
+		|| Group < 0 || Group >= TRIG_GROUP_MAX)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	if (T->Armed)
+	{
+		extSetError(ComNo, ERR_EXT_WRONG_STATE);
+		return GSV_ERROR;
+	}
+	if (T->NumCond >= TRIG_COND_MAX)
+	{
+		extSetError(ComNo, ERR_EXT_NO_RESOURCE);
+		return GSV_ERROR;
+	}
+	TrigCond* c = &T->Cond[T->NumCond++];
+	c->Type = Type;
+	c->Obj = Obj - 1;
+	c->Group = Group;
+	c->Thres1 = Thres1;
+	c->Thres2 = Thres2;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extTrigArm(int ComNo, int Trig, int OnOff)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	TrigEngine* T = trigGet(dev.get(), Trig);
+	if (!T)
+		return GSV_ERROR;
+	trigReset(T);
+	/* start evaluating with the next frame polled */
+	T->BusyUntil = dev->FrameCount.load(std::memory_order_relaxed);
+	T->Armed = OnOff != 0;
+	return GSV_OK;
+}
+
+int CALLTYP GSV86extTrigGetInfo(int ComNo, int Trig, int Index)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	TrigEngine* T = trigGet(dev.get(), Trig);
+	if (!T)
+		return GSV_ERROR;
+	int n = 0;
+	switch (Index)
+	{
+	case TRIG_INFO_CAPTURED:
+	case TRIG_INFO_PENDING:
+		for (size_t i = 0; i < T->Slots.size(); i++)
+			if (T->Slots[i].State == (Index == TRIG_INFO_CAPTURED ? SLOT_READY : SLOT_PENDING))
+				n++;
+		return n;
+	case TRIG_INFO_EVENTS:
+		return (int)(T->Events & 0x7FFFFFFF);
+	case TRIG_INFO_DROPPED:
+		return (int)(T->Dropped & 0x7FFFFFFF);
+	default:
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+}
+
+int CALLTYP GSV86extTrigGetCapture(int ComNo, int Trig, double* out, int count, unsigned long long* TrigFrame)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	TrigEngine* T = trigGet(dev.get(), Trig);
+	if (!T)
+		return GSV_ERROR;
+	int size = (T->PreFrames + T->PostFrames) * dev->NumObj;
+	if (!out || count < size)
+	{
+		extSetError(ComNo, ERR_WRONG_PARAMETER);
+		return GSV_ERROR;
+	}
+	TrigSlot* oldest = NULL;
+	for (size_t i = 0; i < T->Slots.size(); i++)
+	{
+		TrigSlot* s = &T->Slots[i];
+		if (s->State == SLOT_READY && (!oldest || s->Seq < oldest->Seq))
+			oldest = s;
+	}
+	if (!oldest)
+		return GSV_OK;
+	memcpy(out, oldest->Data.data(), size * sizeof(double));
+	if (TrigFrame)
+		*TrigFrame = oldest->TrigFrame;
+	oldest->State = SLOT_FREE;
+	return size;
+}
+
+int CALLTYP GSV86extTrigDelete(int ComNo, int Trig)
+{
+	ExtDeviceRef dev = extGetDevice(ComNo);
+	if (!dev)
+		return GSV_ERROR;
+	std::lock_guard<std::mutex> lk(dev->Lock);
+	TrigEngine* T = trigGet(dev.get(), Trig);
+	if (!T)
+		return GSV_ERROR;
+	delete T;
+	dev->Trig[Trig - 1] = NULL;
+	return GSV_OK;
+}
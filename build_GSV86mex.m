@@ -0,0 +1,23 @@
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+% Builds the MEX gateway GSV86mex.mexw64 for MEGSV86x64.dll                  %
+% (requires a C++ compiler configured with "mex -setup C++")                 %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+cc = mex.getCompilerConfigurations('C++','Selected');
+
+if contains(lower(cc.ShortName),'mingw')
+    % MinGW links directly against the DLL
+    mex('-D_M_X64','GSV86mex.cpp','MEGSV86x64.dll')
+else
+    % Visual C++ needs an import library: create it from the exports listed in the header
+    if ~isfile('MEGSV86x64.lib')
+        hdr = fileread('MEGSV86x64.h');
+        names = regexp(hdr,'CALLTYP\s+(GSV86\w+)\s*\(','tokens');
+        fid = fopen('MEGSV86x64.def','w');
+        fprintf(fid,'LIBRARY MEGSV86x64.dll\nEXPORTS\n');
+        fprintf(fid,'  %s\n',unique(cellfun(@(c) c{1},names,'UniformOutput',false)));
+        fclose(fid);
+        system('lib /nologo /machine:x64 /def:MEGSV86x64.def /out:MEGSV86x64.lib');
+    end
+    mex('GSV86mex.cpp','MEGSV86x64.lib')
+end